@@ -0,0 +1,250 @@
+// Sustained-throughput load test over a pseudo-terminal pair (POSIX only).
+//
+// Drives the real receive path (SimpleSerial termios/epoll backend -> SerialSource ->
+// TelemetryIngest -> sample ring) with synthetic flight frames, while the main thread drains the
+// ring on a fixed frame interval the way the GUI does. The send rate is ramped step by step until
+// frames are lost or the write-to-drain latency exceeds the limit, and the highest rate that
+// stayed within both limits is reported.
+//
+// Build: part of the CMake build (loadTest target).
+// Usage: loadTest [options]
+//   --start N         first step, frames/s (default 1000)
+//   --factor x        rate multiplier per step (default 1.5)
+//   --step s          seconds per step (default 2)
+//   --max-loss f      loss fraction that fails a step (default 0.001)
+//   --max-p99 ms      p99 latency that fails a step (default 50)
+//   --drain ms        consumer frame interval (default 16, about 60 Hz)
+//   --binary f        fraction of binary frames (default 0)
+//   --journal path    also record everything through FlightRecorder
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "flightRecorder.h"
+#include "latencyHistogram.h"
+#include "serialSource.h"
+#include "telemetryGenerator.h"
+#include "telemetryIngest.h"
+
+using namespace std;
+
+// Frames keep the generator's rocket time, so they reach the consumer the way real ones would, and
+// carry their index in the force and temperature channels (15 bits each), which the receive path
+// passes through untouched, so the consumer can find when each one was written. Write times are
+// kept for the last 2^20 indices, far more than can ever be in flight at once.
+static const uint32_t INDEX_MASK = (1u << 20) - 1;
+
+static void SetFrameIndex(TelemetrySample& sample, uint64_t index)
+{
+    sample.force = (float)(index & 0x7FFF);
+    sample.temp = (float)((index >> 15) & 0x7FFF);
+}
+
+static uint64_t FrameIndex(const TelemetrySample& sample)
+{
+    return (uint64_t)sample.force | (uint64_t)sample.temp << 15;
+}
+
+struct StepResult
+{
+    double TargetRate;
+    double SentRate;
+    uint64_t Sent;
+    uint64_t Received;
+    double Loss;
+    LatencyHistogram Latency;
+};
+
+int main(int argc, char** argv)
+{
+    double startRate = 1000.0;
+    double factor = 1.5;
+    double stepSeconds = 2.0;
+    double maxLoss = 0.001;
+    double maxP99Ms = 50.0;
+    int drainMs = 16;
+    double binaryFraction = 0.0;
+    string journalPath;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* arg = argv[i];
+        const char* value = argv[i + 1];
+        if (!strcmp(arg, "--start"))
+            startRate = atof(value);
+        else if (!strcmp(arg, "--factor"))
+            factor = atof(value);
+        else if (!strcmp(arg, "--step"))
+            stepSeconds = atof(value);
+        else if (!strcmp(arg, "--max-loss"))
+            maxLoss = atof(value);
+        else if (!strcmp(arg, "--max-p99"))
+            maxP99Ms = atof(value);
+        else if (!strcmp(arg, "--drain"))
+            drainMs = atoi(value);
+        else if (!strcmp(arg, "--binary"))
+            binaryFraction = atof(value);
+        else if (!strcmp(arg, "--journal"))
+            journalPath = value;
+        else
+        {
+            printf("Unknown option %s\n", arg);
+            return 2;
+        }
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        printf("Could not open a pseudo-terminal pair\n");
+        return 1;
+    }
+    string slaveName = ptsname(master);
+    SimpleSerial serial(&slaveName[0], 115200);
+    if (!serial.connected_)
+    {
+        printf("Could not open %s\n", slaveName.c_str());
+        return 1;
+    }
+
+    SerialSource link(serial);
+    TelemetryIngest ingest(&link);
+    FlightRecorder recorder;
+    if (!journalPath.empty())
+    {
+        recorder.Start(journalPath);
+        ingest.SetRecorder(&recorder);
+    }
+    ingest.Start();
+
+    TelemetryGenerator generator;
+    generator.SetBinaryFraction(binaryFraction);
+    vector<uint64_t> writtenNs(INDEX_MASK + 1);
+    vector<TelemetrySample> pending(TelemetryIngest::RING_CAPACITY);
+    vector<uint8_t> buffer(64 * 1024);
+    uint64_t frameIndex = 0;
+    double rocketSeconds = 0.0;     // rocket time at the start of the step, so it never goes back
+
+    printf("pty %s, drain every %d ms, %.0f%% binary%s\n", slaveName.c_str(), drainMs, binaryFraction * 100.0,
+        journalPath.empty() ? "" : ", recording");
+    printf("%12s %12s %10s %8s %10s %10s %10s\n", "target/s", "sent/s", "received", "loss", "p50 ms", "p99 ms", "max ms");
+
+    double bestRate = 0.0;
+    double bestP99 = 0.0;
+    for (double rate = startRate; ; rate *= factor)
+    {
+        StepResult step = {};
+        step.TargetRate = rate;
+        step.Latency.Reset();
+        atomic<uint64_t> sent(0);
+        atomic<bool> writing(true);
+        uint64_t firstIndex = frameIndex;
+
+        // writer: the flight computer, paced in 1 ms ticks
+        thread writer([&]()
+        {
+            uint64_t start = MonotonicNanoseconds();
+            uint64_t total = (uint64_t)(rate * stepSeconds);
+            uint64_t written = 0;
+            while (written < total)
+            {
+                double elapsed = (MonotonicNanoseconds() - start) * 1e-9;
+                uint64_t due = min<uint64_t>(total, (uint64_t)(elapsed * rate) + 1);
+                size_t length = 0;
+                uint64_t batchStart = written;
+                while (written < due && length + TelemetryGenerator::MAX_FRAME_BYTES <= buffer.size())
+                {
+                    TelemetrySample sample = generator.NoisySample(rocketSeconds + written / rate);
+                    SetFrameIndex(sample, firstIndex + written);
+                    length += generator.EncodeFrame(sample, buffer.data() + length);
+                    written++;
+                }
+                if (length == 0)
+                {
+                    this_thread::sleep_for(chrono::microseconds(200));
+                    continue;
+                }
+
+                uint64_t now = MonotonicNanoseconds();
+                for (uint64_t i = batchStart; i < written; i++)
+                    writtenNs[(firstIndex + i) & INDEX_MASK] = now;
+                size_t offset = 0;
+                while (offset < length)
+                {
+                    ssize_t result = write(master, buffer.data() + offset, length - offset);
+                    if (result <= 0)
+                        break;
+                    offset += result;
+                }
+                sent.store(written, memory_order_release);
+            }
+            step.SentRate = written / ((MonotonicNanoseconds() - start) * 1e-9);
+            writing.store(false);
+        });
+
+        // consumer: drain on a fixed frame interval, then wait briefly for stragglers
+        uint64_t settleUntil = 0;
+        for (;;)
+        {
+            this_thread::sleep_for(chrono::milliseconds(drainMs));
+            uint64_t sentSoFar = sent.load(memory_order_acquire);
+            size_t count;
+            while ((count = ingest.Drain(pending.data(), pending.size())) > 0)
+            {
+                uint64_t now = MonotonicNanoseconds();
+                for (size_t i = 0; i < count; i++)
+                    step.Latency.Record(now - writtenNs[FrameIndex(pending[i]) & INDEX_MASK]);
+                step.Received += count;
+            }
+            if (writing.load())
+                continue;
+            if (settleUntil == 0)
+                settleUntil = MonotonicNanoseconds() + 250000000ull;
+            if (step.Received >= sentSoFar || MonotonicNanoseconds() > settleUntil)
+                break;
+        }
+        writer.join();
+
+        step.Sent = sent.load();
+        frameIndex += step.Sent;
+        rocketSeconds += step.Sent / rate;
+        step.Loss = step.Sent ? 1.0 - (double)min(step.Received, step.Sent) / step.Sent : 0.0;
+        double p50 = step.Latency.Percentile(0.5) * 1e-6;
+        double p99 = step.Latency.Percentile(0.99) * 1e-6;
+        printf("%12.0f %12.0f %10llu %7.3f%% %10.2f %10.2f %10.2f\n", step.TargetRate, step.SentRate,
+            (unsigned long long)step.Received, step.Loss * 100.0, p50, p99, step.Latency.Max() * 1e-6);
+        fflush(stdout);
+
+        if (step.Loss > maxLoss || p99 > maxP99Ms)
+            break;
+        if (step.SentRate < 0.95 * rate)
+        {
+            printf("generator cannot keep up beyond %.0f frames/s; the receive path is not the limit yet\n", step.SentRate);
+            bestRate = step.SentRate;
+            bestP99 = p99;
+            break;
+        }
+        bestRate = rate;
+        bestP99 = p99;
+    }
+
+    ingest.Stop();
+    recorder.Stop();
+    serial.CloseSerialPort();
+    close(master);
+
+    printf("max sustained: %.0f frames/s (p99 %.2f ms, limits %.3f%% loss, %.0f ms p99)\n",
+        bestRate, bestP99, maxLoss * 100.0, maxP99Ms);
+    if (!journalPath.empty())
+        printf("journal: %llu records, %llu dropped\n",
+            (unsigned long long)recorder.RecordsWritten(), (unsigned long long)recorder.RecordsDropped());
+    return bestRate > 0.0 ? 0 : 1;
+}
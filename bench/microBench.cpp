@@ -0,0 +1,596 @@
+// Microbenchmarks for the per-sample hot paths between the link and the plots.
+//
+//   parser/ascii        TelemetryParser on one "Data:...:" frame
+//   decoder             LinkDecoder on the raw byte stream, 4 KB reads, as the ingest thread does
+//   estimator           StateEstimator::Update, as run on the ingest thread for every decoded sample
+//   shared/write        SharedSampleWriter::Write, as run on the ingest thread when the ring is open
+//   shared/read         SharedSampleReader::Read of the same samples, in batches, as a consumer does
+//   derived             DerivedChannels::Evaluate, as run for every drained sample
+//   store/append        the store feed: a row with derived channels, TelemetryStore::Append, Publish per batch
+//   stats/window        ChannelStats::Add over every column, 20 s windows, as the store feed runs it
+//   plot/live           per-frame plot preparation from a store snapshot, scrolling 20 s window of every group
+//   plot/flight         the same for the whole flight (pyramid levels)
+//   history/decode      every column of the sealed (compressed) chunks through ForEachSpan, decoding each
+//   plot/scrub          plot/live's window stepped 1 s at a time through the sealed history
+//
+// After store/append the sealed history's size is printed in bytes per value (raw chunks: 4).
+// Each benchmark reports ns, heap allocations and (on Linux, where perf events are permitted)
+// last-level cache misses per item. Items are frames, samples or plotted points respectively.
+//
+// Build: part of the CMake build (microBench target).
+// Usage: microBench [--journal recorded.tvj] [--csv results.csv] [--label name] [--baseline old.csv [--tolerance f]]
+//   --journal   also run every benchmark on the raw link bytes of a recorded flight
+//   --csv       append results as CSV rows (label,benchmark,corpus,items,ns,allocs,cache_misses)
+//   --label     label for the CSV rows, e.g. the commit hash (default "current")
+//   --baseline  compare against the rows of an earlier --csv file with the same benchmark/corpus;
+//               exits with 1 if any got slower than --tolerance (default 0.10 = 10%)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "channelStats.h"
+#include "derivedChannels.h"
+#include "flightJournal.h"
+#include "linkDecoder.h"
+#include "sharedSampleRing.h"
+#include "stateEstimator.h"
+#include "storeFeed.h"
+#include "telemetryGenerator.h"
+#include "telemetryParser.h"
+#include "telemetryStore.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Every heap allocation in the process is counted, so a benchmark can report allocations per item.
+static atomic<uint64_t> allocationCount(0);
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Last-level cache misses of this thread, where the kernel allows user-space perf events.
+class CacheMissCounter
+{
+public:
+    CacheMissCounter() : fd_(-1)
+    {
+#ifdef __linux__
+        perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~CacheMissCounter()
+    {
+#ifdef __linux__
+        if (fd_ >= 0)
+            close(fd_);
+#endif
+    }
+
+    bool Available() const { return fd_ >= 0; }
+
+    void Start()
+    {
+#ifdef __linux__
+        if (fd_ >= 0)
+        {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t Stop()
+    {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd_ >= 0)
+        {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count))
+                count = 0;
+        }
+#endif
+        return count;
+    }
+
+private:
+    int fd_;
+};
+
+struct BenchResult
+{
+    string Name;
+    string Corpus;
+    uint64_t Items;
+    double Ns;
+    double Allocs;
+    double CacheMisses;     // negative when not available
+};
+
+static CacheMissCounter cacheMisses;
+static vector<BenchResult> results;
+static volatile double sink;
+
+// Runs fn (which processes `items` items and returns a checksum) until at least 0.3 s have
+// passed, five times, and keeps the fastest pass.
+template<typename Fn>
+static void Run(const char* name, const string& corpus, uint64_t items, Fn fn)
+{
+    BenchResult best = { name, corpus, items, 1e300, 0.0, -1.0 };
+    for (int pass = 0; pass < 5; pass++)
+    {
+        uint64_t repeats = 0;
+        uint64_t allocs = allocationCount.load();
+        cacheMisses.Start();
+        auto start = chrono::steady_clock::now();
+        chrono::duration<double> elapsed;
+        do
+        {
+            sink = sink + fn();
+            repeats++;
+            elapsed = chrono::steady_clock::now() - start;
+        } while (elapsed.count() < 0.3);
+        uint64_t misses = cacheMisses.Stop();
+
+        double total = (double)items * repeats;
+        double ns = elapsed.count() * 1e9 / total;
+        if (ns < best.Ns)
+        {
+            best.Ns = ns;
+            best.Allocs = (allocationCount.load() - allocs) / total;
+            best.CacheMisses = cacheMisses.Available() ? misses / total : -1.0;
+        }
+    }
+    results.push_back(best);
+
+    char misses[32] = "n/a";
+    if (best.CacheMisses >= 0.0)
+        snprintf(misses, sizeof(misses), "%.3f", best.CacheMisses);
+    printf("%-16s %-10s %10llu %12.2f %10.3f %12s\n", name, corpus.c_str(), (unsigned long long)items,
+        best.Ns, best.Allocs, misses);
+    fflush(stdout);
+}
+
+// Raw link bytes of every Raw record in a journal, in order.
+static vector<uint8_t> LoadJournalStream(const char* path)
+{
+    vector<uint8_t> stream;
+    JournalReader reader;
+    if (!reader.Open(path))
+        return stream;
+    JournalRecord record;
+    while (reader.Next(record))
+    {
+        if (record.Type == JournalRecord_Raw && record.Length > 8)
+            stream.insert(stream.end(), record.Payload + 8, record.Payload + record.Length);
+    }
+    return stream;
+}
+
+static vector<uint8_t> SyntheticStream(size_t frames, double binary_fraction)
+{
+    TelemetryGenerator generator;
+    generator.SetBinaryFraction(binary_fraction);
+    vector<uint8_t> stream;
+    uint8_t frame[TelemetryGenerator::MAX_FRAME_BYTES];
+    for (size_t i = 0; i < frames; i++)
+    {
+        size_t length = generator.NextFrame(i / 100.0, frame);
+        stream.insert(stream.end(), frame, frame + length);
+    }
+    return stream;
+}
+
+// Frame contents between '{' and '}', as the ASCII splitter hands them to the parser.
+static vector<string_view> AsciiFrames(const vector<uint8_t>& stream)
+{
+    vector<string_view> frames;
+    const char* data = (const char*)stream.data();
+    size_t front = string::npos;
+    for (size_t i = 0; i < stream.size(); i++)
+    {
+        if (data[i] == '{')
+            front = i + 1;
+        else if (data[i] == '}' && front != string::npos)
+        {
+            frames.push_back(string_view(data + front, i - front));
+            front = string::npos;
+        }
+        else if (data[i] == 0)
+            front = string::npos;
+    }
+    return frames;
+}
+
+static vector<TelemetrySample> DecodeAll(const vector<uint8_t>& stream)
+{
+    vector<TelemetrySample> samples;
+    LinkDecoder decoder;
+    decoder.Feed(stream.data(), stream.size(), [&](const TelemetrySample& sample) { samples.push_back(sample); });
+    return samples;
+}
+
+static void DecodeBenchmarks(const string& corpus, const vector<uint8_t>& stream, bool ascii)
+{
+    vector<string_view> frames = AsciiFrames(stream);
+    if (ascii && !frames.empty())
+    {
+        Run("parser/ascii", corpus, frames.size(), [&]()
+        {
+            TelemetrySample sample;
+            double sum = 0.0;
+            for (string_view frame : frames)
+            {
+                if (ParseTelemetryFrame(frame, sample) == ParseStatus::Ok)
+                    sum += sample.altitude;
+            }
+            return sum;
+        });
+    }
+
+    size_t frameCount = DecodeAll(stream).size();
+    Run("decoder", corpus, frameCount, [&]()
+    {
+        LinkDecoder decoder;
+        double sum = 0.0;
+        auto onSample = [&sum](const TelemetrySample& sample) { sum += sample.altitude; };
+        for (size_t offset = 0; offset < stream.size(); offset += 4096)
+            decoder.Feed(stream.data() + offset, min<size_t>(4096, stream.size() - offset), onSample);
+        return sum;
+    });
+}
+
+
+// Reads every value a PlotColumn() call hands to ImPlot for samples [first, last) of column:
+// the raw spans when they fit in max_points, otherwise one pyramid level's min/max buckets.
+static double PreparePlotColumn(const StoreSnapshot& store, int column, size_t first, size_t last, size_t max_points, uint64_t& points)
+{
+    double sum = 0.0;
+    int level = TelemetryPyramid::ChooseLevel(last - first, max_points);
+    if (level == 0)
+    {
+        store.ForEachSpan(column, first, last, [&](const float* times, const float* values, int count)
+        {
+            for (int i = 0; i < count; i++)
+                sum += times[i] + values[i];
+            points += count;
+        });
+        return sum;
+    }
+
+    size_t bucketSamples = TelemetryPyramid::BucketSamples(level);
+    size_t firstBucket = first / bucketSamples;
+    size_t bucketCount = min(store.BucketCount(level), (last + bucketSamples - 1) / bucketSamples);
+    for (size_t bucket = firstBucket; bucket < bucketCount; bucket++)
+        sum += store.BucketTime(level, bucket) + store.Min(level, column, bucket) + store.Max(level, column, bucket);
+    points += 2 * (bucketCount - firstBucket);
+    return sum;
+}
+
+// One GUI frame's worth of plot preparation: every plot group's raw and derived columns.
+static double PreparePlotFrame(const StoreSnapshot& store, size_t first, size_t last, uint64_t& points)
+{
+    const size_t maxPoints = 2 * 1280;
+    double sum = 0.0;
+    for (PlotGroup group : { PlotGroup_Overview, PlotGroup_Altitude, PlotGroup_Velocity, PlotGroup_Orientation, PlotGroup_Acceleration })
+    {
+        for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+        {
+            if (COLUMNS[column].plotGroups & group)
+                sum += PreparePlotColumn(store, column, first, last, maxPoints, points);
+        }
+    }
+    return sum;
+}
+
+static void SampleBenchmarks(const string& corpus, const vector<TelemetrySample>& samples)
+{
+    if (samples.empty())
+        return;
+
+    StateEstimator estimator;
+    Run("estimator", corpus, samples.size(), [&]()
+    {
+        double sum = 0.0;
+        estimator.Reset();
+        for (const TelemetrySample& decoded : samples)
+        {
+            TelemetrySample sample = decoded;
+            estimator.Update(sample);
+            sum += sample.verticalVelocity;
+        }
+        return sum;
+    });
+
+    // the shared-memory ring holds the whole corpus, so the reader never laps
+    SharedSampleWriter sharedRing;
+    if (sharedRing.Open("microbench", samples.size()))
+    {
+        Run("shared/write", corpus, samples.size(), [&]()
+        {
+            for (const TelemetrySample& sample : samples)
+                sharedRing.Write(sample);
+            return (double)sharedRing.SamplesWritten();
+        });
+
+        SharedSampleReader sharedReader;
+        vector<TelemetrySample> copied(samples.size());
+        Run("shared/read", corpus, samples.size(), [&]()
+        {
+            sharedReader.Open("microbench", true);
+            size_t count = 0;
+            while (count < copied.size())
+            {
+                size_t read = sharedReader.Read(&copied[count], copied.size() - count);
+                if (read == 0)
+                    break;
+                count += read;
+            }
+            return (double)count + copied[count - 1].altitude;
+        });
+        sharedReader.Close();
+        sharedRing.Close();
+    }
+
+    DerivedChannels derived;
+    Run("derived", corpus, samples.size(), [&]()
+    {
+        double sum = 0.0;
+        float row[STORE_COLUMN_COUNT];
+        derived.Reset();
+        for (const TelemetrySample& sample : samples)
+        {
+            derived.Evaluate(sample, RocketSeconds(sample), row);
+            sum += row[STORE_COLUMN_COUNT - 1];
+        }
+        return sum;
+    });
+
+    // the StoreFeed loop: raw and derived channels into a row, then into the store, published per batch
+    TelemetryStore flightStore(STORE_COLUMN_COUNT);
+    Run("store/append", corpus, samples.size(), [&]()
+    {
+        flightStore.Clear();
+        derived.Reset();
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            const TelemetrySample& sample = samples[i];
+            float row[STORE_COLUMN_COUNT];
+            derived.Evaluate(sample, RocketSeconds(sample), row);
+            flightStore.Append(sample.hostTime, row);
+            if ((i + 1) % StoreFeed::BATCH_SAMPLES == 0)
+                flightStore.Publish();
+        }
+        flightStore.Publish();
+        return (double)flightStore.Size();
+    });
+
+    ChannelStats stats(STORE_COLUMN_COUNT);
+    vector<float> rows((size_t)STORE_COLUMN_COUNT * samples.size());
+    derived.Reset();
+    for (size_t i = 0; i < samples.size(); i++)
+        derived.Evaluate(samples[i], RocketSeconds(samples[i]), &rows[i * STORE_COLUMN_COUNT]);
+    Run("stats/window", corpus, samples.size(), [&]()
+    {
+        stats.Reset();
+        for (size_t i = 0; i < samples.size(); i++)
+            stats.Add(samples[i].hostTime, &rows[i * STORE_COLUMN_COUNT]);
+        return (double)stats.Summary(0).Mean;
+    });
+
+    TelemetryStore::Reader reader(flightStore);
+    const StoreSnapshot& store = reader.Snapshot();
+    if (store.SealedSamples() > 0)
+    {
+        printf("%-16s %-10s %10llu %12s %.2f bytes/value sealed\n", "store/memory", corpus.c_str(),
+            (unsigned long long)store.SealedSamples(), "",
+            (double)store.CompressedBytes() / ((double)store.SealedSamples() * STORE_COLUMN_COUNT));
+    }
+    float latest = store.Time(store.Size() - 1);
+    size_t windowStart = store.LowerBound(latest - 20.0f);
+    if (windowStart > 0)
+        windowStart--;
+
+    uint64_t points = 0;
+    PreparePlotFrame(store, windowStart, store.Size(), points);
+    Run("plot/live", corpus, points, [&]()
+    {
+        uint64_t count = 0;
+        return PreparePlotFrame(store, windowStart, store.Size(), count);
+    });
+
+    points = 0;
+    PreparePlotFrame(store, 0, store.Size(), points);
+    Run("plot/flight", corpus, points, [&]()
+    {
+        uint64_t count = 0;
+        return PreparePlotFrame(store, 0, store.Size(), count);
+    });
+
+    // a chunk column more than the decoded cache holds, so every one is decoded again per pass
+    size_t sealed = store.SealedSamples();
+    if (sealed == 0)
+        return;
+    Run("history/decode", corpus, (uint64_t)sealed * STORE_COLUMN_COUNT, [&]()
+    {
+        double sum = 0.0;
+        for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+        {
+            store.ForEachSpan(column, 0, sealed, [&](const float* times, const float* values, int count)
+            {
+                sum += times[count - 1] + values[count - 1];
+            });
+        }
+        return sum;
+    });
+
+    // the windows of someone dragging through the recorded part of the flight
+    vector<pair<size_t, size_t>> scrubWindows;
+    for (float start = store.Time(0); start + 20.0f < store.Time(sealed - 1); start += 1.0f)
+        scrubWindows.push_back({ store.LowerBound(start), store.LowerBound(start + 20.0f) });
+    points = 0;
+    for (const pair<size_t, size_t>& window : scrubWindows)
+        PreparePlotFrame(store, window.first, window.second, points);
+    Run("plot/scrub", corpus, points, [&]()
+    {
+        uint64_t count = 0;
+        double sum = 0.0;
+        for (const pair<size_t, size_t>& window : scrubWindows)
+            sum += PreparePlotFrame(store, window.first, window.second, count);
+        return sum;
+    });
+}
+
+static bool WriteCsv(const char* path, const string& label)
+{
+    FILE* file = fopen(path, "r");
+    bool exists = file != nullptr;
+    if (file)
+        fclose(file);
+
+    file = fopen(path, "a");
+    if (!file)
+        return false;
+    if (!exists)
+        fprintf(file, "label,benchmark,corpus,items,ns_per_item,allocs_per_item,cache_misses_per_item\n");
+    for (const BenchResult& result : results)
+        fprintf(file, "%s,%s,%s,%llu,%.4f,%.4f,%.4f\n", label.c_str(), result.Name.c_str(), result.Corpus.c_str(),
+            (unsigned long long)result.Items, result.Ns, result.Allocs, result.CacheMisses);
+    fclose(file);
+    return true;
+}
+
+// Prints the ratio to the last baseline row for each benchmark/corpus; returns how many got
+// slower by more than tolerance.
+static int CompareBaseline(const char* path, double tolerance)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+    {
+        printf("Cannot read baseline %s\n", path);
+        return 0;
+    }
+
+    struct Row { string Key; string Label; double Ns; };
+    vector<Row> rows;
+    char line[512];
+    while (fgets(line, sizeof(line), file))
+    {
+        char label[128], name[128], corpus[128];
+        unsigned long long items;
+        double ns;
+        if (sscanf(line, "%127[^,],%127[^,],%127[^,],%llu,%lf", label, name, corpus, &items, &ns) == 5)
+            rows.push_back({ string(name) + " " + corpus, label, ns });
+    }
+    fclose(file);
+
+    int regressions = 0;
+    printf("\n%-28s %12s %12s %8s\n", "vs baseline", "before ns", "now ns", "change");
+    for (const BenchResult& result : results)
+    {
+        string key = result.Name + " " + result.Corpus;
+        auto it = find_if(rows.rbegin(), rows.rend(), [&](const Row& row) { return row.Key == key; });
+        if (it == rows.rend())
+            continue;
+        double change = result.Ns / it->Ns - 1.0;
+        bool regressed = change > tolerance;
+        regressions += regressed;
+        printf("%-28s %12.2f %12.2f %+7.1f%%%s\n", key.c_str(), it->Ns, result.Ns, change * 100.0, regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv)
+{
+    const char* journalPath = nullptr;
+    const char* csvPath = nullptr;
+    const char* baselinePath = nullptr;
+    string label = "current";
+    double tolerance = 0.10;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--journal"))
+            journalPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--csv"))
+            csvPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--label"))
+            label = argv[i + 1];
+        else if (!strcmp(argv[i], "--baseline"))
+            baselinePath = argv[i + 1];
+        else if (!strcmp(argv[i], "--tolerance"))
+            tolerance = atof(argv[i + 1]);
+        else
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    printf("%-16s %-10s %10s %12s %10s %12s\n", "benchmark", "corpus", "items", "ns/item", "allocs", "llc-miss");
+
+    vector<uint8_t> ascii = SyntheticStream(100000, 0.0);
+    vector<uint8_t> binary = SyntheticStream(100000, 1.0);
+    vector<uint8_t> mixed = SyntheticStream(100000, 0.5);
+    DecodeBenchmarks("ascii", ascii, true);
+    DecodeBenchmarks("binary", binary, false);
+    DecodeBenchmarks("mixed", mixed, false);
+
+    // a whole flight at 100 Hz, timestamped as ingest would
+    vector<TelemetrySample> flight = DecodeAll(ascii);
+    for (size_t i = 0; i < flight.size(); i++)
+        flight[i].hostTime = i / 100.0f;
+    SampleBenchmarks("synthetic", flight);
+
+    if (journalPath)
+    {
+        vector<uint8_t> recorded = LoadJournalStream(journalPath);
+        if (recorded.empty())
+            printf("No raw link data in %s\n", journalPath);
+        else
+        {
+            DecodeBenchmarks("recorded", recorded, true);
+            vector<TelemetrySample> samples = DecodeAll(recorded);
+            for (size_t i = 0; i < samples.size(); i++)
+                samples[i].hostTime = i / 100.0f;
+            SampleBenchmarks("recorded", samples);
+        }
+    }
+
+    if (!cacheMisses.Available())
+        printf("(cache miss counters unavailable: no perf events permission or not Linux)\n");
+    if (csvPath && !WriteCsv(csvPath, label))
+        printf("Cannot write %s\n", csvPath);
+    int regressions = baselinePath ? CompareBaseline(baselinePath, tolerance) : 0;
+    return regressions ? 1 : 0;
+}
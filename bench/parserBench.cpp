@@ -0,0 +1,155 @@
+// Frame parser benchmark: legacy substr/stoi decode vs. TelemetryParser.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++17 -Isrc bench/parserBench.cpp src/telemetryParser.cpp -o parserBench
+//   cl /O2 /std:c++17 /EHsc /Isrc bench\parserBench.cpp src\telemetryParser.cpp
+//
+// Usage: parserBench [corpus.txt]
+// The corpus is one raw frame per line, as captured from the link ("{Data:...:}" or "Data:...:").
+// Without a corpus a deterministic synthetic one is generated.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "telemetryParser.h"
+
+using namespace std;
+
+// Decode block as it was in main() before the parser existed. Only the altitude indices are
+// changed: the original read past the last delimiter and threw from stoi on every frame,
+// which would make the baseline measure exception handling instead of the decode.
+static bool LegacyDecode(const string& incoming, TelemetrySample& sample)
+{
+    if (count(incoming.begin(), incoming.end(), ':') >= 13)
+    {
+        const string& lastData = incoming;
+        if (lastData.length() >= 10)
+        {
+            int delimiterPositions[16];
+            delimiterPositions[0] = lastData.find_first_of(':');
+
+            for (int i = 1; i < 16; i++)
+            {
+                delimiterPositions[i] = lastData.find(':', delimiterPositions[i-1] + 1);
+            }
+
+            sample.xOrient = stoi(lastData.substr(delimiterPositions[1] + 1, delimiterPositions[2] - 1)) / 1.0f;
+            sample.yOrient = stoi(lastData.substr(delimiterPositions[2] + 1, delimiterPositions[3] - 1)) / 1.0f;
+            sample.zOrient = stoi(lastData.substr(delimiterPositions[3] + 1, delimiterPositions[4] - 1)) / 1.0f;
+            sample.xAccel = stoi(lastData.substr(delimiterPositions[4] + 1, delimiterPositions[5] - 1)) / 1.0f;
+            sample.yAccel = stoi(lastData.substr(delimiterPositions[5] + 1, delimiterPositions[6] - 1)) / 1.0f;
+            sample.zAccel = stoi(lastData.substr(delimiterPositions[6] + 1, delimiterPositions[7] - 1)) / 1.0f;
+            sample.xMag = stoi(lastData.substr(delimiterPositions[7] + 1, delimiterPositions[8] - 1)) / 1.0f;
+            sample.yMag = stoi(lastData.substr(delimiterPositions[8] + 1, delimiterPositions[9] - 1)) / 1.0f;
+            sample.zMag = stoi(lastData.substr(delimiterPositions[9] + 1, delimiterPositions[10] - 1)) / 1.0f;
+            sample.force = stoi(lastData.substr(delimiterPositions[10] + 1, delimiterPositions[11] - 1)) / 1.0f;
+            sample.temp = stoi(lastData.substr(delimiterPositions[11] + 1, delimiterPositions[12] - 1)) / 1.0f;
+            sample.time = stoi(lastData.substr(delimiterPositions[12] + 1, delimiterPositions[13] - 1)) / 1.0f;
+            sample.altitude = stoi(lastData.substr(delimiterPositions[12] + 1, delimiterPositions[13])) / 1.0f;
+            return true;
+        }
+    }
+    return false;
+}
+
+static vector<string> LoadCorpus(const char* path)
+{
+    vector<string> frames;
+    ifstream in(path);
+    string line;
+    while (getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty() && line.front() == '{')
+            line.erase(0, 1);
+        if (!line.empty() && line.back() == '}')
+            line.pop_back();
+        if (!line.empty())
+            frames.push_back(line);
+    }
+    return frames;
+}
+
+static vector<string> SyntheticCorpus(size_t count)
+{
+    vector<string> frames;
+    mt19937 rng(1234);
+    uniform_int_distribution<int> imu(-2000, 2000);
+    uniform_int_distribution<int> mag(-500, 500);
+    char buffer[256];
+    for (size_t i = 0; i < count; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "Data:%d:%d:%d:%d:%d:%d:%d:%d:%d:%d:%d:%d:%d:",
+            imu(rng), imu(rng), imu(rng), imu(rng), imu(rng), imu(rng),
+            mag(rng), mag(rng), mag(rng), (int)(rng() % 4000), 20 + (int)(rng() % 15), (int)i * 20, (int)(rng() % 3000));
+        frames.push_back(buffer);
+    }
+    return frames;
+}
+
+template<typename Decode>
+static double FramesPerSecond(const vector<string>& corpus, Decode decode, double& accepted)
+{
+    using clock = chrono::steady_clock;
+    TelemetrySample sample = {};
+    volatile float sink = 0.0f;
+    size_t frames = 0;
+    size_t decoded = 0;
+
+    clock::time_point start = clock::now();
+    clock::duration elapsed;
+    do
+    {
+        for (const string& frame : corpus)
+        {
+            if (decode(frame, sample))
+                decoded++;
+            sink = sink + sample.altitude;
+        }
+        frames += corpus.size();
+        elapsed = clock::now() - start;
+    } while (elapsed < chrono::seconds(1));
+
+    accepted = 100.0 * decoded / frames;
+    return frames / chrono::duration<double>(elapsed).count();
+}
+
+int main(int argc, char** argv)
+{
+    vector<string> corpus = (argc > 1) ? LoadCorpus(argv[1]) : SyntheticCorpus(10000);
+    if (corpus.empty())
+    {
+        printf("No frames in corpus\n");
+        return 1;
+    }
+
+    double legacyAccepted = 0.0;
+    double legacy = FramesPerSecond(corpus, [](const string& frame, TelemetrySample& sample)
+    {
+        try
+        {
+            return LegacyDecode(frame, sample);
+        }
+        catch (const exception&)
+        {
+            return false;
+        }
+    }, legacyAccepted);
+
+    double parserAccepted = 0.0;
+    double parser = FramesPerSecond(corpus, [](const string& frame, TelemetrySample& sample)
+    {
+        return ParseTelemetryFrame(frame, sample) == ParseStatus::Ok;
+    }, parserAccepted);
+
+    printf("corpus: %zu frames (%s)\n", corpus.size(), argc > 1 ? argv[1] : "synthetic");
+    printf("legacy substr/stoi : %12.0f frames/s  %5.1f%% accepted\n", legacy, legacyAccepted);
+    printf("TelemetryParser    : %12.0f frames/s  %5.1f%% accepted  (%.1fx)\n", parser, parserAccepted, parser / legacy);
+    return 0;
+}
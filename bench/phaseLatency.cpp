@@ -0,0 +1,194 @@
+// Flight-phase detection latency.
+//
+// Flies many synthetic flights with varied profiles and sensor noise through FlightPhaseDetector
+// and compares each detected event with the generator's ground truth:
+//   onset    time of the sample the event was stamped with, minus the true event time
+//   latency  time of the sample that confirmed the event (when the detector could first know),
+//            minus the true event time
+// With --journal, replays the samples of a recorded flight instead and reports, per session, when
+// each event was stamped and how long its hold took to confirm it.
+//
+// Build: part of the CMake build (phaseLatency target).
+// Usage: phaseLatency [--flights N] [--rate N] [--noise x] [--journal flight.tvj]
+// Exits with 1 if any synthetic flight missed an event.
+
+#include <algorithm>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "flightJournal.h"
+#include "flightPhase.h"
+#include "telemetryGenerator.h"
+
+using namespace std;
+
+// Phase each event starts in the generator's flights, where the drogue opens exactly at apogee
+static const FlightPhase EVENT_TRUTH_PHASE[FlightEvent_COUNT] =
+{
+    FlightPhase_Boost,      // launch
+    FlightPhase_Coast,      // burnout
+    FlightPhase_Drogue,     // apogee
+    FlightPhase_Drogue,     // drogue
+    FlightPhase_Main,       // main
+    FlightPhase_Landed,     // landing
+};
+
+struct EventStats
+{
+    int Detected;
+    vector<double> Onset;
+    vector<double> Latency;
+};
+
+static double Percentile(vector<double> values, double fraction)
+{
+    if (values.empty())
+        return 0.0;
+    sort(values.begin(), values.end());
+    return values[min(values.size() - 1, (size_t)(fraction * values.size()))];
+}
+
+static void PrintEvents(const FlightPhaseDetector& detector)
+{
+    for (int event = 0; event < FlightEvent_COUNT; event++)
+    {
+        if (!detector.Detected((FlightEvent)event))
+        {
+            printf("  %-8s not detected\n", FLIGHT_EVENT_NAMES[event]);
+            continue;
+        }
+        const FlightEventRecord& record = detector.Event((FlightEvent)event);
+        printf("  %-8s rocket time %9.3f s  host %9.3f s  confirmed %+7.0f ms\n", FLIGHT_EVENT_NAMES[event],
+            record.RocketTime, record.HostTime, (record.ConfirmedRocketTime - record.RocketTime) * 1000.0);
+    }
+}
+
+static int ReplayJournal(const char* path)
+{
+    JournalReader reader;
+    if (!reader.Open(path))
+    {
+        printf("Could not open %s\n", path);
+        return 2;
+    }
+
+    FlightPhaseDetector detector;
+    JournalRecord record;
+    TelemetrySample sample = {};
+    uint64_t samples = 0;
+    int session = 0;
+    while (reader.Next(record))
+    {
+        if (record.Type == JournalRecord_Session)
+        {
+            if (samples > 0)
+            {
+                printf("session %d: %llu samples, ended in %s\n", session, (unsigned long long)samples, FLIGHT_PHASE_NAMES[detector.Phase()]);
+                PrintEvents(detector);
+            }
+            detector.Reset();
+            samples = 0;
+            session++;
+        }
+        if (DecodeSampleRecord(record, sample))
+        {
+            detector.Update(sample);
+            samples++;
+        }
+    }
+    if (samples > 0)
+    {
+        printf("session %d: %llu samples, ended in %s\n", session, (unsigned long long)samples, FLIGHT_PHASE_NAMES[detector.Phase()]);
+        PrintEvents(detector);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int flights = 50;
+    double rate = 100.0;
+    double noise = 1.0;
+    const char* journalPath = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* arg = argv[i];
+        const char* value = argv[i + 1];
+        if (!strcmp(arg, "--flights"))
+            flights = atoi(value);
+        else if (!strcmp(arg, "--rate"))
+            rate = atof(value);
+        else if (!strcmp(arg, "--noise"))
+            noise = atof(value);
+        else if (!strcmp(arg, "--journal"))
+            journalPath = value;
+        else
+        {
+            printf("Unknown option %s\n", arg);
+            return 2;
+        }
+    }
+    if (journalPath)
+        return ReplayJournal(journalPath);
+
+    EventStats stats[FlightEvent_COUNT] = {};
+    mt19937 rng(12345);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+    FlightPhaseDetector detector;
+
+    for (int flight = 0; flight < flights; flight++)
+    {
+        FlightProfile profile;
+        profile.PadSeconds = 2.0 + 8.0 * uniform(rng);
+        profile.BurnSeconds = 1.5 + 2.5 * uniform(rng);
+        profile.BoostAcceleration = 60.0 + 80.0 * uniform(rng);
+        profile.DrogueDescentRate = 15.0 + 20.0 * uniform(rng);
+        profile.MainDeployAltitude = 150.0 + 150.0 * uniform(rng);
+        profile.MainDescentRate = 4.0 + 4.0 * uniform(rng);
+
+        TelemetryGenerator generator(profile, 1 + flight);
+        generator.SetNoise(noise);
+        detector.Reset();
+
+        uint64_t frames = (uint64_t)(generator.Duration() * rate);
+        for (uint64_t frame = 0; frame < frames; frame++)
+        {
+            double t = frame / rate;
+            TelemetrySample sample = generator.NoisySample(t);
+            sample.hostTime = (float)t;
+            detector.Update(sample);
+        }
+
+        for (int event = 0; event < FlightEvent_COUNT; event++)
+        {
+            if (!detector.Detected((FlightEvent)event))
+                continue;
+            const FlightEventRecord& record = detector.Event((FlightEvent)event);
+            double truth = generator.PhaseStart(EVENT_TRUTH_PHASE[event]);
+            stats[event].Detected++;
+            stats[event].Onset.push_back(record.RocketTime - truth);
+            stats[event].Latency.push_back(record.ConfirmedRocketTime - truth);
+        }
+    }
+
+    printf("%d flights at %.0f frames/s, noise %.1f\n", flights, rate, noise);
+    printf("%-8s %9s %12s %12s %12s %12s %12s\n", "event", "detected", "onset p50", "onset max", "latency p50", "latency p99", "latency max");
+    bool missed = false;
+    for (int event = 0; event < FlightEvent_COUNT; event++)
+    {
+        const EventStats& s = stats[event];
+        vector<double> absOnset;
+        for (double onset : s.Onset)
+            absOnset.push_back(fabs(onset));
+        printf("%-8s %5d/%-3d %9.0f ms %9.0f ms %9.0f ms %9.0f ms %9.0f ms\n", FLIGHT_EVENT_NAMES[event], s.Detected, flights,
+            Percentile(s.Onset, 0.5) * 1000.0, Percentile(absOnset, 1.0) * 1000.0,
+            Percentile(s.Latency, 0.5) * 1000.0, Percentile(s.Latency, 0.99) * 1000.0, Percentile(s.Latency, 1.0) * 1000.0);
+        missed |= s.Detected < flights;
+    }
+    return missed ? 1 : 0;
+}
@@ -0,0 +1,274 @@
+// SamplePublisher throughput, drops and delivery latency on localhost (POSIX only).
+//
+// A producer thread plays the ingest's merge step: it stamps samples with MonotonicNanoseconds()
+// and hands them to PublishSample() at a fixed rate. Three subscribers receive them:
+//   multicast  joins the group on the loopback interface and reads every datagram
+//   ws fast    a WebSocket subscriber reading as fast as it can
+//   ws slow    a WebSocket subscriber reading a few KB at a time with a small socket buffer, so its
+//              per-subscriber buffer fills and the publisher drops packets for it
+// Latency is from the sample's stamp to the subscriber decoding it. The cost of PublishSample()
+// on the producer is timed too, to show that a slow subscriber never reaches back into ingest.
+//
+// Build: part of the CMake build (publishLatency target).
+// Usage: publishLatency [--rate N] [--seconds N] [--slow N] [--port N]
+//   --rate N          samples/s handed to the publisher (default 20000)
+//   --seconds N       length of the run (default 3)
+//   --slow N          bytes/s the slow subscriber reads (default 200000)
+//   --port N          WebSocket port on 127.0.0.1; multicast uses N + 1 (default 7680)
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "latencyHistogram.h"
+#include "publishProtocol.h"
+#include "samplePublisher.h"
+
+using namespace std;
+
+struct Receiver
+{
+    const char* Name;
+    LatencyHistogram Latency;
+    uint64_t Samples;
+    uint64_t Packets;
+    uint64_t PacketsMissed;     // gaps in the packet sequence
+    bool Connected;
+};
+
+static void Deliver(Receiver& receiver, const uint8_t* packet, size_t length, bool& have_sequence, uint32_t& next_sequence)
+{
+    TelemetrySample samples[PUBLISH_MAX_SAMPLES];
+    uint32_t sequence;
+    size_t count = DecodePublishPacket(packet, length, sequence, samples);
+    if (count == 0)
+        return;
+    uint64_t now = MonotonicNanoseconds();
+    for (size_t i = 0; i < count; i++)
+        receiver.Latency.Record(now - samples[i].arrivalNs);
+    if (have_sequence && sequence != next_sequence)
+        receiver.PacketsMissed += sequence - next_sequence;
+    have_sequence = true;
+    next_sequence = sequence + 1;
+    receiver.Samples += count;
+    receiver.Packets++;
+}
+
+static void ReceiveMulticast(Receiver& receiver, uint16_t port, const atomic<bool>& running)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    int buffer = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    timeval timeout = { 0, 100000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    ip_mreq membership = {};
+    inet_pton(AF_INET, PublisherConfig().MulticastGroup.c_str(), &membership.imr_multiaddr);
+    inet_pton(AF_INET, "127.0.0.1", &membership.imr_interface);
+    receiver.Connected = bind(fd, (sockaddr*)&address, sizeof(address)) == 0
+        && setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) == 0;
+
+    bool have_sequence = false;
+    uint32_t next_sequence = 0;
+    uint8_t packet[2048];
+    while (receiver.Connected && running.load())
+    {
+        ssize_t length = recv(fd, packet, sizeof(packet), 0);
+        if (length > 0)
+            Deliver(receiver, packet, length, have_sequence, next_sequence);
+    }
+    close(fd);
+}
+
+// Minimal WebSocket client: handshake, then unmasked binary frames from the server.
+// slow_bytes_per_second 0 reads as fast as the data comes.
+static void ReceiveWebSocket(Receiver& receiver, uint16_t port, int slow_bytes_per_second, const atomic<bool>& running)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (slow_bytes_per_second > 0)
+    {
+        int buffer = 4096;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    }
+    timeval timeout = { 0, 100000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return;
+    }
+
+    // the RFC 6455 sample key and its accept value
+    const char request[] = "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    if (send(fd, request, sizeof(request) - 1, MSG_NOSIGNAL) != (ssize_t)sizeof(request) - 1)
+    {
+        close(fd);
+        return;
+    }
+
+    vector<uint8_t> in;
+    bool have_sequence = false;
+    uint32_t next_sequence = 0;
+    uint8_t chunk[65536];
+    size_t chunk_size = slow_bytes_per_second > 0 ? 1024 : sizeof(chunk);
+    while (running.load())
+    {
+        ssize_t length = recv(fd, chunk, chunk_size, 0);
+        if (length == 0)
+            break;
+        if (length > 0)
+            in.insert(in.end(), chunk, chunk + length);
+        if (slow_bytes_per_second > 0 && length > 0)
+            this_thread::sleep_for(chrono::microseconds(length * 1000000LL / slow_bytes_per_second));
+
+        size_t at = 0;
+        if (!receiver.Connected)
+        {
+            string response(in.begin(), in.end());
+            size_t end = response.find("\r\n\r\n");
+            if (end == string::npos)
+                continue;
+            if (response.compare(0, 12, "HTTP/1.1 101") != 0
+                || response.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == string::npos)
+                break;
+            receiver.Connected = true;
+            at = end + 4;
+        }
+        while (in.size() - at >= 2)
+        {
+            size_t header = 2;
+            size_t payload = in[at + 1] & 0x7F;
+            if (payload == 126)
+            {
+                if (in.size() - at < 4)
+                    break;
+                payload = (size_t)in[at + 2] << 8 | in[at + 3];
+                header = 4;
+            }
+            if (in.size() - at < header + payload)
+                break;
+            if ((in[at] & 0x0F) == 0x2)
+                Deliver(receiver, &in[at + header], payload, have_sequence, next_sequence);
+            at += header + payload;
+        }
+        in.erase(in.begin(), in.begin() + at);
+    }
+    close(fd);
+}
+
+int main(int argc, char** argv)
+{
+    double rate = 20000.0;
+    double seconds = 3.0;
+    int slow = 200000;
+    int port = 7680;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* arg = argv[i];
+        const char* value = argv[i + 1];
+        if (!strcmp(arg, "--rate"))
+            rate = atof(value);
+        else if (!strcmp(arg, "--seconds"))
+            seconds = atof(value);
+        else if (!strcmp(arg, "--slow"))
+            slow = atoi(value);
+        else if (!strcmp(arg, "--port"))
+            port = atoi(value);
+        else
+        {
+            printf("Unknown option %s\n", arg);
+            return 2;
+        }
+    }
+
+    PublisherConfig config;
+    config.WebSocketPort = (uint16_t)port;
+    config.MulticastPort = (uint16_t)(port + 1);
+    SamplePublisher publisher;
+    if (!publisher.Start(config))
+    {
+        printf("Could not open the publisher's sockets on port %d\n", port);
+        return 1;
+    }
+
+    Receiver receivers[3] = { { "multicast" }, { "ws fast" }, { "ws slow" } };
+    atomic<bool> receiving(true);
+    thread multicast(ReceiveMulticast, ref(receivers[0]), config.MulticastPort, cref(receiving));
+    thread fast(ReceiveWebSocket, ref(receivers[1]), config.WebSocketPort, 0, cref(receiving));
+    thread slowReader(ReceiveWebSocket, ref(receivers[2]), config.WebSocketPort, slow, cref(receiving));
+    while (publisher.Subscribers() < 2)
+        this_thread::sleep_for(chrono::milliseconds(10));
+
+    // the producer, paced in bursts of the due samples every 100 us
+    LatencyHistogram publishCost;
+    uint64_t total = (uint64_t)(rate * seconds);
+    uint64_t start = MonotonicNanoseconds();
+    TelemetrySample sample = {};
+    sample.format = FRAME_FORMAT_BINARY;
+    for (uint64_t produced = 0; produced < total;)
+    {
+        uint64_t due = (uint64_t)((MonotonicNanoseconds() - start) * 1e-9 * rate);
+        for (; produced < due && produced < total; produced++)
+        {
+            sample.arrivalNs = MonotonicNanoseconds();
+            sample.hostTime = (float)((sample.arrivalNs - start) * 1e-9);
+            sample.sequence = (uint16_t)produced;
+            sample.altitude = (float)produced;
+            publisher.PublishSample(sample);
+            publishCost.Record(MonotonicNanoseconds() - sample.arrivalNs);
+        }
+        this_thread::sleep_for(chrono::microseconds(100));
+    }
+    double elapsed = (MonotonicNanoseconds() - start) * 1e-9;
+
+    this_thread::sleep_for(chrono::milliseconds(300));
+    receiving.store(false);
+    multicast.join();
+    fast.join();
+    slowReader.join();
+    publisher.Stop();
+
+    printf("%llu samples in %.2f s (%.0f samples/s), slow subscriber reads %d B/s\n", (unsigned long long)total, elapsed,
+        total / elapsed, slow);
+    printf("publisher: %llu published, %llu dropped at the queue, %llu datagrams sent, %llu datagrams dropped, "
+        "%llu subscriber packets dropped\n", (unsigned long long)publisher.SamplesPublished(),
+        (unsigned long long)publisher.SamplesDropped(), (unsigned long long)publisher.PacketsSent(),
+        (unsigned long long)publisher.MulticastDropped(), (unsigned long long)publisher.SubscriberDropped());
+    printf("PublishSample() on the producer: p50 %.0f ns, p99 %.0f ns, max %.0f ns\n", (double)publishCost.Percentile(0.5),
+        (double)publishCost.Percentile(0.99), (double)publishCost.Max());
+    printf("%-10s %10s %10s %10s %10s %10s %10s\n", "subscriber", "samples", "packets", "missed", "p50 us", "p99 us",
+        "max us");
+    for (Receiver& receiver : receivers)
+    {
+        if (!receiver.Connected)
+        {
+            printf("%-10s not connected\n", receiver.Name);
+            continue;
+        }
+        printf("%-10s %10llu %10llu %10llu %10.1f %10.1f %10.1f\n", receiver.Name, (unsigned long long)receiver.Samples,
+            (unsigned long long)receiver.Packets, (unsigned long long)receiver.PacketsMissed,
+            receiver.Latency.Percentile(0.5) * 1e-3, receiver.Latency.Percentile(0.99) * 1e-3, receiver.Latency.Max() * 1e-3);
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Serial link loopback over a pseudo-terminal pair (POSIX only).
+//
+// A writer thread plays the flight computer on the pty master; the slave is opened through the
+// normal SimpleSerial termios/epoll backend and decoded with LinkDecoder, exactly as the ingest
+// thread does on real hardware. Checks that every frame arrives and that uplink commands reach
+// the other end, and reports throughput and read sizes.
+//
+// Build: part of the CMake build (serialLoopback target).
+// Usage: serialLoopback [frames] [vmin]
+//   frames  frames to send (default 200000)
+//   vmin    termios VMIN for the slave (default 1); larger batches more bytes per wakeup
+
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <simple-serial-port/simple-serial-port/SimpleSerial.h>
+#include "linkDecoder.h"
+
+using namespace std;
+
+static vector<char> BuildStream(size_t frames)
+{
+    vector<char> stream;
+    char buffer[256];
+    for (size_t i = 0; i < frames; i++)
+    {
+        int length = snprintf(buffer, sizeof(buffer), "{Data:%d:%d:%d:%d:%d:%d:%d:%d:%d:%d:%d:%d:%d:}",
+            (int)(i % 360), -(int)(i % 2000), 15, 120, -9810, 40, -200, 310, 95, (int)(i % 4000), 24,
+            (int)(i * 10), (int)(i % 3000));
+        stream.insert(stream.end(), buffer, buffer + length);
+    }
+    return stream;
+}
+
+int main(int argc, char** argv)
+{
+    size_t frames = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    unsigned char vmin = argc > 2 ? (unsigned char)atoi(argv[2]) : 1;
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        printf("Could not open a pseudo-terminal pair\n");
+        return 1;
+    }
+    string slave_name = ptsname(master);
+
+    SimpleSerial serial(&slave_name[0], 115200);
+    if (!serial.connected_ || !serial.SetReadThreshold(vmin, 0))
+    {
+        printf("Could not open %s\n", slave_name.c_str());
+        return 1;
+    }
+
+    // uplink: a command written on the slave must come out of the master unchanged
+    char command[] = "r";
+    bool uplink_ok = serial.WriteSerialPort(command);
+    char echoed = 0;
+    pollfd master_readable = { master, POLLIN, 0 };
+    uplink_ok = uplink_ok && poll(&master_readable, 1, 1000) == 1 && read(master, &echoed, 1) == 1 && echoed == 'r';
+
+    vector<char> stream = BuildStream(frames);
+    thread writer([&]()
+    {
+        // the pty buffer is a few KB, so the writer is paced by the reader like a real link
+        size_t sent = 0;
+        while (sent < stream.size())
+        {
+            ssize_t written = write(master, stream.data() + sent, min<size_t>(stream.size() - sent, 1024));
+            if (written <= 0)
+                break;
+            sent += written;
+        }
+    });
+
+    LinkDecoder decoder;
+    size_t decoded = 0;
+    size_t reads = 0;
+    size_t bytes = 0;
+    int64_t last_time = -1;
+    bool in_order = true;
+    vector<uint8_t> buffer(SimpleSerial::READ_CHUNK_SIZE);
+
+    auto start = chrono::steady_clock::now();
+    while (decoded < frames)
+    {
+        int bytes_read = serial.ReadSerialBytes(1000, (char*)buffer.data(), buffer.size());
+        if (bytes_read <= 0)
+            break;
+        reads++;
+        bytes += bytes_read;
+        decoder.Feed(buffer.data(), bytes_read, [&](const TelemetrySample& sample)
+        {
+            in_order = in_order && (int64_t)sample.rocketMs > last_time;
+            last_time = sample.rocketMs;
+            decoded++;
+        });
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    writer.join();
+    serial.CloseSerialPort();
+    close(master);
+
+    printf("pty        : %s (VMIN %u)\n", slave_name.c_str(), vmin);
+    printf("uplink     : %s\n", uplink_ok ? "ok" : "FAILED");
+    printf("frames     : %zu of %zu decoded, %llu rejected, %s\n", decoded, frames,
+        (unsigned long long)decoder.Rejected(), in_order ? "in order" : "OUT OF ORDER");
+    printf("throughput : %12.0f frames/s  %8.1f MB/s\n", decoded / seconds, bytes / seconds * 1e-6);
+    printf("reads      : %zu  (%.0f bytes per read)\n", reads, reads ? (double)bytes / reads : 0.0);
+
+    bool ok = uplink_ok && in_order && decoded == frames && decoder.Rejected() == 0;
+    return ok ? 0 : 1;
+}
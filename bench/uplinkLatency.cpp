@@ -0,0 +1,226 @@
+// Uplink command latency over a pseudo-terminal pair (POSIX only).
+//
+// A flight-computer thread on the master side streams telemetry frames and answers every
+// "{Cmd:<seq>:<code>}" with "{Ack:<seq>}"; the ground side is the real path (TelemetryIngest ->
+// CommandUplink -> SerialSource -> SimpleSerial). Commands are sent at random moments between
+// frames and timed at three points:
+//   wire     SendCommand() to the write returning on the ingest thread
+//   arrival  SendCommand() to the flight computer reading the command
+//   ack      SendCommand() to the read carrying the ack
+// Each run is made twice: with the ingest thread's read interrupted for the command, and with the
+// interrupt disabled, where the command waits for the read in progress to finish.
+//
+// Build: part of the CMake build (uplinkLatency target).
+// Usage: uplinkLatency [--commands N] [--rate N] [--drop f]
+//   --commands N      commands per run (default 200)
+//   --rate N          telemetry frames/s from the flight computer, 0 = quiet link (default 20)
+//   --drop f          fraction of commands the flight computer ignores, to exercise retries (default 0)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "latencyHistogram.h"
+#include "serialSource.h"
+#include "telemetryGenerator.h"
+#include "telemetryIngest.h"
+
+using namespace std;
+
+// The same link without Interrupt(): a queued command goes out when the current read returns.
+class UninterruptedSource : public SerialSource
+{
+public:
+    explicit UninterruptedSource(SimpleSerial& serial) : SerialSource(serial) {}
+    void Interrupt() override {}
+};
+
+struct RunResult
+{
+    LatencyHistogram Wire;
+    LatencyHistogram Arrival;
+    LatencyHistogram Ack;
+    int Acked;
+    int Failed;
+    int Retried;
+};
+
+static void PrintRow(const char* mode, const char* stage, const LatencyHistogram& histogram)
+{
+    printf("%-12s %-8s %8llu %10.3f %10.3f %10.3f %10.3f\n", mode, stage, (unsigned long long)histogram.Count(),
+        histogram.Percentile(0.5) * 1e-6, histogram.Percentile(0.9) * 1e-6, histogram.Percentile(0.99) * 1e-6,
+        histogram.Max() * 1e-6);
+}
+
+static RunResult Run(const char* slaveName, int master, bool interrupt, int commands, double rate, double drop)
+{
+    RunResult result = {};
+    result.Wire.Reset();
+    result.Arrival.Reset();
+    result.Ack.Reset();
+
+    string port = slaveName;
+    SimpleSerial serial(&port[0], 115200);
+    SerialSource interrupted(serial);
+    UninterruptedSource uninterrupted(serial);
+    TelemetryIngest ingest(interrupt ? (TelemetrySource*)&interrupted : (TelemetrySource*)&uninterrupted);
+    ingest.Start();
+
+    // flight computer: frames at rate, commands answered as soon as they arrive
+    vector<atomic<uint64_t>> arrivalNs(65536);
+    atomic<bool> flying(true);
+    thread flightComputer([&]()
+    {
+        TelemetryGenerator generator;
+        mt19937 rng(7);
+        uniform_real_distribution<double> uniform(0.0, 1.0);
+        vector<uint8_t> frame(TelemetryGenerator::MAX_FRAME_BYTES);
+        string pending;
+        uint64_t start = MonotonicNanoseconds();
+        uint64_t frames = 0;
+        while (flying.load())
+        {
+            int wait_ms = 5;
+            if (rate > 0.0)
+            {
+                double next = (frames + 1) / rate;
+                double elapsed = (MonotonicNanoseconds() - start) * 1e-9;
+                wait_ms = max(0, (int)((next - elapsed) * 1000.0));
+            }
+            pollfd readable = { master, POLLIN, 0 };
+            if (poll(&readable, 1, wait_ms) > 0)
+            {
+                char chunk[256];
+                ssize_t bytes_read = read(master, chunk, sizeof(chunk));
+                uint64_t now = MonotonicNanoseconds();
+                if (bytes_read > 0)
+                    pending.append(chunk, bytes_read);
+
+                size_t front;
+                while ((front = pending.find('{')) != string::npos)
+                {
+                    size_t end = pending.find('}', front);
+                    if (end == string::npos)
+                        break;
+                    unsigned sequence;
+                    char code;
+                    bool command = sscanf(pending.c_str() + front, "{Cmd:%u:%c}", &sequence, &code) == 2;
+                    pending.erase(0, end + 1);
+                    if (!command || uniform(rng) < drop)
+                        continue;
+                    uint64_t first = 0;
+                    arrivalNs[sequence & 0xFFFF].compare_exchange_strong(first, now);
+                    char ack[16];
+                    int length = snprintf(ack, sizeof(ack), "{Ack:%u}", sequence);
+                    ssize_t written = write(master, ack, length);
+                    (void)written;
+                }
+            }
+            if (rate > 0.0 && (MonotonicNanoseconds() - start) * 1e-9 >= (frames + 1) / rate)
+            {
+                size_t length = generator.NextFrame(frames / rate, frame.data());
+                ssize_t written = write(master, frame.data(), length);
+                (void)written;
+                frames++;
+            }
+        }
+    });
+
+    // ground station: one command at a random moment, then wait for it to finish
+    mt19937 rng(11);
+    uniform_int_distribution<int> pause(5, 50);
+    vector<TelemetrySample> drained(TelemetryIngest::RING_CAPACITY);
+    for (int i = 0; i < commands; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(pause(rng)));
+        int sequence = ingest.SendCommand(i % 2 ? UplinkCommand_CancelRelease : UplinkCommand_ReleasePayload);
+        if (sequence < 0)
+            continue;
+
+        CommandStatus status = {};
+        for (;;)
+        {
+            ingest.Drain(drained.data(), drained.size());
+            ingest.Uplink().Recent(&status, 1);
+            if (status.Sequence == sequence && (status.State == CommandState_Acked || status.State == CommandState_Failed))
+                break;
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+
+        if (status.WrittenNs != 0)
+            result.Wire.Record(status.WrittenNs - status.RequestedNs);
+        uint64_t arrival = arrivalNs[sequence].load();
+        if (arrival != 0)
+            result.Arrival.Record(arrival - status.RequestedNs);
+        if (status.State == CommandState_Acked)
+        {
+            result.Ack.Record(status.AckedNs - status.RequestedNs);
+            result.Acked++;
+        }
+        else
+            result.Failed++;
+        result.Retried += status.Attempts > 1;
+    }
+
+    ingest.Stop();
+    flying.store(false);
+    flightComputer.join();
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int commands = 200;
+    double rate = 20.0;
+    double drop = 0.0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* arg = argv[i];
+        const char* value = argv[i + 1];
+        if (!strcmp(arg, "--commands"))
+            commands = atoi(value);
+        else if (!strcmp(arg, "--rate"))
+            rate = atof(value);
+        else if (!strcmp(arg, "--drop"))
+            drop = atof(value);
+        else
+        {
+            printf("Unknown option %s\n", arg);
+            return 2;
+        }
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        printf("Could not open a pseudo-terminal pair\n");
+        return 1;
+    }
+    string slaveName = ptsname(master);
+
+    printf("pty %s, %d commands per run, telemetry at %.0f frames/s, %.0f%% of commands dropped\n", slaveName.c_str(),
+        commands, rate, drop * 100.0);
+    printf("%-12s %-8s %8s %10s %10s %10s %10s\n", "read", "stage", "count", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    const bool modes[] = { true, false };
+    for (bool interrupt : modes)
+    {
+        RunResult result = Run(slaveName.c_str(), master, interrupt, commands, rate, drop);
+        const char* mode = interrupt ? "interrupted" : "waited out";
+        PrintRow(mode, "wire", result.Wire);
+        PrintRow(mode, "arrival", result.Arrival);
+        PrintRow(mode, "ack", result.Ack);
+        printf("%-12s %d acked, %d failed, %d needed a retry\n", mode, result.Acked, result.Failed, result.Retried);
+    }
+    close(master);
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include "binaryProtocol.h"
+#include <string.h>
+#include <utility>
+
+struct Crc16Table
+{
+    uint16_t Entries[256];
+
+    constexpr Crc16Table() : Entries()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            uint16_t crc = (uint16_t)(i << 8);
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+            Entries[i] = crc;
+        }
+    }
+};
+
+static constexpr Crc16Table CRC16_TABLE;
+
+uint16_t Crc16(const uint8_t* data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++)
+        crc = (uint16_t)((crc << 8) ^ CRC16_TABLE.Entries[(crc >> 8) ^ data[i]]);
+    return crc;
+}
+
+size_t CobsEncode(const uint8_t* data, size_t length, uint8_t* out)
+{
+    size_t code_index = 0;
+    size_t write_index = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (data[i] != 0)
+        {
+            out[write_index++] = data[i];
+            code++;
+        }
+        if (data[i] == 0 || code == 0xFF)
+        {
+            out[code_index] = code;
+            code = 1;
+            code_index = write_index++;
+        }
+    }
+
+    out[code_index] = code;
+    return write_index;
+}
+
+size_t CobsDecode(const uint8_t* data, size_t length, uint8_t* out, size_t out_capacity)
+{
+    size_t read_index = 0;
+    size_t write_index = 0;
+
+    while (read_index < length)
+    {
+        uint8_t code = data[read_index++];
+        if (code == 0 || read_index + code - 1 > length)
+            return 0;
+
+        for (uint8_t i = 1; i < code; i++)
+        {
+            if (write_index == out_capacity || data[read_index] == 0)
+                return 0;
+            out[write_index++] = data[read_index++];
+        }
+
+        if (code != 0xFF && read_index != length)
+        {
+            if (write_index == out_capacity)
+                return 0;
+            out[write_index++] = 0;
+        }
+    }
+
+    return write_index;
+}
+
+static void PutU16(uint8_t*& p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p += 2; }
+static void PutU32(uint8_t*& p, uint32_t v) { PutU16(p, (uint16_t)v); PutU16(p, (uint16_t)(v >> 16)); }
+static uint16_t GetU16(const uint8_t*& p) { uint16_t v = (uint16_t)(p[0] | (p[1] << 8)); p += 2; return v; }
+static uint32_t GetU32(const uint8_t*& p) { uint32_t lo = GetU16(p); return lo | ((uint32_t)GetU16(p) << 16); }
+
+template<int Wire>
+static void PutField(uint8_t*& p, const TelemetrySample& sample)
+{
+    constexpr ChannelDef def = CHANNELS[WIRE_ORDER.Channels[Wire]];
+    float value = sample.*def.member;
+    if constexpr (def.scale != 1.0f)
+        value /= def.scale;
+
+    if constexpr (def.type == ChannelType::I16)
+        PutU16(p, (uint16_t)(int16_t)value);
+    else if constexpr (def.type == ChannelType::I32)
+        PutU32(p, (uint32_t)(int32_t)value);
+    else if constexpr (def.member == &TelemetrySample::time)
+        PutU32(p, sample.rocketMs);
+    else if constexpr (def.type == ChannelType::U32)
+        PutU32(p, (uint32_t)value);
+    else
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        PutU32(p, bits);
+    }
+}
+
+template<int Wire>
+static void GetField(const uint8_t*& p, TelemetrySample& sample)
+{
+    constexpr ChannelDef def = CHANNELS[WIRE_ORDER.Channels[Wire]];
+    float value;
+
+    if constexpr (def.type == ChannelType::I16)
+        value = (float)(int16_t)GetU16(p);
+    else if constexpr (def.type == ChannelType::I32)
+        value = (float)(int32_t)GetU32(p);
+    else if constexpr (def.member == &TelemetrySample::time)
+    {
+        sample.rocketMs = GetU32(p);
+        value = (float)sample.rocketMs;
+    }
+    else if constexpr (def.type == ChannelType::U32)
+        value = (float)GetU32(p);
+    else
+    {
+        uint32_t bits = GetU32(p);
+        memcpy(&value, &bits, sizeof(value));
+    }
+
+    if constexpr (def.scale != 1.0f)
+        value *= def.scale;
+    sample.*def.member = value;
+}
+
+template<int... Wire>
+static void PutFields(uint8_t*& p, const TelemetrySample& sample, std::integer_sequence<int, Wire...>)
+{
+    (PutField<Wire>(p, sample), ...);
+}
+
+template<int... Wire>
+static void GetFields(const uint8_t*& p, TelemetrySample& sample, std::integer_sequence<int, Wire...>)
+{
+    (GetField<Wire>(p, sample), ...);
+}
+
+size_t EncodeBinaryPacket(const TelemetrySample& sample, uint16_t sequence, uint8_t* out)
+{
+    uint8_t payload[BINARY_PAYLOAD_SIZE];
+    uint8_t* p = payload;
+
+    *p++ = BINARY_PACKET_TYPE;
+    PutU16(p, sequence);
+    PutFields(p, sample, std::make_integer_sequence<int, Channel_COUNT>());
+    PutU16(p, Crc16(payload, p - payload));
+
+    size_t written = CobsEncode(payload, BINARY_PAYLOAD_SIZE, out);
+    out[written++] = 0;
+    return written;
+}
+
+ParseStatus DecodeBinaryPacket(const uint8_t* encoded, size_t length, TelemetrySample& sample)
+{
+    uint8_t payload[BINARY_PAYLOAD_SIZE];
+    if (length != BINARY_ENCODED_SIZE || CobsDecode(encoded, length, payload, sizeof(payload)) != BINARY_PAYLOAD_SIZE)
+        return ParseStatus::BadLength;
+    if (payload[0] != BINARY_PACKET_TYPE)
+        return ParseStatus::MissingHeader;
+
+    const uint8_t* p = payload + BINARY_PAYLOAD_SIZE - 2;
+    if (GetU16(p) != Crc16(payload, BINARY_PAYLOAD_SIZE - 2))
+        return ParseStatus::BadChecksum;
+
+    p = payload + 1;
+    sample.sequence = GetU16(p);
+    GetFields(p, sample, std::make_integer_sequence<int, Channel_COUNT>());
+    sample.format = FRAME_FORMAT_BINARY;
+    return ParseStatus::Ok;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "telemetryParser.h"
+#include "telemetrySample.h"
+
+// Compact binary downlink, sent as an alternative to the ASCII "{Data:...:}" frame.
+//
+// Payload (little-endian):
+//   u8  type        BINARY_PACKET_TYPE
+//   u16 sequence    increments by one per packet, wraps at 65535
+//   ... one field per channel in TELEMETRY_CHANNELS wire order, sized by its ChannelType
+//   u16 crc         CRC-16/CCITT-FALSE over every byte before it
+//
+// The payload is COBS encoded and terminated by a 0x00 byte, so a receiver can always
+// resynchronize at the next 0x00. Senders should also emit a 0x00 before the first packet.
+
+constexpr size_t BinaryFieldBytes()
+{
+    size_t bytes = 0;
+    for (int c = 0; c < Channel_COUNT; c++)
+        bytes += ChannelWireBytes(CHANNELS[c].type);
+    return bytes;
+}
+
+static const uint8_t BINARY_PACKET_TYPE = 0xB1;
+static const size_t BINARY_PAYLOAD_SIZE = 1 + 2 + BinaryFieldBytes() + 2;
+static const size_t BINARY_ENCODED_SIZE = BINARY_PAYLOAD_SIZE + 1;     // COBS adds one byte per 254
+static const size_t BINARY_WIRE_SIZE = BINARY_ENCODED_SIZE + 1;        // plus the 0x00 delimiter
+static_assert(BINARY_PAYLOAD_SIZE < 254, "binary packets must stay below one COBS block so their encoded size is fixed");
+
+uint16_t Crc16(const uint8_t* data, size_t length);
+
+// COBS encode/decode. CobsEncode writes at most length + length / 254 + 1 bytes and no delimiter.
+// CobsDecode returns the decoded length, or 0 when the input is not valid COBS.
+size_t CobsEncode(const uint8_t* data, size_t length, uint8_t* out);
+size_t CobsDecode(const uint8_t* data, size_t length, uint8_t* out, size_t out_capacity);
+
+// Writes BINARY_WIRE_SIZE bytes (encoded packet and trailing 0x00) into out.
+size_t EncodeBinaryPacket(const TelemetrySample& sample, uint16_t sequence, uint8_t* out);
+
+// Decodes one COBS encoded packet without its 0x00 delimiter.
+ParseStatus DecodeBinaryPacket(const uint8_t* encoded, size_t length, TelemetrySample& sample);
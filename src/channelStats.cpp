@@ -0,0 +1,150 @@
+#include "channelStats.h"
+#include <algorithm>
+#include <math.h>
+
+ChannelStats::ChannelStats(int column_count, const ChannelStatsConfig& config)
+    : column_count_(column_count)
+{
+    SetConfig(config);
+}
+
+void ChannelStats::SetConfig(const ChannelStatsConfig& config)
+{
+    config_ = config;
+    capacity_ = 1;
+    while (capacity_ < config.MaxWindowSamples)
+        capacity_ *= 2;
+    mask_ = capacity_ - 1;
+
+    times_.assign(capacity_, 0.0f);
+    values_.assign(capacity_ * column_count_, 0.0f);
+    min_slots_.assign(capacity_ * column_count_, 0);
+    max_slots_.assign(capacity_ * column_count_, 0);
+    columns_.assign(column_count_, Column());
+    for (Column& column : columns_)
+        column.WindowSeconds = config.WindowSeconds;
+    Reset();
+}
+
+void ChannelStats::Reset()
+{
+    head_ = 0;
+    for (Column& column : columns_)
+    {
+        float window = column.WindowSeconds;
+        column = Column();
+        column.WindowSeconds = window;
+    }
+}
+
+void ChannelStats::Remove(int c, uint64_t row)
+{
+    Column& column = columns_[c];
+    if (column.MinDeque.Front != column.MinDeque.Back && Slot(min_slots_, c, column.MinDeque.Front) == row)
+        column.MinDeque.Front++;
+    if (column.MaxDeque.Front != column.MaxDeque.Back && Slot(max_slots_, c, column.MaxDeque.Front) == row)
+        column.MaxDeque.Front++;
+
+    uint64_t count = head_ - row - 1;   // left in the window afterwards
+    column.Tail = row + 1;
+    if (count == 0)
+    {
+        column.MeanTime = column.MeanValue = column.M2Time = column.M2Value = column.CoMoment = 0.0;
+        return;
+    }
+
+    double t = times_[row & mask_];
+    double x = Value(row, c);
+    double inverse = 1.0 / count;
+    double dt = t - column.MeanTime;
+    double dx = x - column.MeanValue;
+    column.MeanTime -= dt * inverse;
+    column.MeanValue -= dx * inverse;
+    column.M2Time -= dt * (t - column.MeanTime);
+    column.M2Value -= dx * (x - column.MeanValue);
+    column.CoMoment -= dt * (x - column.MeanValue);
+}
+
+void ChannelStats::Add(float time, const float* values)
+{
+    // evict first: the row about to be written may still be the oldest in some window
+    uint64_t row = head_;
+    for (int c = 0; c < column_count_; c++)
+    {
+        Column& column = columns_[c];
+        while (column.Tail < row && (row - column.Tail >= capacity_ || time - times_[column.Tail & mask_] > column.WindowSeconds))
+            Remove(c, column.Tail);
+    }
+
+    times_[row & mask_] = time;
+    float* slot = &values_[(row & mask_) * column_count_];
+    for (int c = 0; c < column_count_; c++)
+        slot[c] = values[c];
+    head_ = row + 1;
+
+    for (int c = 0; c < column_count_; c++)
+    {
+        Column& column = columns_[c];
+        float x = values[c];
+
+        while (column.MinDeque.Back != column.MinDeque.Front && Value(Slot(min_slots_, c, column.MinDeque.Back - 1), c) >= x)
+            column.MinDeque.Back--;
+        Slot(min_slots_, c, column.MinDeque.Back++) = row;
+        while (column.MaxDeque.Back != column.MaxDeque.Front && Value(Slot(max_slots_, c, column.MaxDeque.Back - 1), c) <= x)
+            column.MaxDeque.Back--;
+        Slot(max_slots_, c, column.MaxDeque.Back++) = row;
+
+        double inverse = 1.0 / (double)(row + 1 - column.Tail);
+        double dt = time - column.MeanTime;
+        double dx = x - column.MeanValue;
+        column.MeanTime += dt * inverse;
+        column.MeanValue += dx * inverse;
+        column.M2Time += dt * (time - column.MeanTime);
+        column.M2Value += dx * (x - column.MeanValue);
+        column.CoMoment += dt * (x - column.MeanValue);
+    }
+}
+
+ChannelSummary ChannelStats::Summary(int c) const
+{
+    const Column& column = columns_[c];
+    ChannelSummary summary = {};
+    uint64_t count = head_ - column.Tail;
+    if (count == 0)
+        return summary;
+
+    summary.Latest = Value(head_ - 1, c);
+    summary.Min = Value(Slot(min_slots_, c, column.MinDeque.Front), c);
+    summary.Max = Value(Slot(max_slots_, c, column.MaxDeque.Front), c);
+    summary.Mean = (float)column.MeanValue;
+    summary.StdDev = count > 1 ? (float)sqrt(std::max(column.M2Value, 0.0) / (count - 1)) : 0.0f;
+    summary.Rate = column.M2Time > 0.0 ? (float)(column.CoMoment / column.M2Time) : 0.0f;
+    summary.Samples = (uint32_t)count;
+    return summary;
+}
+
+float ChannelStats::SampleRate() const
+{
+    if (column_count_ == 0 || head_ - columns_[0].Tail < 2)
+        return 0.0f;
+    float span = times_[(head_ - 1) & mask_] - times_[columns_[0].Tail & mask_];
+    return span > 0.0f ? (head_ - 1 - columns_[0].Tail) / span : 0.0f;
+}
+
+void AxisAutoscale::Update(float min, float max, float dt_seconds)
+{
+    float pad = std::max(max - min, 1e-3f) * PADDING;
+    float low = min - pad;
+    float high = max + pad;
+    if (!valid_)
+    {
+        min_ = low;
+        max_ = high;
+        valid_ = true;
+        return;
+    }
+
+    float shrink = 1.0f - expf(-dt_seconds / SHRINK_SECONDS);
+    min_ = low < min_ ? low : min_ + (low - min_) * shrink;
+    max_ = high > max_ ? high : max_ + (high - max_) * shrink;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+struct ChannelStatsConfig
+{
+    float WindowSeconds = 20.0f;        // every column's window until SetWindow() changes it
+    size_t MaxWindowSamples = 16384;    // power of two; no window holds more samples than this
+};
+
+// One column over its window.
+struct ChannelSummary
+{
+    float Latest;
+    float Min;
+    float Max;
+    float Mean;
+    float StdDev;
+    float Rate;         // least-squares slope over the window, per second
+    uint32_t Samples;
+};
+
+// Sliding-window statistics of every store column, O(1) amortized per sample and column.
+//
+// Min and max come from monotonic deques of sample indices: a sample leaves the deque as soon as
+// a newer one beats it, so each is pushed and popped at most once. Mean, variance and the slope
+// against time are sliding Welford updates: the new sample is added and every sample leaving the
+// window removed, without a pass over the window. Windows are in the rows' time (host seconds),
+// per column, capped at MaxWindowSamples samples.
+//
+// Fixed storage, allocated once; not thread-safe.
+class ChannelStats
+{
+public:
+    explicit ChannelStats(int column_count, const ChannelStatsConfig& config = ChannelStatsConfig());
+
+    void SetConfig(const ChannelStatsConfig& config);
+    void Reset();
+
+    // A shorter window applies from the next Add(); a longer one fills up with new samples only.
+    void SetWindow(int column, float seconds) { columns_[column].WindowSeconds = seconds; }
+    float Window(int column) const { return columns_[column].WindowSeconds; }
+
+    // values holds one entry per column; time must not decrease between calls.
+    void Add(float time, const float* values);
+
+    ChannelSummary Summary(int column) const;
+    // Rows per second over column 0's window.
+    float SampleRate() const;
+
+private:
+    struct Deque
+    {
+        uint64_t Front;     // positions in Slots, free running
+        uint64_t Back;
+    };
+
+    struct Column
+    {
+        float WindowSeconds;
+        uint64_t Tail;      // oldest row in the window
+        Deque MinDeque;     // rows of increasing value, the window's minimum in front
+        Deque MaxDeque;     // rows of decreasing value
+        // Welford state over the window: means, squared deviations and the time/value co-moment
+        double MeanTime;
+        double MeanValue;
+        double M2Time;
+        double M2Value;
+        double CoMoment;
+    };
+
+    float Value(uint64_t row, int column) const { return values_[(row & mask_) * column_count_ + column]; }
+    uint64_t& Slot(std::vector<uint64_t>& slots, int column, uint64_t position) { return slots[column * capacity_ + (position & mask_)]; }
+    uint64_t Slot(const std::vector<uint64_t>& slots, int column, uint64_t position) const { return slots[column * capacity_ + (position & mask_)]; }
+    void Remove(int column, uint64_t row);
+
+    int column_count_;
+    ChannelStatsConfig config_;
+    size_t capacity_;
+    uint64_t mask_;
+
+    // the last capacity_ rows
+    std::vector<float> times_;
+    std::vector<float> values_;
+    uint64_t head_;                     // rows added
+
+    std::vector<Column> columns_;
+    std::vector<uint64_t> min_slots_;   // capacity_ per column
+    std::vector<uint64_t> max_slots_;
+};
+
+// Y axis range that follows a window's min/max without jitter: it grows at once to fit a new
+// extreme and shrinks back smoothly, so a spike leaving the window does not snap the plot.
+class AxisAutoscale
+{
+public:
+    static constexpr float SHRINK_SECONDS = 0.5f;   // time constant of shrinking
+    static constexpr float PADDING = 0.05f;         // of the span, above and below
+
+    AxisAutoscale() { Reset(); }
+
+    void Reset() { valid_ = false; }
+    // Fits [min, max] of the plotted columns; dt_seconds since the last Update().
+    void Update(float min, float max, float dt_seconds);
+
+    bool Valid() const { return valid_; }
+    float Min() const { return min_; }
+    float Max() const { return max_; }
+
+private:
+    bool valid_;
+    float min_;
+    float max_;
+};
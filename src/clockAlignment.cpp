@@ -0,0 +1,86 @@
+#include "clockAlignment.h"
+
+// rocket time has to fall back by more than this before it counts as a reboot rather than jitter
+static const double RESTART_THRESHOLD_S = 0.5;
+static const double BLOCK_LENGTH_S = 1.0;
+
+void ClockAlignment::Reset()
+{
+    block_count_ = 0;
+    next_block_ = 0;
+    in_block_ = false;
+    block_start_ = 0;
+    current_ = { 0, 0 };
+    last_rocket_ = 0;
+    reference_ = 0;
+    intercept_ = 0;
+    slope_ = 0;
+    restarts_ = 0;
+}
+
+void ClockAlignment::Update(double rocket_seconds, double host_seconds)
+{
+    if (Valid() && rocket_seconds < last_rocket_ - RESTART_THRESHOLD_S)
+    {
+        uint64_t restarts = restarts_ + 1;
+        Reset();
+        restarts_ = restarts;
+    }
+    last_rocket_ = rocket_seconds;
+
+    double offset = host_seconds - rocket_seconds;
+    if (in_block_ && rocket_seconds - block_start_ < BLOCK_LENGTH_S)
+    {
+        if (offset < current_.MinOffset)
+            current_ = { rocket_seconds, offset };
+        return;
+    }
+
+    if (in_block_)
+        CloseBlock();
+    in_block_ = true;
+    block_start_ = rocket_seconds;
+    current_ = { rocket_seconds, offset };
+}
+
+void ClockAlignment::CloseBlock()
+{
+    blocks_[next_block_] = current_;
+    next_block_ = (next_block_ + 1) % BLOCKS;
+    if (block_count_ < BLOCKS)
+        block_count_++;
+    Fit();
+}
+
+void ClockAlignment::Fit()
+{
+    double mean_time = 0;
+    double mean_offset = 0;
+    for (int i = 0; i < block_count_; i++)
+    {
+        mean_time += blocks_[i].RocketTime;
+        mean_offset += blocks_[i].MinOffset;
+    }
+    mean_time /= block_count_;
+    mean_offset /= block_count_;
+
+    double covariance = 0;
+    double variance = 0;
+    for (int i = 0; i < block_count_; i++)
+    {
+        double dt = blocks_[i].RocketTime - mean_time;
+        covariance += dt * (blocks_[i].MinOffset - mean_offset);
+        variance += dt * dt;
+    }
+
+    reference_ = mean_time;
+    intercept_ = mean_offset;
+    slope_ = variance > 0 ? covariance / variance : 0;
+}
+
+double ClockAlignment::HostTime(double rocket_seconds) const
+{
+    if (block_count_ == 0)
+        return rocket_seconds + current_.MinOffset;
+    return rocket_seconds + intercept_ + slope_ * (rocket_seconds - reference_);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+// Maps the flight computer's own clock (the `time` channel) onto host time.
+// Every sample gives host arrival - rocket time = clock offset + link delay. The smallest value
+// seen in each one-second block of rocket time is the best estimate of the offset at that point,
+// and a least-squares line through the recent block minima gives both the offset and the drift
+// between the two oscillators. A rocket clock that jumps backwards (reboot) restarts the fit.
+class ClockAlignment
+{
+public:
+    static const int BLOCKS = 32;
+
+    ClockAlignment() { Reset(); }
+
+    void Reset();
+    void Update(double rocket_seconds, double host_seconds);
+
+    bool Valid() const { return block_count_ > 0 || in_block_; }
+    double HostTime(double rocket_seconds) const;
+    double Offset() const { return HostTime(last_rocket_) - last_rocket_; }    // host - rocket, seconds
+    double DriftPpm() const { return slope_ * 1e6; }
+    uint64_t Restarts() const { return restarts_; }
+
+private:
+    struct Block
+    {
+        double RocketTime;
+        double MinOffset;
+    };
+
+    void CloseBlock();
+    void Fit();
+
+    Block blocks_[BLOCKS];
+    int block_count_;
+    int next_block_;
+
+    bool in_block_;
+    double block_start_;
+    Block current_;
+
+    double last_rocket_;
+    double reference_;      // rocket time the fit is centred on
+    double intercept_;
+    double slope_;
+    uint64_t restarts_;
+};
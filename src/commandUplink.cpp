@@ -0,0 +1,203 @@
+#include "commandUplink.h"
+#include <algorithm>
+#include <stdio.h>
+
+const UplinkCommandDef UPLINK_COMMANDS[UplinkCommand_COUNT] =
+{
+    { "Release Payload", 'r', CommandPriority_Critical },
+    { "Cancel Release",  'u', CommandPriority_Critical },
+    { "Ping",            'p', CommandPriority_Low },
+};
+
+const char* const COMMAND_STATE_NAMES[CommandState_COUNT] = { "queued", "sent", "acked", "written", "failed" };
+
+static bool Finished(CommandState state)
+{
+    return state == CommandState_Acked || state == CommandState_Written || state == CommandState_Failed;
+}
+
+CommandUplink::CommandUplink()
+{
+    Reset();
+}
+
+void CommandUplink::SetConfig(const CommandUplinkConfig& config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+}
+
+void CommandUplink::Reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    used_ = 0;
+    next_sequence_ = 1;
+    wire_latency_.Reset();
+    ack_latency_.Reset();
+}
+
+int CommandUplink::Submit(UplinkCommand command)
+{
+    uint64_t now = MonotonicNanoseconds();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // a free slot, else the oldest finished command
+    int slot = -1;
+    if (used_ < MAX_COMMANDS)
+        slot = used_++;
+    else
+    {
+        for (int i = 0; i < used_; i++)
+        {
+            if (Finished(slots_[i].State) && (slot < 0 || slots_[i].RequestedNs < slots_[slot].RequestedNs))
+                slot = i;
+        }
+        if (slot < 0)
+            return -1;
+    }
+
+    CommandStatus& status = slots_[slot];
+    status = CommandStatus();
+    status.Sequence = next_sequence_++;
+    status.Command = command;
+    status.State = CommandState_Queued;
+    status.RequestedNs = now;
+    return status.Sequence;
+}
+
+// Most urgent queued command, else the most urgent retry that is due. Fails commands out of attempts.
+int CommandUplink::NextDue(uint64_t now_ns)
+{
+    uint64_t timeout_ns = config_.AckTimeoutMs * 1000000ull;
+    int queued = -1;
+    int retry = -1;
+    for (int i = 0; i < used_; i++)
+    {
+        CommandStatus& status = slots_[i];
+        int* best;
+        if (status.State == CommandState_Queued)
+            best = &queued;
+        else if (status.State == CommandState_Sent && now_ns - status.LastWriteNs >= timeout_ns)
+        {
+            if (status.Attempts >= config_.MaxAttempts)
+            {
+                status.State = CommandState_Failed;
+                continue;
+            }
+            best = &retry;
+        }
+        else
+            continue;
+
+        if (*best < 0)
+        {
+            *best = i;
+            continue;
+        }
+        const CommandStatus& current = slots_[*best];
+        CommandPriority priority = UPLINK_COMMANDS[status.Command].Priority;
+        CommandPriority current_priority = UPLINK_COMMANDS[current.Command].Priority;
+        if (priority < current_priority || (priority == current_priority && status.RequestedNs < current.RequestedNs))
+            *best = i;
+    }
+    return queued >= 0 ? queued : retry;
+}
+
+uint32_t CommandUplink::Service(TelemetrySource& source)
+{
+    for (;;)
+    {
+        char frame[32];
+        uint16_t sequence;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            int due = NextDue(MonotonicNanoseconds());
+            if (due < 0)
+                break;
+
+            CommandStatus& status = slots_[due];
+            char code = UPLINK_COMMANDS[status.Command].Code;
+            if (config_.Sequenced)
+                snprintf(frame, sizeof(frame), "{Cmd:%u:%c}", (unsigned)status.Sequence, code);
+            else
+                snprintf(frame, sizeof(frame), "%c", code);
+            status.State = config_.Sequenced ? CommandState_Sent : CommandState_Written;
+            status.Attempts++;
+            sequence = status.Sequence;
+        }
+
+        // the lock is not held across the write, so a slow port never blocks Submit()
+        bool written = source.Write(frame);
+        uint64_t written_ns = MonotonicNanoseconds();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < used_; i++)
+        {
+            CommandStatus& status = slots_[i];
+            if (status.Sequence != sequence || status.State == CommandState_Queued)
+                continue;
+            status.LastWriteNs = written_ns;
+            if (written && status.WrittenNs == 0)
+            {
+                status.WrittenNs = written_ns;
+                wire_latency_.Record(written_ns - status.RequestedNs);
+            }
+            if (!written && status.State == CommandState_Written)
+                status.State = CommandState_Failed;
+            break;
+        }
+    }
+
+    // time left until the earliest retry
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t now = MonotonicNanoseconds();
+    uint64_t timeout_ns = config_.AckTimeoutMs * 1000000ull;
+    uint64_t wait_ns = UINT64_MAX;
+    for (int i = 0; i < used_; i++)
+    {
+        const CommandStatus& status = slots_[i];
+        if (status.State != CommandState_Sent)
+            continue;
+        uint64_t due_ns = status.LastWriteNs + timeout_ns;
+        wait_ns = std::min(wait_ns, due_ns > now ? due_ns - now : 0);
+    }
+    return wait_ns == UINT64_MAX ? UINT32_MAX : (uint32_t)((wait_ns + 999999) / 1000000);
+}
+
+void CommandUplink::Acknowledge(uint16_t sequence, uint64_t arrival_ns)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < used_; i++)
+    {
+        CommandStatus& status = slots_[i];
+        if (status.Sequence != sequence || status.State != CommandState_Sent)
+            continue;
+        status.State = CommandState_Acked;
+        status.AckedNs = arrival_ns;
+        if (status.WrittenNs != 0 && arrival_ns > status.WrittenNs)
+            ack_latency_.Record(arrival_ns - status.WrittenNs);
+        break;
+    }
+}
+
+size_t CommandUplink::Recent(CommandStatus* out, size_t max_count) const
+{
+    CommandStatus copy[MAX_COMMANDS];
+    int count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count = used_;
+        std::copy(slots_, slots_ + used_, copy);
+    }
+    std::sort(copy, copy + count, [](const CommandStatus& a, const CommandStatus& b) { return a.RequestedNs > b.RequestedNs; });
+    size_t returned = std::min(max_count, (size_t)count);
+    std::copy(copy, copy + returned, out);
+    return returned;
+}
+
+void CommandUplink::Latencies(LatencyHistogram& wire, LatencyHistogram& ack) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    wire = wire_latency_;
+    ack = ack_latency_;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include "latencyHistogram.h"
+#include "telemetrySource.h"
+
+// Lower is more urgent: queued commands go out in priority order, then oldest first.
+enum CommandPriority
+{
+    CommandPriority_Critical,   // recovery and payload commands; never wait behind anything else
+    CommandPriority_Normal,
+    CommandPriority_Low,
+    CommandPriority_COUNT
+};
+
+enum UplinkCommand
+{
+    UplinkCommand_ReleasePayload,
+    UplinkCommand_CancelRelease,
+    UplinkCommand_Ping,
+    UplinkCommand_COUNT
+};
+
+struct UplinkCommandDef
+{
+    const char* Name;
+    char Code;                  // command byte the flight computer acts on
+    CommandPriority Priority;
+};
+
+extern const UplinkCommandDef UPLINK_COMMANDS[UplinkCommand_COUNT];
+
+enum CommandState
+{
+    CommandState_Queued,        // waiting for the link thread
+    CommandState_Sent,          // written, waiting for its ack
+    CommandState_Acked,
+    CommandState_Written,       // written with unsequenced framing, which is never acknowledged
+    CommandState_Failed,        // no ack after every attempt
+    CommandState_COUNT
+};
+
+extern const char* const COMMAND_STATE_NAMES[CommandState_COUNT];
+
+struct CommandStatus
+{
+    uint16_t Sequence;
+    UplinkCommand Command;
+    CommandState State;
+    uint8_t Attempts;
+    uint64_t RequestedNs;       // Submit() (the button press)
+    uint64_t WrittenNs;         // first write handed to the port
+    uint64_t LastWriteNs;
+    uint64_t AckedNs;           // arrival of the read that carried the ack
+};
+
+struct CommandUplinkConfig
+{
+    bool Sequenced = true;          // "{Cmd:<seq>:<code>}" acked by "{Ack:<seq>}"; false sends the bare code
+    uint32_t AckTimeoutMs = 250;    // resend when no ack arrived within this
+    int MaxAttempts = 4;
+};
+
+// Uplink command queue between the UI and the link thread.
+//
+// Any thread submits; the link thread (which owns the port) calls Service() before every read and
+// writes whatever is due, most urgent first. With sequenced framing every command carries its own
+// sequence number and is resent with the same number until the flight computer acknowledges it or
+// the attempts run out, so the flight computer can act on a repeated command only once.
+//
+// Commands are rare, so a mutex over a fixed slot array is enough; it is never held across a write.
+class CommandUplink
+{
+public:
+    static const int MAX_COMMANDS = 32;     // queued, in flight and recently finished
+
+    CommandUplink();
+
+    // While the link thread is stopped.
+    void SetConfig(const CommandUplinkConfig& config);
+    void Reset();
+
+    // Any thread. Returns the command's sequence number, or -1 if every slot is queued or in flight.
+    int Submit(UplinkCommand command);
+
+    // Link thread: writes every due command (new ones, then retries) and fails those out of attempts.
+    // Returns how long until the next retry is due, in ms, to bound the next read's wait.
+    uint32_t Service(TelemetrySource& source);
+
+    // Link thread: an "{Ack:<seq>}" frame arrived in the read stamped arrival_ns.
+    void Acknowledge(uint16_t sequence, uint64_t arrival_ns);
+
+    // Any thread: up to max_count of the most recent commands, newest first.
+    size_t Recent(CommandStatus* out, size_t max_count) const;
+    // Any thread: copies of the submit-to-write and write-to-ack latency histograms.
+    void Latencies(LatencyHistogram& wire, LatencyHistogram& ack) const;
+
+private:
+    int NextDue(uint64_t now_ns);
+
+    mutable std::mutex mutex_;
+    CommandUplinkConfig config_;
+    CommandStatus slots_[MAX_COMMANDS];
+    int used_;
+    uint16_t next_sequence_;
+    LatencyHistogram wire_latency_;
+    LatencyHistogram ack_latency_;
+};
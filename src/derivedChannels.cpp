@@ -0,0 +1,92 @@
+#include "derivedChannels.h"
+#include <math.h>
+#include <string.h>
+
+// An integral does not bridge a link outage longer than this; the missing span is left out
+// rather than filled with a straight line.
+static const double MAX_INTEGRATION_STEP = 1.0;
+
+void DerivedChannels::Reset()
+{
+    memset(states_, 0, sizeof(states_));
+    memset(last_inputs_, 0, sizeof(last_inputs_));
+    last_time_ = 0.0;
+    started_ = false;
+}
+
+void DerivedChannels::Evaluate(const TelemetrySample& sample, double time, float* row)
+{
+    for (int c = 0; c < Channel_COUNT; c++)
+        row[c] = sample.*CHANNELS[c].member;
+    for (int e = 0; e < Estimate_COUNT; e++)
+        row[Channel_COUNT + e] = sample.*ESTIMATES[e].member;
+
+    // a rocket time that steps back means the flight computer restarted
+    if (started_ && time < last_time_)
+        Reset();
+    double dt = started_ ? time - last_time_ : 0.0;
+
+    for (int d = 0; d < Derived_COUNT; d++)
+    {
+        const DerivedChannelDef& def = DERIVED_CHANNEL_DEFS[d];
+        State& state = states_[d];
+        float input = (row[def.inputs[0]] + def.offset) * def.gain;
+        float value = 0.0f;
+
+        switch (def.op)
+        {
+        case DerivedOp::Magnitude:
+        {
+            double sum = (double)input * input;
+            for (int i = 1; i < 3; i++)
+            {
+                if (def.inputs[i] >= 0)
+                {
+                    double other = (row[def.inputs[i]] + def.offset) * def.gain;
+                    sum += other * other;
+                }
+            }
+            value = (float)sqrt(sum);
+            break;
+        }
+        case DerivedOp::Integrate:
+            if (dt > 0.0 && dt <= MAX_INTEGRATION_STEP)
+                state.Integral += 0.5 * (last_inputs_[d] + input) * dt;
+            value = (float)state.Integral;
+            break;
+        case DerivedOp::Differentiate:
+        case DerivedOp::MovingAverage:
+        {
+            // History keeps window + 1 entries: the slope spans `window` intervals and the mean
+            // the newest `window` values
+            int capacity = def.window + 1;
+            if (state.Count == capacity)
+                state.Sum -= state.History[(state.Head + 1) % capacity];
+            else if (state.Count == def.window)
+                state.Sum -= state.History[0];
+            state.History[state.Head] = input;
+            state.Times[state.Head] = time;
+            state.Sum += input;
+            state.Head = (state.Head + 1) % capacity;
+            if (state.Count < capacity)
+                state.Count++;
+
+            if (def.op == DerivedOp::MovingAverage)
+                value = (float)(state.Sum / (state.Count < def.window ? state.Count : def.window));
+            else
+            {
+                int first = state.Count == capacity ? state.Head : 0;
+                double span = time - state.Times[first];
+                value = span > 0.0 ? (float)((input - state.History[first]) / span) : 0.0f;
+            }
+            break;
+        }
+        }
+
+        last_inputs_[d] = input;
+        row[FIRST_DERIVED_COLUMN + d] = value;
+    }
+
+    last_time_ = time;
+    started_ = true;
+}
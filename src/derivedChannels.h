@@ -0,0 +1,144 @@
+#pragma once
+
+#include "telemetrySample.h"
+
+// Derived channel schema.
+// Channels computed on the ground from the ones the flight computer sends, evaluated in table
+// order as each sample arrives, so an entry may use any raw or estimated channel or any derived
+// channel above it. They are stored, plotted, logged and archived exactly like raw channels.
+//
+// X(id, label, op, input0, input1, input2, window, gain, offset, unit, plotGroups)
+//   op              DerivedOp applied to the inputs
+//   input0..2       store columns read: CHANNEL(id) for raw channels, ESTIMATE(id) for estimated,
+//                   DERIVED(id) for derived, -1 unused
+//   window          samples spanned by Differentiate and MovingAverage (at most DERIVED_MAX_WINDOW)
+//   gain, offset    each input is used as (input + offset) * gain
+//
+// The axial (z) accelerometer channel reads +1 g at rest, which is taken out before integrating.
+#define CHANNEL(id) Channel_##id
+#define ESTIMATE(id) (Channel_COUNT + Estimate_##id)
+#define DERIVED(id) (FIRST_DERIVED_COLUMN + Derived_##id)
+
+#define DERIVED_CHANNELS(X) \
+    X(accelMag,    "Acceleration",    Magnitude,     CHANNEL(xAccel), CHANNEL(yAccel), CHANNEL(zAccel), 0,  1.0f,       0.0f,     "mg",     PlotGroup_Overview | PlotGroup_Acceleration) \
+    X(xVel,        "X Velocity",      Integrate,     CHANNEL(xAccel), -1, -1,                            0,  ACCEL_MPS2, 0.0f,     "m/s",    PlotGroup_Velocity) \
+    X(yVel,        "Y Velocity",      Integrate,     CHANNEL(yAccel), -1, -1,                            0,  ACCEL_MPS2, 0.0f,     "m/s",    PlotGroup_Velocity) \
+    X(zVel,        "Z Velocity",      Integrate,     CHANNEL(zAccel), -1, -1,                            0,  ACCEL_MPS2, -1000.0f, "m/s",    PlotGroup_Velocity) \
+    X(velMag,      "Velocity",        Magnitude,     DERIVED(xVel), DERIVED(yVel), DERIVED(zVel),        0,  1.0f,       0.0f,     "m/s",    PlotGroup_Velocity) \
+    X(climbRate,   "Climb Rate",      Differentiate, CHANNEL(altitude), -1, -1,                          20, 1.0f,       0.0f,     "m/s",    PlotGroup_Velocity) \
+    X(jerk,        "Jerk",            Differentiate, DERIVED(accelMag), -1, -1,                          4,  ACCEL_MPS2, 0.0f,     "m/s^3",  PlotGroup_None) \
+    X(altitudeAvg, "Altitude (avg)",  MovingAverage, CHANNEL(altitude), -1, -1,                          20, 1.0f,       0.0f,     "m",      PlotGroup_Altitude)
+
+enum class DerivedOp : uint8_t
+{
+    Magnitude,      // Euclidean norm of the used inputs
+    Integrate,      // trapezoidal running integral over time
+    Differentiate,  // slope over the last `window` samples
+    MovingAverage,  // mean of the last `window` samples
+};
+
+enum DerivedId
+{
+#define DERIVED_CHANNEL_ID(id, ...) Derived_##id,
+    DERIVED_CHANNELS(DERIVED_CHANNEL_ID)
+#undef DERIVED_CHANNEL_ID
+    Derived_COUNT
+};
+
+// Store, plot, CSV and archive columns: every raw channel, every estimated channel, then every
+// derived channel.
+static const int FIRST_DERIVED_COLUMN = Channel_COUNT + Estimate_COUNT;
+static const int STORE_COLUMN_COUNT = FIRST_DERIVED_COLUMN + Derived_COUNT;
+static const int DERIVED_MAX_WINDOW = 64;
+
+struct DerivedChannelDef
+{
+    const char* id;
+    const char* label;
+    DerivedOp op;
+    int inputs[3];
+    int window;
+    float gain;
+    float offset;
+    const char* unit;
+    PlotGroup plotGroups;
+};
+
+constexpr DerivedChannelDef DERIVED_CHANNEL_DEFS[Derived_COUNT] =
+{
+#define DERIVED_CHANNEL_DEF(id, label, op, input0, input1, input2, window, gain, offset, unit, plotGroups) \
+    { #id, label, DerivedOp::op, { input0, input1, input2 }, window, gain, offset, unit, plotGroups },
+    DERIVED_CHANNELS(DERIVED_CHANNEL_DEF)
+#undef DERIVED_CHANNEL_DEF
+};
+
+struct ColumnDef
+{
+    const char* id;
+    const char* label;
+    const char* unit;
+    PlotGroup plotGroups;
+};
+
+constexpr ColumnDef COLUMNS[STORE_COLUMN_COUNT] =
+{
+#define RAW_COLUMN_DEF(id, label, wireIndex, type, scale, unit, plotGroups) { #id, label, unit, plotGroups },
+    TELEMETRY_CHANNELS(RAW_COLUMN_DEF)
+#undef RAW_COLUMN_DEF
+#define ESTIMATED_COLUMN_DEF(id, label, unit, plotGroups) { #id, label, unit, plotGroups },
+    ESTIMATED_CHANNELS(ESTIMATED_COLUMN_DEF)
+#undef ESTIMATED_COLUMN_DEF
+#define DERIVED_COLUMN_DEF(id, label, op, input0, input1, input2, window, gain, offset, unit, plotGroups) { #id, label, unit, plotGroups },
+    DERIVED_CHANNELS(DERIVED_COLUMN_DEF)
+#undef DERIVED_COLUMN_DEF
+};
+
+constexpr bool DerivedChannelsValid()
+{
+    for (int d = 0; d < Derived_COUNT; d++)
+    {
+        const DerivedChannelDef& def = DERIVED_CHANNEL_DEFS[d];
+        for (int input : def.inputs)
+        {
+            if (input < -1 || input >= FIRST_DERIVED_COLUMN + d)
+                return false;
+        }
+        if (def.inputs[0] < 0 || def.window < 0 || def.window > DERIVED_MAX_WINDOW)
+            return false;
+        if ((def.op == DerivedOp::Differentiate || def.op == DerivedOp::MovingAverage) && def.window < 1)
+            return false;
+    }
+    return true;
+}
+static_assert(DerivedChannelsValid(), "DERIVED_CHANNELS inputs must be raw or estimated channels or derived channels listed above, with a window in 1..DERIVED_MAX_WINDOW where used");
+
+// Evaluates DERIVED_CHANNELS one sample at a time. Every operation is O(1) per sample: running
+// sums and fixed rings, never a pass over history.
+class DerivedChannels
+{
+public:
+    DerivedChannels() { Reset(); }
+
+    // Forget all history, e.g. at the start of a new session.
+    void Reset();
+
+    // Fills row[0, STORE_COLUMN_COUNT): the sample's raw and estimated channels, then every derived channel.
+    // time is the sample's time in seconds; if it steps backwards the integrals and windows restart.
+    void Evaluate(const TelemetrySample& sample, double time, float* row);
+
+private:
+    struct State
+    {
+        double Integral;
+        double Sum;                                 // of the newest `window` History entries
+        int Count;                                  // History entries filled, up to window + 1
+        int Head;                                   // next History slot to write
+        float History[DERIVED_MAX_WINDOW + 1];
+        double Times[DERIVED_MAX_WINDOW + 1];
+    };
+
+    State states_[Derived_COUNT];
+    float last_inputs_[Derived_COUNT];
+    double last_time_;
+    bool started_;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+// Row-major matrix with its size fixed at compile time, for the small filters in the state
+// estimator. A plain value type: no heap, no dynamic sizes, and dimension mismatches fail to compile.
+template<int Rows, int Cols>
+struct Matrix
+{
+    float M[Rows][Cols];
+
+    float& operator()(int row, int col) { return M[row][col]; }
+    float operator()(int row, int col) const { return M[row][col]; }
+
+    static Matrix Zero()
+    {
+        Matrix result = {};
+        return result;
+    }
+
+    static Matrix Identity()
+    {
+        static_assert(Rows == Cols, "identity needs a square matrix");
+        Matrix result = {};
+        for (int i = 0; i < Rows; i++)
+            result.M[i][i] = 1.0f;
+        return result;
+    }
+
+    Matrix<Cols, Rows> Transposed() const
+    {
+        Matrix<Cols, Rows> result;
+        for (int r = 0; r < Rows; r++)
+            for (int c = 0; c < Cols; c++)
+                result.M[c][r] = M[r][c];
+        return result;
+    }
+};
+
+template<int Rows, int Inner, int Cols>
+Matrix<Rows, Cols> operator*(const Matrix<Rows, Inner>& a, const Matrix<Inner, Cols>& b)
+{
+    Matrix<Rows, Cols> result;
+    for (int r = 0; r < Rows; r++)
+    {
+        for (int c = 0; c < Cols; c++)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < Inner; k++)
+                sum += a.M[r][k] * b.M[k][c];
+            result.M[r][c] = sum;
+        }
+    }
+    return result;
+}
+
+template<int Rows, int Cols>
+Matrix<Rows, Cols> operator*(const Matrix<Rows, Cols>& a, float scale)
+{
+    Matrix<Rows, Cols> result;
+    for (int r = 0; r < Rows; r++)
+        for (int c = 0; c < Cols; c++)
+            result.M[r][c] = a.M[r][c] * scale;
+    return result;
+}
+
+template<int Rows, int Cols>
+Matrix<Rows, Cols> operator+(const Matrix<Rows, Cols>& a, const Matrix<Rows, Cols>& b)
+{
+    Matrix<Rows, Cols> result;
+    for (int r = 0; r < Rows; r++)
+        for (int c = 0; c < Cols; c++)
+            result.M[r][c] = a.M[r][c] + b.M[r][c];
+    return result;
+}
+
+template<int Rows, int Cols>
+Matrix<Rows, Cols> operator-(const Matrix<Rows, Cols>& a, const Matrix<Rows, Cols>& b)
+{
+    Matrix<Rows, Cols> result;
+    for (int r = 0; r < Rows; r++)
+        for (int c = 0; c < Cols; c++)
+            result.M[r][c] = a.M[r][c] - b.M[r][c];
+    return result;
+}
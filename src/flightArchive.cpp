@@ -0,0 +1,322 @@
+#include "flightArchive.h"
+#include <algorithm>
+#include <string.h>
+#include "flightJournal.h"
+#include "stateEstimator.h"
+#include "derivedChannels.h"
+
+static const char ARCHIVE_MAGIC[8] = { 'T', 'V', 'A', 'R', 'C', 'H', 0, 1 };
+static const uint32_t ARCHIVE_VERSION = 1;
+
+// Header fields, by byte offset:
+//   0  magic[8]            32  u64 block count
+//   8  u32 version         40  u64 data offset
+//   12 u32 column count    48  u64 index offset
+//   16 u32 block samples   56  u64 fine summary offset
+//   20 u32 fine samples    64  u64 block summary offset
+//   24 u64 sample count    72  u64 file size
+struct ArchiveLayout
+{
+    uint64_t DataOffset;
+    uint64_t IndexOffset;
+    uint64_t FineOffset;
+    uint64_t BlockSummaryOffset;
+    uint64_t FileSize;
+};
+
+static uint64_t BlockBytes(int column_count)
+{
+    return (uint64_t)(column_count + 1) * ARCHIVE_BLOCK_SAMPLES * sizeof(float);
+}
+
+static ArchiveLayout ComputeLayout(int column_count, uint64_t sample_count, uint64_t block_count)
+{
+    uint64_t fine_count = (sample_count + ARCHIVE_FINE_SAMPLES - 1) / ARCHIVE_FINE_SAMPLES;
+
+    ArchiveLayout layout;
+    layout.DataOffset = (ARCHIVE_HEADER_SIZE + column_count * ARCHIVE_ID_BYTES + 63) & ~(uint64_t)63;
+    layout.IndexOffset = layout.DataOffset + block_count * BlockBytes(column_count);
+    layout.FineOffset = layout.IndexOffset + block_count * sizeof(ArchiveBlockEntry);
+    layout.BlockSummaryOffset = layout.FineOffset + fine_count * (1 + 2 * column_count) * sizeof(float);
+    layout.FileSize = layout.BlockSummaryOffset + block_count * 2 * column_count * sizeof(float);
+    return layout;
+}
+
+static void PutU32(uint8_t* p, uint32_t v) { memcpy(p, &v, 4); }
+static void PutU64(uint8_t* p, uint64_t v) { memcpy(p, &v, 8); }
+static uint32_t GetU32(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+static uint64_t GetU64(const uint8_t* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+
+ArchiveWriter::ArchiveWriter()
+    : file_(nullptr), column_count_(0), sample_count_(0), block_fill_(0)
+{
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+    if (file_)
+        fclose(file_);
+}
+
+bool ArchiveWriter::Open(const std::string& path, const std::vector<std::string>& column_ids)
+{
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_)
+        return false;
+
+    column_count_ = (int)column_ids.size();
+    sample_count_ = 0;
+    block_fill_ = 0;
+    block_.assign((size_t)(column_count_ + 1) * ARCHIVE_BLOCK_SAMPLES, 0.0f);
+    index_.clear();
+    fine_.clear();
+    block_summary_.clear();
+
+    // header is rewritten by Close(); until then the zero magic marks the file as incomplete
+    ArchiveLayout layout = ComputeLayout(column_count_, 0, 0);
+    std::vector<uint8_t> prefix((size_t)layout.DataOffset, 0);
+    for (int column = 0; column < column_count_; column++)
+        strncpy((char*)&prefix[ARCHIVE_HEADER_SIZE + column * ARCHIVE_ID_BYTES], column_ids[column].c_str(), ARCHIVE_ID_BYTES - 1);
+    return fwrite(prefix.data(), 1, prefix.size(), file_) == prefix.size();
+}
+
+bool ArchiveWriter::Append(float time, const float* values)
+{
+    if (!file_)
+        return false;
+
+    size_t stride = 1 + 2 * column_count_;
+    if (sample_count_ % ARCHIVE_FINE_SAMPLES == 0)
+    {
+        fine_.push_back(time);
+        for (int column = 0; column < column_count_; column++)
+        {
+            fine_.push_back(values[column]);
+            fine_.push_back(values[column]);
+        }
+    }
+    if (block_fill_ == 0)
+    {
+        for (int column = 0; column < column_count_; column++)
+        {
+            block_summary_.push_back(values[column]);
+            block_summary_.push_back(values[column]);
+        }
+    }
+
+    float* fine = &fine_[fine_.size() - stride] + 1;
+    float* summary = &block_summary_[block_summary_.size() - 2 * column_count_];
+    block_[block_fill_] = time;
+    for (int column = 0; column < column_count_; column++)
+    {
+        float value = values[column];
+        block_[(size_t)(column + 1) * ARCHIVE_BLOCK_SAMPLES + block_fill_] = value;
+        if (value < fine[2 * column]) fine[2 * column] = value;
+        if (value > fine[2 * column + 1]) fine[2 * column + 1] = value;
+        if (value < summary[2 * column]) summary[2 * column] = value;
+        if (value > summary[2 * column + 1]) summary[2 * column + 1] = value;
+    }
+
+    sample_count_++;
+    if (++block_fill_ == ARCHIVE_BLOCK_SAMPLES)
+        return WriteBlock();
+    return true;
+}
+
+bool ArchiveWriter::WriteBlock()
+{
+    ArchiveBlockEntry entry = { block_[0], block_[block_fill_ - 1], block_fill_, 0 };
+    index_.push_back(entry);
+
+    // a partial last block is written at full size so every block stays at a computable offset
+    for (int column = 0; column <= column_count_; column++)
+    {
+        float* values = &block_[(size_t)column * ARCHIVE_BLOCK_SAMPLES];
+        std::fill(values + block_fill_, values + ARCHIVE_BLOCK_SAMPLES, 0.0f);
+    }
+    block_fill_ = 0;
+    return fwrite(block_.data(), sizeof(float), block_.size(), file_) == block_.size();
+}
+
+bool ArchiveWriter::Close()
+{
+    if (!file_)
+        return false;
+
+    bool ok = block_fill_ == 0 || WriteBlock();
+    ok = ok && fwrite(index_.data(), sizeof(ArchiveBlockEntry), index_.size(), file_) == index_.size();
+    ok = ok && fwrite(fine_.data(), sizeof(float), fine_.size(), file_) == fine_.size();
+    ok = ok && fwrite(block_summary_.data(), sizeof(float), block_summary_.size(), file_) == block_summary_.size();
+
+    ArchiveLayout layout = ComputeLayout(column_count_, sample_count_, index_.size());
+    uint8_t header[ARCHIVE_HEADER_SIZE] = {};
+    memcpy(header, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    PutU32(header + 8, ARCHIVE_VERSION);
+    PutU32(header + 12, (uint32_t)column_count_);
+    PutU32(header + 16, ARCHIVE_BLOCK_SAMPLES);
+    PutU32(header + 20, ARCHIVE_FINE_SAMPLES);
+    PutU64(header + 24, sample_count_);
+    PutU64(header + 32, index_.size());
+    PutU64(header + 40, layout.DataOffset);
+    PutU64(header + 48, layout.IndexOffset);
+    PutU64(header + 56, layout.FineOffset);
+    PutU64(header + 64, layout.BlockSummaryOffset);
+    PutU64(header + 72, layout.FileSize);
+    ok = ok && fseek(file_, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), file_) == sizeof(header);
+
+    ok = fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+FlightArchive::FlightArchive()
+    : column_count_(0), sample_count_(0), block_count_(0),
+      ids_(nullptr), data_(nullptr), index_(nullptr), fine_(nullptr), block_summary_(nullptr)
+{
+}
+
+bool FlightArchive::Open(const std::string& path)
+{
+    Close();
+    if (!file_.OpenRead(path))
+        return false;
+
+    const uint8_t* base = file_.Data();
+    if (file_.Size() < ARCHIVE_HEADER_SIZE || memcmp(base, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0
+        || GetU32(base + 8) != ARCHIVE_VERSION || GetU32(base + 16) != ARCHIVE_BLOCK_SAMPLES
+        || GetU32(base + 20) != ARCHIVE_FINE_SAMPLES || GetU32(base + 12) > 1024)
+    {
+        Close();
+        return false;
+    }
+
+    column_count_ = (int)GetU32(base + 12);
+    sample_count_ = GetU64(base + 24);
+    block_count_ = GetU64(base + 32);
+
+    // every offset is derived from the counts, so a damaged or truncated file is rejected here
+    ArchiveLayout layout = ComputeLayout(column_count_, sample_count_, block_count_);
+    if (GetU64(base + 40) != layout.DataOffset || GetU64(base + 48) != layout.IndexOffset
+        || GetU64(base + 56) != layout.FineOffset || GetU64(base + 64) != layout.BlockSummaryOffset
+        || GetU64(base + 72) != layout.FileSize || layout.FileSize > file_.Size()
+        || block_count_ != (sample_count_ + ARCHIVE_BLOCK_SAMPLES - 1) / ARCHIVE_BLOCK_SAMPLES)
+    {
+        Close();
+        return false;
+    }
+
+    ids_ = base + ARCHIVE_HEADER_SIZE;
+    data_ = (const float*)(base + layout.DataOffset);
+    index_ = (const ArchiveBlockEntry*)(base + layout.IndexOffset);
+    fine_ = (const float*)(base + layout.FineOffset);
+    block_summary_ = (const float*)(base + layout.BlockSummaryOffset);
+    return true;
+}
+
+void FlightArchive::Close()
+{
+    file_.Close();
+    column_count_ = 0;
+    sample_count_ = 0;
+    block_count_ = 0;
+    ids_ = nullptr;
+    data_ = nullptr;
+    index_ = nullptr;
+    fine_ = nullptr;
+    block_summary_ = nullptr;
+}
+
+std::string FlightArchive::ColumnId(int column) const
+{
+    const char* id = (const char*)ids_ + column * ARCHIVE_ID_BYTES;
+    return std::string(id, strnlen(id, ARCHIVE_ID_BYTES));
+}
+
+int FlightArchive::FindColumn(const char* id) const
+{
+    for (int column = 0; column < column_count_; column++)
+    {
+        if (strncmp((const char*)ids_ + column * ARCHIVE_ID_BYTES, id, ARCHIVE_ID_BYTES) == 0)
+            return column;
+    }
+    return -1;
+}
+
+uint64_t FlightArchive::LowerBound(float time) const
+{
+    // first block whose last sample reaches time
+    size_t low = 0;
+    size_t high = BlockCount();
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (index_[mid].LastTime < time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low == BlockCount())
+        return sample_count_;
+
+    const float* times = BlockColumn(low, -1);
+    uint32_t first = 0;
+    uint32_t last = index_[low].Count;
+    while (first < last)
+    {
+        uint32_t mid = first + (last - first) / 2;
+        if (times[mid] < time)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    return (uint64_t)low * ARCHIVE_BLOCK_SAMPLES + first;
+}
+
+long long ExportJournalArchive(const std::string& journal_path, const std::string& archive_path)
+{
+    JournalReader reader;
+    if (!reader.Open(journal_path))
+        return -1;
+
+    std::vector<std::string> ids;
+    for (const ColumnDef& column : COLUMNS)
+        ids.push_back(column.id);
+
+    ArchiveWriter writer;
+    if (!writer.Open(archive_path, ids))
+        return -1;
+
+    // host time restarts with every session in the journal; lay sessions end to end
+    float session_base = 0.0f;
+    float last_time = 0.0f;
+    bool ok = true;
+    JournalRecord record;
+    TelemetrySample sample = {};
+    StateEstimator estimator;
+    DerivedChannels derived;
+    float values[STORE_COLUMN_COUNT];
+    while (ok && reader.Next(record))
+    {
+        if (record.Type == JournalRecord_Session)
+        {
+            session_base = last_time;
+            estimator.Reset();
+            derived.Reset();
+        }
+        if (!DecodeSampleRecord(record, sample))
+            continue;
+
+        estimator.Update(sample);
+        derived.Evaluate(sample, RocketSeconds(sample), values);
+
+        float time = session_base + sample.hostTime;
+        if (time < last_time)
+            time = last_time;
+        last_time = time;
+        ok = writer.Append(time, values);
+    }
+
+    long long samples = (long long)writer.SampleCount();
+    ok = writer.Close() && ok;
+    return ok ? samples : -1;
+}
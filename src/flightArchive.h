@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "mappedFile.h"
+
+// Binary columnar flight archive (.tva), opened by memory mapping without parsing.
+//
+// Layout (little-endian):
+//   header         ARCHIVE_HEADER_SIZE bytes, see flightArchive.cpp
+//   column ids     ARCHIVE_ID_BYTES per column, NUL padded
+//   data blocks    ARCHIVE_BLOCK_SAMPLES samples each: the f32 time column, then one f32 column per
+//                  channel. Every block has the same size; the last one may be partly filled.
+//   block index    per block: f32 first time, f32 last time, u32 sample count, u32 reserved
+//   fine summary   per ARCHIVE_FINE_SAMPLES samples: f32 first time, then f32 min, max per column
+//   block summary  per block: f32 min, max per column
+//
+// Seeking is a binary search over the block index followed by one inside the block. Overviews
+// are drawn from the summaries, which sit together at the end of the file, so a whole multi-hour
+// session can be shown without paging in any sample data.
+
+static const uint32_t ARCHIVE_BLOCK_SAMPLES = 4096;
+static const uint32_t ARCHIVE_FINE_SAMPLES = 64;
+static const size_t ARCHIVE_HEADER_SIZE = 128;
+static const size_t ARCHIVE_ID_BYTES = 32;
+
+struct ArchiveBlockEntry
+{
+    float FirstTime;
+    float LastTime;
+    uint32_t Count;
+    uint32_t Reserved;
+};
+
+class ArchiveWriter
+{
+public:
+    ArchiveWriter();
+    ~ArchiveWriter();
+
+    bool Open(const std::string& path, const std::vector<std::string>& column_ids);
+    // values holds one entry per column; time must not decrease.
+    bool Append(float time, const float* values);
+    // Writes the index and summaries and completes the header. The archive is unreadable until then.
+    bool Close();
+
+    uint64_t SampleCount() const { return sample_count_; }
+
+private:
+    bool WriteBlock();
+
+    FILE* file_;
+    int column_count_;
+    uint64_t sample_count_;
+    uint32_t block_fill_;
+    std::vector<float> block_;          // (column_count_ + 1) * ARCHIVE_BLOCK_SAMPLES
+    std::vector<ArchiveBlockEntry> index_;
+    std::vector<float> fine_;           // 1 + 2 * column_count_ per fine summary
+    std::vector<float> block_summary_;  // 2 * column_count_ per block
+};
+
+class FlightArchive
+{
+public:
+    FlightArchive();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return file_.IsOpen(); }
+
+    int ColumnCount() const { return column_count_; }
+    std::string ColumnId(int column) const;
+    int FindColumn(const char* id) const;   // -1 if the archive has no such column
+
+    uint64_t SampleCount() const { return sample_count_; }
+    size_t BlockCount() const { return (size_t)block_count_; }
+    size_t FineCount() const { return (size_t)((sample_count_ + ARCHIVE_FINE_SAMPLES - 1) / ARCHIVE_FINE_SAMPLES); }
+    float StartTime() const { return sample_count_ ? BlockFirstTime(0) : 0.0f; }
+    float EndTime() const { return sample_count_ ? BlockLastTime(BlockCount() - 1) : 0.0f; }
+
+    // Index of the first sample with Time() >= time, or SampleCount() if there is none. O(log n).
+    uint64_t LowerBound(float time) const;
+
+    float Time(uint64_t index) const { return BlockColumn(index / ARCHIVE_BLOCK_SAMPLES, -1)[index % ARCHIVE_BLOCK_SAMPLES]; }
+    float Value(int column, uint64_t index) const { return BlockColumn(index / ARCHIVE_BLOCK_SAMPLES, column)[index % ARCHIVE_BLOCK_SAMPLES]; }
+
+    float BlockFirstTime(size_t block) const { return index_[block].FirstTime; }
+    float BlockLastTime(size_t block) const { return index_[block].LastTime; }
+    float BlockMin(int column, size_t block) const { return block_summary_[(block * column_count_ + column) * 2]; }
+    float BlockMax(int column, size_t block) const { return block_summary_[(block * column_count_ + column) * 2 + 1]; }
+
+    float FineTime(size_t fine) const { return fine_[fine * (1 + 2 * column_count_)]; }
+    float FineMin(int column, size_t fine) const { return fine_[fine * (1 + 2 * column_count_) + 1 + 2 * column]; }
+    float FineMax(int column, size_t fine) const { return fine_[fine * (1 + 2 * column_count_) + 2 + 2 * column]; }
+
+private:
+    // column -1 is the time column
+    const float* BlockColumn(uint64_t block, int column) const
+    {
+        return data_ + (size_t)block * (column_count_ + 1) * ARCHIVE_BLOCK_SAMPLES + (size_t)(column + 1) * ARCHIVE_BLOCK_SAMPLES;
+    }
+
+    MappedFile file_;
+    int column_count_;
+    uint64_t sample_count_;
+    uint64_t block_count_;
+    const uint8_t* ids_;
+    const float* data_;
+    const ArchiveBlockEntry* index_;
+    const float* fine_;
+    const float* block_summary_;
+};
+
+// Post-processing: converts every sample record in a flight journal into an archive with one
+// column per raw and derived channel (COLUMNS). Returns the number of samples, or -1 on failure.
+long long ExportJournalArchive(const std::string& journal_path, const std::string& archive_path);
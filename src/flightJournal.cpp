@@ -0,0 +1,263 @@
+#include "flightJournal.h"
+#include <string.h>
+#include <time.h>
+
+static const char JOURNAL_MAGIC[8] = { 'T', 'V', 'J', 'R', 'N', 'L', 0, 1 };
+static const uint32_t JOURNAL_VERSION = 1;
+// set in a sample record's format byte when its time channel is the u32 ms count rather than an f32
+static const uint8_t JOURNAL_SAMPLE_RAW_TIME = 0x80;
+
+struct Crc32Table
+{
+    uint32_t Entries[256];
+
+    constexpr Crc32Table() : Entries()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            Entries[i] = crc;
+        }
+    }
+};
+
+static constexpr Crc32Table CRC32_TABLE;
+
+uint32_t Crc32(const uint8_t* data, size_t length, uint32_t crc)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+        crc = (crc >> 8) ^ CRC32_TABLE.Entries[(crc ^ data[i]) & 0xFF];
+    return ~crc;
+}
+
+static size_t PaddedLength(size_t length)
+{
+    return (length + 7) & ~(size_t)7;
+}
+
+static void PutU32(uint8_t* p, uint32_t v) { memcpy(p, &v, 4); }
+static uint32_t GetU32(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+// Validates the record at offset; on success fills record and returns the offset after it, else 0.
+static size_t ReadRecord(const uint8_t* data, size_t size, size_t offset, uint32_t expected_sequence, JournalRecord& record)
+{
+    if (offset + JOURNAL_RECORD_HEADER_SIZE > size)
+        return 0;
+
+    const uint8_t* header = data + offset;
+    uint32_t length = GetU32(header);
+    uint16_t type;
+    memcpy(&type, header + 4, 2);
+    uint32_t sequence = GetU32(header + 8);
+
+    if (type == 0 || sequence != expected_sequence || length > size - offset - JOURNAL_RECORD_HEADER_SIZE)
+        return 0;
+
+    const uint8_t* payload = header + JOURNAL_RECORD_HEADER_SIZE;
+    uint32_t crc = Crc32(payload, length, Crc32(header, 12));
+    if (crc != GetU32(header + 12))
+        return 0;
+
+    record.Type = (JournalRecordType)type;
+    record.Sequence = sequence;
+    record.Payload = payload;
+    record.Length = length;
+    return offset + JOURNAL_RECORD_HEADER_SIZE + PaddedLength(length);
+}
+
+static bool ValidFileHeader(const uint8_t* data, size_t size)
+{
+    return size >= JOURNAL_HEADER_SIZE && memcmp(data, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0
+        && GetU32(data + 12) == JOURNAL_VERSION;
+}
+
+size_t EncodeSampleRecord(const TelemetrySample& sample, uint8_t* out)
+{
+    uint8_t* p = out;
+    memcpy(p, &sample.arrivalNs, 8); p += 8;
+    memcpy(p, &sample.parsedNs, 8); p += 8;
+    memcpy(p, &sample.hostTime, 4); p += 4;
+    memcpy(p, &sample.sequence, 2); p += 2;
+    *p++ = sample.format | JOURNAL_SAMPLE_RAW_TIME;
+    *p++ = (uint8_t)Channel_COUNT;
+    for (const ChannelDef& channel : CHANNELS)
+    {
+        if (channel.member == &TelemetrySample::time)
+            memcpy(p, &sample.rocketMs, 4);
+        else
+            memcpy(p, &(sample.*channel.member), 4);
+        p += 4;
+    }
+    return p - out;
+}
+
+bool DecodeSampleRecord(const JournalRecord& record, TelemetrySample& sample)
+{
+    if (record.Type != JournalRecord_Sample || record.Length != JOURNAL_SAMPLE_RECORD_SIZE
+        || record.Payload[23] != Channel_COUNT)
+        return false;
+
+    const uint8_t* p = record.Payload;
+    memcpy(&sample.arrivalNs, p, 8); p += 8;
+    memcpy(&sample.parsedNs, p, 8); p += 8;
+    memcpy(&sample.hostTime, p, 4); p += 4;
+    memcpy(&sample.sequence, p, 2); p += 2;
+    bool raw_time = (*p & JOURNAL_SAMPLE_RAW_TIME) != 0;
+    sample.format = *p++ & ~JOURNAL_SAMPLE_RAW_TIME;
+    p++;
+    for (const ChannelDef& channel : CHANNELS)
+    {
+        if (channel.member == &TelemetrySample::time && raw_time)
+            memcpy(&sample.rocketMs, p, 4);
+        else
+            memcpy(&(sample.*channel.member), p, 4);
+        p += 4;
+    }
+    // journals written before the flag only have the float
+    if (raw_time)
+        sample.time = (float)sample.rocketMs;
+    else
+        sample.rocketMs = (uint32_t)sample.time;
+    return true;
+}
+
+JournalWriter::JournalWriter()
+    : end_(0), flushed_(0), next_sequence_(0), recovered_records_(0)
+{
+}
+
+bool JournalWriter::Open(const std::string& path)
+{
+    Close();
+    if (!file_.OpenWrite(path, GROW_BYTES))
+        return false;
+
+    uint8_t* data = file_.Data();
+    static const uint8_t empty[sizeof(JOURNAL_MAGIC)] = {};
+    if (memcmp(data, empty, sizeof(empty)) == 0)
+    {
+        memset(data, 0, JOURNAL_HEADER_SIZE);
+        memcpy(data, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        PutU32(data + 8, (uint32_t)JOURNAL_HEADER_SIZE);
+        PutU32(data + 12, JOURNAL_VERSION);
+        PutU32(data + 16, (uint32_t)Channel_COUNT);
+        end_ = JOURNAL_HEADER_SIZE;
+        flushed_ = 0;
+    }
+    else if (!ValidFileHeader(data, file_.Size()))
+    {
+        file_.Close();
+        return false;
+    }
+    else
+    {
+        // recover: resume after the last record that is intact and in sequence
+        JournalRecord record;
+        size_t offset = JOURNAL_HEADER_SIZE;
+        size_t next;
+        while ((next = ReadRecord(data, file_.Size(), offset, next_sequence_, record)) != 0)
+        {
+            offset = next;
+            next_sequence_++;
+        }
+        end_ = offset;
+        flushed_ = offset;
+        recovered_records_ = next_sequence_;
+    }
+
+    uint8_t session[12];
+    uint64_t now = (uint64_t)time(nullptr);
+    memcpy(session, &now, 8);
+    PutU32(session + 8, (uint32_t)Channel_COUNT);
+    return Append(JournalRecord_Session, session, sizeof(session)) && Flush();
+}
+
+void JournalWriter::Close()
+{
+    if (file_.IsOpen())
+        Flush();
+    file_.Close();
+    end_ = 0;
+    flushed_ = 0;
+    next_sequence_ = 0;
+    recovered_records_ = 0;
+}
+
+bool JournalWriter::Append(JournalRecordType type, const void* payload, size_t length)
+{
+    if (!file_.IsOpen())
+        return false;
+
+    size_t needed = JOURNAL_RECORD_HEADER_SIZE + PaddedLength(length) + JOURNAL_RECORD_HEADER_SIZE;
+    if (end_ + needed > file_.Size())
+    {
+        size_t grow = needed > GROW_BYTES ? needed : GROW_BYTES;
+        if (!file_.Resize(file_.Size() + grow))
+            return false;
+    }
+
+    uint8_t* header = file_.Data() + end_;
+    PutU32(header, (uint32_t)length);
+    uint16_t record_type = type;
+    memcpy(header + 4, &record_type, 2);
+    memset(header + 6, 0, 2);
+    PutU32(header + 8, next_sequence_);
+    memcpy(header + JOURNAL_RECORD_HEADER_SIZE, payload, length);
+    PutU32(header + 12, Crc32(header + JOURNAL_RECORD_HEADER_SIZE, length, Crc32(header, 12)));
+
+    size_t record_size = JOURNAL_RECORD_HEADER_SIZE + PaddedLength(length);
+    memset(header + JOURNAL_RECORD_HEADER_SIZE + length, 0, record_size - JOURNAL_RECORD_HEADER_SIZE - length + JOURNAL_RECORD_HEADER_SIZE);
+
+    end_ += record_size;
+    next_sequence_++;
+    return true;
+}
+
+bool JournalWriter::Flush()
+{
+    if (!file_.IsOpen())
+        return false;
+    if (flushed_ == end_)
+        return true;
+
+    // include the zero terminator after the last record
+    if (!file_.Flush(flushed_, end_ + JOURNAL_RECORD_HEADER_SIZE - flushed_))
+        return false;
+    flushed_ = end_;
+    return true;
+}
+
+JournalReader::JournalReader()
+    : offset_(0), next_sequence_(0)
+{
+}
+
+bool JournalReader::Open(const std::string& path)
+{
+    offset_ = JOURNAL_HEADER_SIZE;
+    next_sequence_ = 0;
+    if (!file_.OpenRead(path))
+        return false;
+    if (!ValidFileHeader(file_.Data(), file_.Size()))
+    {
+        file_.Close();
+        return false;
+    }
+    return true;
+}
+
+bool JournalReader::Next(JournalRecord& record)
+{
+    if (!file_.IsOpen())
+        return false;
+
+    size_t next = ReadRecord(file_.Data(), file_.Size(), offset_, next_sequence_, record);
+    if (next == 0)
+        return false;
+    offset_ = next;
+    next_sequence_++;
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "mappedFile.h"
+#include "telemetrySample.h"
+
+// Append-only, memory-mapped flight journal.
+//
+// File layout: a JOURNAL_HEADER_SIZE byte header, then back-to-back records
+//   u32 length      payload bytes
+//   u16 type        JournalRecordType
+//   u16 reserved
+//   u32 sequence    0 for the first record in the file, +1 per record
+//   u32 crc         CRC-32 over the 12 bytes above and the payload
+//   ... payload, padded to 8 bytes
+// followed by an all-zero record header. The file is preallocated and grown in large steps.
+//
+// A record counts only if it fits in the file, its CRC matches and its sequence continues the one
+// before it, so after a crash or power loss everything up to the last durable record is read back
+// and a torn tail is ignored. Reopening a journal for writing resumes right after that record.
+
+enum JournalRecordType : uint16_t
+{
+    JournalRecord_Session = 1,  // u64 unix time, u32 channel count; written each time the journal is opened
+    JournalRecord_Raw = 2,      // u64 arrival ns, then the link bytes exactly as read
+    JournalRecord_Sample = 3,   // see EncodeSampleRecord
+    JournalRecord_LinkRaw = 4,  // u64 arrival ns, u8 link, 7 bytes padding, then the bytes of a link other than the first
+};
+
+static const size_t JOURNAL_HEADER_SIZE = 64;
+static const size_t JOURNAL_RECORD_HEADER_SIZE = 16;
+static const size_t JOURNAL_SAMPLE_RECORD_SIZE = 8 + 8 + 4 + 2 + 1 + 1 + 4 * Channel_COUNT;
+
+struct JournalRecord
+{
+    JournalRecordType Type;
+    uint32_t Sequence;
+    const uint8_t* Payload;
+    uint32_t Length;
+};
+
+uint32_t Crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+// Sample payload: u64 arrival ns, u64 parsed ns, f32 host time, u16 sequence, u8 format,
+// u8 channel count, f32 per channel in TELEMETRY_CHANNELS order. The time channel is written as
+// the u32 ms count, marked by 0x80 in the format byte; records without the mark hold an f32 there.
+size_t EncodeSampleRecord(const TelemetrySample& sample, uint8_t* out);
+bool DecodeSampleRecord(const JournalRecord& record, TelemetrySample& sample);
+
+class JournalWriter
+{
+public:
+    static const size_t GROW_BYTES = 64 * 1024 * 1024;
+
+    JournalWriter();
+
+    // Opens or creates path, recovering any records already in it, and appends a session record.
+    bool Open(const std::string& path);
+    void Close();
+
+    // Copies one record into the mapping; it is durable after the next Flush().
+    bool Append(JournalRecordType type, const void* payload, size_t length);
+    // Makes everything appended so far durable.
+    bool Flush();
+
+    bool IsOpen() const { return file_.IsOpen(); }
+    uint64_t RecoveredRecords() const { return recovered_records_; }
+    uint64_t Records() const { return next_sequence_; }
+    size_t BytesUsed() const { return end_; }
+
+private:
+    MappedFile file_;
+    size_t end_;
+    size_t flushed_;
+    uint32_t next_sequence_;
+    uint64_t recovered_records_;
+};
+
+class JournalReader
+{
+public:
+    JournalReader();
+
+    bool Open(const std::string& path);
+    void Close() { file_.Close(); }
+
+    // Next valid record, or false at the end of the durable data.
+    bool Next(JournalRecord& record);
+
+private:
+    MappedFile file_;
+    size_t offset_;
+    uint32_t next_sequence_;
+};
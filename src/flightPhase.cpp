@@ -0,0 +1,198 @@
+#include "flightPhase.h"
+#include <math.h>
+#include <string.h>
+
+const char* const FLIGHT_PHASE_NAMES[FlightPhase_COUNT] = { "Pad", "Boost", "Coast", "Drogue", "Main", "Landed" };
+const char* const FLIGHT_EVENT_NAMES[FlightEvent_COUNT] = { "Launch", "Burnout", "Apogee", "Drogue", "Main", "Landing" };
+
+// The pad altitude follows the barometer this slowly, so a launch still shows up as a climb above it.
+static const double PAD_ALTITUDE_SECONDS = 10.0;
+
+FlightPhaseDetector::FlightPhaseDetector(const FlightPhaseThresholds& thresholds)
+    : thresholds_(thresholds)
+{
+    Reset();
+}
+
+void FlightPhaseDetector::Reset()
+{
+    phase_ = FlightPhase_Pad;
+    events_ = 0;
+    fired_ = 0;
+    memset(records_, 0, sizeof(records_));
+    started_ = false;
+    last_time_ = 0.0;
+    phase_time_ = 0.0;
+    altitude_ = 0.0;
+    pad_altitude_ = 0.0;
+    peak_altitude_ = 0.0;
+    peak_ = FlightEventRecord();
+    band_min_ = band_max_ = 0.0;
+    band_start_ = 0.0;
+    band_onset_ = FlightEventRecord();
+    launch_ = burnout_ = deploy_ = Hold();
+}
+
+FlightEventRecord FlightPhaseDetector::Stamp(const TelemetrySample& sample, double time)
+{
+    FlightEventRecord record = {};
+    record.RocketTime = time;
+    record.HostTime = sample.hostTime;
+    record.ArrivalNs = sample.arrivalNs;
+    return record;
+}
+
+bool FlightPhaseDetector::Held(Hold& hold, bool condition, float seconds, const TelemetrySample& sample, double time)
+{
+    if (!condition)
+    {
+        hold.Active = false;
+        return false;
+    }
+    if (!hold.Active)
+    {
+        hold.Active = true;
+        hold.Start = time;
+        hold.Onset = Stamp(sample, time);
+    }
+    return time - hold.Start >= seconds;
+}
+
+void FlightPhaseDetector::Fire(FlightEvent event, const FlightEventRecord& onset, const TelemetrySample& sample, double time)
+{
+    FlightEventRecord& record = records_[event];
+    record = onset;
+    record.ConfirmedRocketTime = time;
+    record.ConfirmedArrivalNs = sample.arrivalNs;
+    events_ |= 1u << event;
+    fired_ |= 1u << event;
+}
+
+void FlightPhaseDetector::Enter(FlightPhase phase, double time)
+{
+    phase_ = phase;
+    phase_time_ = time;
+    deploy_.Active = false;
+}
+
+void FlightPhaseDetector::RestartBand(const TelemetrySample& sample, double time)
+{
+    band_min_ = band_max_ = altitude_;
+    band_start_ = time;
+    band_onset_ = Stamp(sample, time);
+}
+
+bool FlightPhaseDetector::CheckLanding(const TelemetrySample& sample, double time)
+{
+    band_min_ = fmin(band_min_, altitude_);
+    band_max_ = fmax(band_max_, altitude_);
+    if (band_max_ - band_min_ > thresholds_.LandedAltitudeBand)
+        RestartBand(sample, time);
+    if (time - band_start_ < thresholds_.LandedHoldSeconds)
+        return false;
+
+    Fire(FlightEvent_Landing, band_onset_, sample, time);
+    Enter(FlightPhase_Landed, time);
+    return true;
+}
+
+uint32_t FlightPhaseDetector::Update(const TelemetrySample& sample)
+{
+    double time = RocketSeconds(sample);
+
+    // a rocket clock that steps back means the flight computer restarted
+    if (started_ && time < last_time_)
+        Reset();
+
+    double dt = started_ ? time - last_time_ : 0.0;
+    if (!started_)
+    {
+        altitude_ = pad_altitude_ = sample.altitude;
+        started_ = true;
+    }
+    else
+    {
+        double tau = thresholds_.AltitudeSmoothingSeconds;
+        altitude_ += (tau > 0.0 ? 1.0 - exp(-dt / tau) : 1.0) * (sample.altitude - altitude_);
+    }
+    last_time_ = time;
+    fired_ = 0;
+
+    const FlightPhaseThresholds& t = thresholds_;
+    float axial = sample.zAccel;
+    bool thrust = sample.force > t.ThrustForce;
+    bool deploy_allowed = time - phase_time_ >= t.DeployLockoutSeconds;
+
+    switch (phase_)
+    {
+    case FlightPhase_Pad:
+        if (Held(launch_, axial > t.LaunchAcceleration || thrust, t.LaunchHoldSeconds, sample, time))
+        {
+            Fire(FlightEvent_Launch, launch_.Onset, sample, time);
+            Enter(FlightPhase_Boost, time);
+        }
+        else if (altitude_ - pad_altitude_ > t.LaunchAltitude)
+        {
+            Fire(FlightEvent_Launch, Stamp(sample, time), sample, time);
+            Enter(FlightPhase_Boost, time);
+        }
+        else
+            pad_altitude_ += (1.0 - exp(-dt / PAD_ALTITUDE_SECONDS)) * (altitude_ - pad_altitude_);
+        break;
+
+    case FlightPhase_Boost:
+        if (Held(burnout_, axial < t.BurnoutAcceleration && !thrust, t.BurnoutHoldSeconds, sample, time))
+        {
+            Fire(FlightEvent_Burnout, burnout_.Onset, sample, time);
+            Enter(FlightPhase_Coast, time);
+            peak_altitude_ = altitude_;
+            peak_ = Stamp(sample, time);
+        }
+        break;
+
+    case FlightPhase_Coast:
+        if (!Detected(FlightEvent_Apogee))
+        {
+            if (altitude_ > peak_altitude_)
+            {
+                peak_altitude_ = altitude_;
+                peak_ = Stamp(sample, time);
+            }
+            if (peak_altitude_ - altitude_ > t.ApogeeDrop)
+            {
+                Fire(FlightEvent_Apogee, peak_, sample, time);
+                RestartBand(sample, time);
+            }
+        }
+        // the drogue usually opens at apogee, before the altitude has dropped far enough to tell
+        if (deploy_allowed && Held(deploy_, axial > t.DeployAcceleration, t.DeployHoldSeconds, sample, time))
+        {
+            if (!Detected(FlightEvent_Apogee))
+                Fire(FlightEvent_Apogee, peak_, sample, time);
+            Fire(FlightEvent_Drogue, deploy_.Onset, sample, time);
+            Enter(FlightPhase_Drogue, time);
+            RestartBand(sample, time);
+        }
+        else if (Detected(FlightEvent_Apogee))
+            CheckLanding(sample, time);
+        break;
+
+    case FlightPhase_Drogue:
+        if (deploy_allowed && Held(deploy_, axial > t.DeployAcceleration, t.DeployHoldSeconds, sample, time))
+        {
+            Fire(FlightEvent_Main, deploy_.Onset, sample, time);
+            Enter(FlightPhase_Main, time);
+        }
+        else
+            CheckLanding(sample, time);
+        break;
+
+    case FlightPhase_Main:
+        CheckLanding(sample, time);
+        break;
+
+    default:
+        break;
+    }
+    return fired_;
+}
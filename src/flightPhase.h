@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+#include "telemetrySample.h"
+
+enum FlightPhase
+{
+    FlightPhase_Pad,
+    FlightPhase_Boost,
+    FlightPhase_Coast,
+    FlightPhase_Drogue,
+    FlightPhase_Main,
+    FlightPhase_Landed,
+    FlightPhase_COUNT
+};
+
+extern const char* const FLIGHT_PHASE_NAMES[FlightPhase_COUNT];
+
+// Flight events, in the order they normally happen. Apogee is the only one that does not start a
+// phase of its own: the phase stays Coast until the drogue opens.
+enum FlightEvent
+{
+    FlightEvent_Launch,
+    FlightEvent_Burnout,
+    FlightEvent_Apogee,
+    FlightEvent_Drogue,
+    FlightEvent_Main,
+    FlightEvent_Landing,
+    FlightEvent_COUNT
+};
+
+extern const char* const FLIGHT_EVENT_NAMES[FlightEvent_COUNT];
+
+// Detection thresholds. Each condition has to hold for its hold time before the event fires, so a
+// single noisy sample never changes the phase. Accelerations are axial, in milli-g.
+struct FlightPhaseThresholds
+{
+    float LaunchAcceleration = 2000.0f;     // above this...
+    float LaunchHoldSeconds = 0.1f;         // ...for this long
+    float LaunchAltitude = 20.0f;           // or this far above the pad (backup if the accelerometer saturates)
+    float ThrustForce = 500.0f;             // force channel above this means the motor is burning
+    float BurnoutAcceleration = 500.0f;     // below this after launch
+    float BurnoutHoldSeconds = 0.1f;
+    float AltitudeSmoothingSeconds = 0.1f;  // time constant of the altitude filter
+    float ApogeeDrop = 2.0f;                // filtered altitude this far below its peak, m
+    float DeployAcceleration = 3000.0f;     // parachute opening shock
+    float DeployHoldSeconds = 0.02f;
+    float DeployLockoutSeconds = 1.0f;      // after burnout or the drogue, so one shock is not seen twice
+    float LandedAltitudeBand = 2.0f;        // filtered altitude stays within this band, m...
+    float LandedHoldSeconds = 1.0f;         // ...for this long
+};
+
+// When an event fired. The event is stamped with the sample that started the run of samples
+// satisfying its condition (the onset); Confirmed is the sample that completed the hold time, i.e.
+// when the detector could first know. Confirmed - onset is the latency the hysteresis costs.
+struct FlightEventRecord
+{
+    double RocketTime;          // onset sample's `time` channel, s
+    float HostTime;             // onset sample's hostTime
+    uint64_t ArrivalNs;         // onset sample's arrivalNs
+    double ConfirmedRocketTime;
+    uint64_t ConfirmedArrivalNs;
+};
+
+// Streaming flight-phase state machine, fed one decoded sample at a time from axial acceleration,
+// altitude and force. Pad -> Boost on launch, Boost -> Coast on burnout, Coast -> Drogue on the
+// drogue shock (apogee is detected from the altitude peak in between), Drogue -> Main on the main
+// shock and any phase after apogee -> Landed once the altitude settles. O(1) per sample.
+class FlightPhaseDetector
+{
+public:
+    explicit FlightPhaseDetector(const FlightPhaseThresholds& thresholds = FlightPhaseThresholds());
+
+    void SetThresholds(const FlightPhaseThresholds& thresholds) { thresholds_ = thresholds; }
+    const FlightPhaseThresholds& Thresholds() const { return thresholds_; }
+
+    void Reset();
+
+    // Returns a mask of the FlightEvent bits that fired on this sample.
+    uint32_t Update(const TelemetrySample& sample);
+
+    FlightPhase Phase() const { return phase_; }
+    uint32_t Events() const { return events_; }
+    bool Detected(FlightEvent event) const { return (events_ >> event) & 1; }
+    const FlightEventRecord& Event(FlightEvent event) const { return records_[event]; }
+
+private:
+    // A condition that must hold continuously for a while. Remembers the sample it started on.
+    struct Hold
+    {
+        bool Active;
+        double Start;
+        FlightEventRecord Onset;
+    };
+
+    static FlightEventRecord Stamp(const TelemetrySample& sample, double time);
+    static bool Held(Hold& hold, bool condition, float seconds, const TelemetrySample& sample, double time);
+    void Fire(FlightEvent event, const FlightEventRecord& onset, const TelemetrySample& sample, double time);
+    void Enter(FlightPhase phase, double time);
+    void RestartBand(const TelemetrySample& sample, double time);
+    bool CheckLanding(const TelemetrySample& sample, double time);
+
+    FlightPhaseThresholds thresholds_;
+    FlightPhase phase_;
+    uint32_t events_;
+    uint32_t fired_;
+    FlightEventRecord records_[FlightEvent_COUNT];
+
+    bool started_;
+    double last_time_;
+    double phase_time_;         // rocket time the current phase was confirmed
+    double altitude_;           // filtered
+    double pad_altitude_;
+    double peak_altitude_;
+    FlightEventRecord peak_;
+    double band_min_, band_max_;
+    double band_start_;
+    FlightEventRecord band_onset_;
+
+    Hold launch_, burnout_, deploy_;
+};
@@ -0,0 +1,135 @@
+#include "flightRecorder.h"
+#include <chrono>
+#include <string.h>
+
+FlightRecorder::FlightRecorder()
+    : running_(false), enabled_(true), records_written_(0), records_dropped_(0), recovered_records_(0), write_failed_(false)
+{
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    Stop();
+}
+
+bool FlightRecorder::Start(const std::string& path)
+{
+    if (running_.load())
+        return true;
+    if (!journal_.Open(path))
+    {
+        write_failed_.store(true);
+        return false;
+    }
+
+    recovered_records_.store(journal_.RecoveredRecords());
+    running_.store(true);
+    thread_ = std::thread(&FlightRecorder::Run, this);
+    return true;
+}
+
+void FlightRecorder::Stop()
+{
+    running_.store(false);
+    if (thread_.joinable())
+        thread_.join();
+    journal_.Close();
+}
+
+void FlightRecorder::RecordRaw(uint64_t arrival_ns, const uint8_t* data, size_t length, uint8_t link)
+{
+    if (!Enabled() || !Running())
+        return;
+
+    while (length > 0)
+    {
+        RawChunk chunk;
+        chunk.ArrivalNs = arrival_ns;
+        chunk.Link = link;
+        chunk.Length = (uint16_t)(length < RAW_CHUNK_BYTES ? length : RAW_CHUNK_BYTES);
+        memcpy(chunk.Data, data, chunk.Length);
+        if (!raw_.Push(chunk))
+            records_dropped_.fetch_add(1, std::memory_order_relaxed);
+        data += chunk.Length;
+        length -= chunk.Length;
+    }
+}
+
+void FlightRecorder::RecordSample(const TelemetrySample& sample)
+{
+    if (!Enabled() || !Running())
+        return;
+    if (!samples_.Push(sample))
+        records_dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t FlightRecorder::WriteQueued()
+{
+    static const size_t BATCH = 64;
+    size_t written = 0;
+    bool ok = true;
+
+    // raw bytes first, so samples usually follow the bytes they were decoded from
+    RawChunk chunks[BATCH / 4];
+    size_t count;
+    while ((count = raw_.PopBatch(chunks, BATCH / 4)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            uint8_t payload[16 + RAW_CHUNK_BYTES];
+            memcpy(payload, &chunks[i].ArrivalNs, 8);
+            if (chunks[i].Link == 0)
+            {
+                memcpy(payload + 8, chunks[i].Data, chunks[i].Length);
+                ok &= journal_.Append(JournalRecord_Raw, payload, 8 + chunks[i].Length);
+            }
+            else
+            {
+                memset(payload + 8, 0, 8);
+                payload[8] = chunks[i].Link;
+                memcpy(payload + 16, chunks[i].Data, chunks[i].Length);
+                ok &= journal_.Append(JournalRecord_LinkRaw, payload, 16 + chunks[i].Length);
+            }
+        }
+        written += count;
+    }
+
+    TelemetrySample samples[BATCH];
+    while ((count = samples_.PopBatch(samples, BATCH)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            uint8_t payload[JOURNAL_SAMPLE_RECORD_SIZE];
+            ok &= journal_.Append(JournalRecord_Sample, payload, EncodeSampleRecord(samples[i], payload));
+        }
+        written += count;
+    }
+
+    if (!ok)
+        write_failed_.store(true, std::memory_order_relaxed);
+    records_written_.fetch_add(written, std::memory_order_relaxed);
+    return written;
+}
+
+void FlightRecorder::Run()
+{
+    auto last_flush = std::chrono::steady_clock::now();
+
+    while (running_.load(std::memory_order_relaxed))
+    {
+        if (WriteQueued() == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_flush >= std::chrono::milliseconds(FLUSH_INTERVAL_MS))
+        {
+            if (!journal_.Flush())
+                write_failed_.store(true, std::memory_order_relaxed);
+            last_flush = now;
+        }
+    }
+
+    WriteQueued();
+    if (!journal_.Flush())
+        write_failed_.store(true, std::memory_order_relaxed);
+}
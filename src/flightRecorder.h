@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include "flightJournal.h"
+#include "spscRing.h"
+#include "telemetrySample.h"
+
+// Background flight recorder.
+// The ingest thread hands it raw link bytes and decoded samples through lock-free rings; a
+// dedicated thread appends them to a JournalWriter in batches and makes each batch durable
+// every FLUSH_INTERVAL_MS (group commit). No disk I/O ever happens on the ingest or UI thread.
+// If the recorder falls behind, new records are counted as dropped rather than blocking ingest.
+class FlightRecorder
+{
+public:
+    static const size_t SAMPLE_QUEUE_CAPACITY = 4096;
+    static const size_t RAW_QUEUE_CAPACITY = 1024;
+    static const size_t RAW_CHUNK_BYTES = 240;
+    static const int FLUSH_INTERVAL_MS = 250;
+
+    FlightRecorder();
+    ~FlightRecorder();
+
+    // Opens (and recovers) the journal at path and starts the recorder thread.
+    bool Start(const std::string& path);
+    // Writes out everything still queued, flushes and closes the journal.
+    void Stop();
+
+    // One producer at a time (the ingest serializes its link threads). Raw reads of the first link
+    // are Raw records, which replay reads back; other links' are LinkRaw records.
+    void RecordRaw(uint64_t arrival_ns, const uint8_t* data, size_t length, uint8_t link = 0);
+    void RecordSample(const TelemetrySample& sample);
+
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    bool Running() const { return running_.load(std::memory_order_relaxed); }
+
+    uint64_t RecordsWritten() const { return records_written_.load(std::memory_order_relaxed); }
+    uint64_t RecordsDropped() const { return records_dropped_.load(std::memory_order_relaxed); }
+    uint64_t RecoveredRecords() const { return recovered_records_.load(std::memory_order_relaxed); }
+    bool WriteFailed() const { return write_failed_.load(std::memory_order_relaxed); }
+
+private:
+    struct RawChunk
+    {
+        uint64_t ArrivalNs;
+        uint16_t Length;
+        uint8_t Link;
+        uint8_t Data[RAW_CHUNK_BYTES];
+    };
+
+    void Run();
+    size_t WriteQueued();
+
+    JournalWriter journal_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> enabled_;
+
+    std::atomic<uint64_t> records_written_;
+    std::atomic<uint64_t> records_dropped_;
+    std::atomic<uint64_t> recovered_records_;
+    std::atomic<bool> write_failed_;
+
+    SpscRing<TelemetrySample, SAMPLE_QUEUE_CAPACITY> samples_;
+    SpscRing<RawChunk, RAW_QUEUE_CAPACITY> raw_;
+};
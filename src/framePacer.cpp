@@ -0,0 +1,33 @@
+#include "framePacer.h"
+
+FramePacer::FramePacer(const FramePacingConfig& config)
+    : config_(config), last_activity_ns_(0), last_frame_ns_(0), second_start_ns_(0), frames_this_second_(0),
+      frames_per_second_(0)
+{
+}
+
+void FramePacer::FrameDrawn(uint64_t now_ns)
+{
+    last_frame_ns_ = now_ns;
+    frames_this_second_++;
+    if (now_ns - second_start_ns_ >= 1000000000ull)
+    {
+        frames_per_second_ = frames_this_second_;
+        frames_this_second_ = 0;
+        second_start_ns_ = now_ns;
+    }
+}
+
+bool FramePacer::Idle(uint64_t now_ns) const
+{
+    return now_ns - last_activity_ns_ >= config_.ActiveHoldMs * 1000000ull;
+}
+
+uint32_t FramePacer::WaitMs(uint64_t now_ns) const
+{
+    if (!Idle(now_ns))
+        return 0;
+
+    uint64_t since_frame_ms = (now_ns - last_frame_ns_) / 1000000;
+    return since_frame_ms >= config_.IdleFrameMs ? 0 : (uint32_t)(config_.IdleFrameMs - since_frame_ms);
+}
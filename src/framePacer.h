@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+struct FramePacingConfig
+{
+    uint32_t IdleFrameMs = 250;     // redraw period once nothing changes
+    uint32_t ActiveHoldMs = 500;    // full rate lasts this long after the last input or new data
+};
+
+// Decides how long the render loop may sleep before its next frame. While samples or input keep
+// arriving frames follow the display (no wait); once both stop the loop falls back to one frame
+// every IdleFrameMs. The loop is expected to wait on input and on the store's publish signal, so
+// it still wakes at once when either arrives: pacing never adds latency to new data.
+class FramePacer
+{
+public:
+    explicit FramePacer(const FramePacingConfig& config = FramePacingConfig());
+
+    void SetConfig(const FramePacingConfig& config) { config_ = config; }
+
+    // Something on screen changes: input, new samples, a widget being dragged or typed into.
+    void Activity(uint64_t now_ns) { last_activity_ns_ = now_ns; }
+    void FrameDrawn(uint64_t now_ns);
+
+    // Time to sleep (waking early for input or data) before the next frame; 0 to draw straight away.
+    uint32_t WaitMs(uint64_t now_ns) const;
+    bool Idle(uint64_t now_ns) const;
+    // Frames drawn over the last whole second.
+    int FramesPerSecond() const { return frames_per_second_; }
+
+private:
+    FramePacingConfig config_;
+    uint64_t last_activity_ns_;
+    uint64_t last_frame_ns_;
+    uint64_t second_start_ns_;
+    int frames_this_second_;
+    int frames_per_second_;
+};
@@ -0,0 +1,161 @@
+#include "historyCodec.h"
+#include <math.h>
+#include <string.h>
+
+static uint32_t ZigZag(uint32_t delta) { return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31); }
+static uint32_t UnZigZag(uint32_t code) { return (code >> 1) ^ (0u - (code & 1)); }
+
+static int BitWidth(uint32_t value)
+{
+    int width = 0;
+    while (value)
+    {
+        width++;
+        value >>= 1;
+    }
+    return width;
+}
+
+static size_t PackedBytes(int width, size_t count) { return (width * count + 7) / 8; }
+
+// Integral and exactly representable as int32; -0 is not, it would come back as +0.
+static bool IsInteger(float value)
+{
+    return value == floorf(value) && fabsf(value) < 2147483648.0f && !(value == 0.0f && signbit(value));
+}
+
+static uint32_t Word(float value, int mode)
+{
+    if (mode & HISTORY_MODE_INTEGER)
+        return (uint32_t)(int32_t)value;
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Calls fn(index, code) for each value's zigzag code under mode.
+template<typename Fn>
+static void ForEachCode(const float* values, size_t count, int mode, Fn fn)
+{
+    uint32_t previous = 0;
+    uint32_t previous_delta = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t word = Word(values[i], mode);
+        uint32_t delta = word - previous;
+        previous = word;
+        fn(i, ZigZag((mode & HISTORY_MODE_SECOND_ORDER) ? delta - previous_delta : delta));
+        previous_delta = delta;
+    }
+}
+
+// Stream sizes with first and with second order deltas, in one pass.
+static void EncodedSizes(const float* values, size_t count, int mode, size_t& first_order, size_t& second_order)
+{
+    first_order = second_order = 1;
+    uint32_t previous = 0;
+    uint32_t previous_delta = 0;
+    uint32_t first_bits = 0;
+    uint32_t second_bits = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t word = Word(values[i], mode);
+        uint32_t delta = word - previous;
+        first_bits |= ZigZag(delta);
+        second_bits |= ZigZag(delta - previous_delta);
+        previous = word;
+        previous_delta = delta;
+
+        if ((i + 1) % HISTORY_GROUP_VALUES == 0 || i + 1 == count)
+        {
+            size_t group_count = i % HISTORY_GROUP_VALUES + 1;
+            first_order += 1 + PackedBytes(BitWidth(first_bits), group_count);
+            second_order += 1 + PackedBytes(BitWidth(second_bits), group_count);
+            first_bits = second_bits = 0;
+        }
+    }
+}
+
+size_t EncodeHistoryColumn(const float* values, size_t count, std::vector<uint8_t>& out)
+{
+    bool integers = true;
+    for (size_t i = 0; i < count && integers; i++)
+        integers = IsInteger(values[i]);
+
+    int mode = integers ? HISTORY_MODE_INTEGER : 0;
+    size_t first_order, second_order;
+    EncodedSizes(values, count, mode, first_order, second_order);
+    if (second_order < first_order)
+        mode |= HISTORY_MODE_SECOND_ORDER;
+
+    size_t start = out.size();
+    out.push_back((uint8_t)mode);
+
+    uint32_t codes[HISTORY_GROUP_VALUES];
+    uint32_t group_bits = 0;
+    ForEachCode(values, count, mode, [&](size_t i, uint32_t code)
+    {
+        codes[i % HISTORY_GROUP_VALUES] = code;
+        group_bits |= code;
+        if ((i + 1) % HISTORY_GROUP_VALUES != 0 && i + 1 != count)
+            return;
+
+        size_t group_count = i % HISTORY_GROUP_VALUES + 1;
+        int width = BitWidth(group_bits);
+        out.push_back((uint8_t)width);
+        uint64_t pending = 0;
+        int pending_bits = 0;
+        for (size_t j = 0; j < group_count; j++)
+        {
+            pending |= (uint64_t)codes[j] << pending_bits;
+            pending_bits += width;
+            while (pending_bits >= 8)
+            {
+                out.push_back((uint8_t)pending);
+                pending >>= 8;
+                pending_bits -= 8;
+            }
+        }
+        if (pending_bits > 0)
+            out.push_back((uint8_t)pending);
+        group_bits = 0;
+    });
+    return out.size() - start;
+}
+
+void DecodeHistoryColumn(const uint8_t* in, size_t count, float* values)
+{
+    int mode = *in++;
+    uint32_t previous = 0;
+    uint32_t previous_delta = 0;
+    for (size_t group = 0; group < count; group += HISTORY_GROUP_VALUES)
+    {
+        size_t group_count = count - group < HISTORY_GROUP_VALUES ? count - group : HISTORY_GROUP_VALUES;
+        int width = *in++;
+        uint32_t mask = width == 32 ? 0xFFFFFFFFu : (1u << width) - 1;
+        uint64_t pending = 0;
+        int pending_bits = 0;
+        for (size_t i = group; i < group + group_count; i++)
+        {
+            while (pending_bits < width)
+            {
+                pending |= (uint64_t)*in++ << pending_bits;
+                pending_bits += 8;
+            }
+            uint32_t code = (uint32_t)pending & mask;
+            pending >>= width;
+            pending_bits -= width;
+
+            uint32_t delta = UnZigZag(code);
+            if (mode & HISTORY_MODE_SECOND_ORDER)
+                delta += previous_delta;
+            previous_delta = delta;
+            previous += delta;
+
+            if (mode & HISTORY_MODE_INTEGER)
+                values[i] = (float)(int32_t)previous;
+            else
+                memcpy(&values[i], &previous, sizeof(float));
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Lossless compression of one float column of a sealed TelemetryStore chunk.
+//
+// Each value becomes the zigzag-encoded delta, or delta of deltas, from the ones before it, taken
+// either of the value as an integer (sensor channels, counters) or of its IEEE bit pattern
+// (estimated and derived channels, timestamps). The four variants are sized in one pass and the
+// smallest kept. The zigzag codes are bit-packed in groups of HISTORY_GROUP_VALUES at the width
+// of the group's largest code, so a slowly changing channel costs a few bits per value and a
+// constant one a byte per group.
+//
+// Stream: u8 mode (HISTORY_MODE_ flags), then per group: u8 width, width * count bits, LSB first.
+
+static const size_t HISTORY_GROUP_VALUES = 32;
+
+enum HistoryMode_
+{
+    HISTORY_MODE_INTEGER        = 1 << 0,   // deltas of the values as int32; otherwise of their bit patterns
+    HISTORY_MODE_SECOND_ORDER   = 1 << 1,   // deltas of the deltas
+};
+
+// Appends the encoding of values[0, count) to out; returns the bytes appended.
+size_t EncodeHistoryColumn(const float* values, size_t count, std::vector<uint8_t>& out);
+// Decodes count values of a stream written by EncodeHistoryColumn.
+void DecodeHistoryColumn(const uint8_t* in, size_t count, float* values);
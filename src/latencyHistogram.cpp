@@ -0,0 +1,75 @@
+#include "latencyHistogram.h"
+#include <chrono>
+#include <string.h>
+
+uint64_t MonotonicNanoseconds()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int HighestBit(uint64_t value)
+{
+    int bit = 0;
+    for (int step = 32; step > 0; step >>= 1)
+    {
+        if (value >> (bit + step))
+            bit += step;
+    }
+    return bit;
+}
+
+void LatencyHistogram::Reset()
+{
+    memset(buckets_, 0, sizeof(buckets_));
+    count_ = 0;
+    max_ = 0;
+}
+
+int LatencyHistogram::BucketIndex(uint64_t ns)
+{
+    if (ns < SUB_BUCKETS)
+        return (int)ns;
+    int shift = HighestBit(ns) - SUB_BITS;
+    return (shift + 1) * SUB_BUCKETS + (int)((ns >> shift) & (SUB_BUCKETS - 1));
+}
+
+// midpoint of the bucket's range
+uint64_t LatencyHistogram::BucketValue(int index)
+{
+    int group = index / SUB_BUCKETS;
+    uint64_t sub = index % SUB_BUCKETS;
+    if (group == 0)
+        return sub;
+    uint64_t width = (uint64_t)1 << (group - 1);
+    return ((SUB_BUCKETS + sub) << (group - 1)) + width / 2;
+}
+
+void LatencyHistogram::Record(uint64_t ns)
+{
+    buckets_[BucketIndex(ns)]++;
+    count_++;
+    if (ns > max_)
+        max_ = ns;
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const
+{
+    if (count_ == 0)
+        return 0;
+
+    uint64_t target = (uint64_t)(fraction * count_ + 0.5);
+    if (target < 1)
+        target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        seen += buckets_[i];
+        if (seen >= target)
+        {
+            uint64_t value = BucketValue(i);
+            return value < max_ ? value : max_;
+        }
+    }
+    return max_;
+}
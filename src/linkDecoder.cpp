@@ -0,0 +1,238 @@
+#include "linkDecoder.h"
+#include <string.h>
+
+// Longest ASCII frame kept while waiting for its end delimiter.
+static const size_t MAX_ASCII_FRAME = 512;
+
+// A binary sequence number this far behind the last one is not a late copy: the sender restarted
+// (a reboot), or the link was out for more than half the counter.
+static const uint16_t SEQUENCE_RESTART_GAP = 256;
+// Repeated-looking packets in a row that mean the same, for a restart that landed close behind.
+static const uint32_t SEQUENCE_RESTART_RUN = 8;
+
+// "Ack:<seq>", the flight computer's answer to "{Cmd:<seq>:<code>}".
+static bool ParseAck(std::string_view frame, uint16_t& sequence)
+{
+    static const std::string_view header = "Ack:";
+    if (frame.size() <= header.size() || frame.size() > header.size() + 5 || frame.compare(0, header.size(), header) != 0)
+        return false;
+    uint32_t value = 0;
+    for (size_t i = header.size(); i < frame.size(); i++)
+    {
+        if (frame[i] < '0' || frame[i] > '9')
+            return false;
+        value = value * 10 + (frame[i] - '0');
+    }
+    if (value > 0xFFFF)
+        return false;
+    sequence = (uint16_t)value;
+    return true;
+}
+
+LinkDecoder::LinkDecoder(char front_delimiter, char end_delimiter)
+    : front_delimiter_(front_delimiter), end_delimiter_(end_delimiter), in_ascii_frame_(false),
+      binary_length_(0), binary_overflow_(false), have_sequence_(false), last_sequence_(0),
+      duplicate_run_(0), ascii_frames_(0), binary_frames_(0), ack_frames_(0), rejected_(0), lost_packets_(0),
+      duplicate_packets_(0), sequence_restarts_(0), last_error_(ParseStatus::Ok)
+{
+    ascii_frame_.reserve(256);
+}
+
+void LinkDecoder::Feed(const uint8_t* data, size_t length, const SampleCallback& on_sample, const AckCallback& on_ack)
+{
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + length;
+
+    while (cursor < end)
+    {
+        const uint8_t* zero = (const uint8_t*)memchr(cursor, 0, end - cursor);
+        const uint8_t* stop = zero ? zero : end;
+        size_t run = stop - cursor;
+
+        // Every byte up to the next 0x00 is possible ASCII text and part of a binary candidate.
+        // A completed ASCII frame restarts the candidate, so a packet sent right after text still decodes.
+        size_t ascii_end = ScanAscii((const char*)cursor, run, on_sample, on_ack);
+        if (ascii_end != 0)
+        {
+            binary_length_ = 0;
+            binary_overflow_ = false;
+        }
+        AppendBinaryCandidate(cursor + ascii_end, run - ascii_end);
+
+        if (zero == nullptr)
+            break;
+
+        FinishBinaryCandidate(on_sample);
+        cursor = zero + 1;
+    }
+}
+
+void LinkDecoder::AppendBinaryCandidate(const uint8_t* data, size_t length)
+{
+    if (binary_overflow_)
+        return;
+    if (binary_length_ + length > BINARY_ENCODED_SIZE)
+    {
+        binary_overflow_ = true;
+        return;
+    }
+    memcpy(binary_frame_ + binary_length_, data, length);
+    binary_length_ += length;
+}
+
+// Returns the offset just past the last frame that ended in data, or 0 if none did.
+size_t LinkDecoder::ScanAscii(const char* data, size_t length, const SampleCallback& on_sample, const AckCallback& on_ack)
+{
+    const char* cursor = data;
+    const char* end = data + length;
+    size_t frame_end = 0;
+
+    while (cursor < end)
+    {
+        if (!in_ascii_frame_)
+        {
+            const char* front = (const char*)memchr(cursor, front_delimiter_, end - cursor);
+            if (front == nullptr)
+                break;
+            in_ascii_frame_ = true;
+            ascii_frame_.clear();
+            cursor = front + 1;
+            continue;
+        }
+
+        const char* stop = (const char*)memchr(cursor, end_delimiter_, end - cursor);
+        const char* restart = (const char*)memchr(cursor, front_delimiter_, (stop ? stop : end) - cursor);
+        if (restart != nullptr)
+        {
+            ascii_frame_.clear();
+            cursor = restart + 1;
+            continue;
+        }
+
+        if (stop == nullptr)
+        {
+            ascii_frame_.append(cursor, end - cursor);
+            if (ascii_frame_.size() > MAX_ASCII_FRAME)
+            {
+                Reject(ParseStatus::BadLength);
+                ascii_frame_.clear();
+                in_ascii_frame_ = false;
+            }
+            break;
+        }
+
+        std::string_view frame;
+        if (ascii_frame_.empty())
+            frame = std::string_view(cursor, stop - cursor);
+        else
+        {
+            ascii_frame_.append(cursor, stop - cursor);
+            frame = ascii_frame_;
+        }
+
+        TelemetrySample sample;
+        uint16_t sequence;
+        ParseStatus status = ParseTelemetryFrame(frame, sample);
+        if (status == ParseStatus::Ok)
+        {
+            ascii_frames_++;
+            on_sample(sample);
+        }
+        else if (status == ParseStatus::MissingHeader && on_ack && ParseAck(frame, sequence))
+        {
+            ack_frames_++;
+            status = ParseStatus::Ok;
+            on_ack(sequence);
+        }
+        else if (status != ParseStatus::MissingHeader)
+            Reject(status);     // text without the "Data:" header is line noise or binary payload, not a frame
+
+        ascii_frame_.clear();
+        in_ascii_frame_ = false;
+        cursor = stop + 1;
+        if (status != ParseStatus::MissingHeader)
+            frame_end = cursor - data;
+    }
+
+    return frame_end;
+}
+
+void LinkDecoder::FinishBinaryCandidate(const SampleCallback& on_sample)
+{
+    // ASCII frames never contain 0x00, so whatever was in flight is garbage
+    in_ascii_frame_ = false;
+    ascii_frame_.clear();
+
+    size_t length = binary_length_;
+    bool overflow = binary_overflow_;
+    binary_length_ = 0;
+    binary_overflow_ = false;
+
+    // back-to-back delimiters, a long run of ASCII text, or line endings after an ASCII frame
+    if (length == 0 || overflow)
+        return;
+    size_t whitespace = 0;
+    while (whitespace < length && (binary_frame_[whitespace] == '\r' || binary_frame_[whitespace] == '\n' || binary_frame_[whitespace] == ' '))
+        whitespace++;
+    if (whitespace == length)
+        return;
+
+    TelemetrySample sample;
+    ParseStatus status = DecodeBinaryPacket(binary_frame_, length, sample);
+    if (status != ParseStatus::Ok)
+    {
+        Reject(status);
+        return;
+    }
+
+    binary_frames_++;
+    if (TrackSequence(sample.sequence))
+        on_sample(sample);
+}
+
+void LinkDecoder::Reject(ParseStatus status)
+{
+    rejected_++;
+    last_error_ = status;
+}
+
+void LinkDecoder::ResetStream()
+{
+    ascii_frame_.clear();
+    in_ascii_frame_ = false;
+    binary_length_ = 0;
+    binary_overflow_ = false;
+    have_sequence_ = false;
+    duplicate_run_ = 0;
+}
+
+// Returns false for a repeated or late packet, which is dropped.
+bool LinkDecoder::TrackSequence(uint16_t sequence)
+{
+    if (have_sequence_)
+    {
+        uint16_t delta = (uint16_t)(sequence - last_sequence_);
+        if (delta == 0 || delta >= 0x8000)
+        {
+            uint16_t behind = (uint16_t)(last_sequence_ - sequence);
+            if (behind <= SEQUENCE_RESTART_GAP && duplicate_run_ + 1 < SEQUENCE_RESTART_RUN)
+            {
+                duplicate_run_++;
+                duplicate_packets_++;
+                return false;
+            }
+            // start over from this packet; the run dropped on the way was lost, not repeated
+            sequence_restarts_++;
+            duplicate_packets_ -= duplicate_run_;
+            lost_packets_ += duplicate_run_;
+            duplicate_run_ = 0;
+            last_sequence_ = sequence;
+            return true;
+        }
+        lost_packets_ += delta - 1;
+    }
+    have_sequence_ = true;
+    last_sequence_ = sequence;
+    duplicate_run_ = 0;
+    return true;
+}
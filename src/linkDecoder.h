@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "binaryProtocol.h"
+#include "telemetryParser.h"
+#include "telemetrySample.h"
+
+// Turns the raw byte stream from a link into samples, auto-detecting the format per frame.
+// ASCII frames are delimited by front/end characters ("{Data:...:}"); binary packets are COBS
+// encoded and end in 0x00 (see binaryProtocol.h). Neither format ever contains a 0x00 inside a
+// frame, so every 0x00 closes the current binary candidate and resets the ASCII splitter.
+// Command acknowledgements from the flight computer ("{Ack:<seq>}") share the ASCII framing.
+class LinkDecoder
+{
+public:
+    typedef std::function<void(const TelemetrySample& sample)> SampleCallback;
+    typedef std::function<void(uint16_t sequence)> AckCallback;
+
+    explicit LinkDecoder(char front_delimiter = '{', char end_delimiter = '}');
+
+    // Decodes every complete frame in data. Incomplete frames are carried over to the next call.
+    // Acks are only looked for when on_ack is set.
+    void Feed(const uint8_t* data, size_t length, const SampleCallback& on_sample, const AckCallback& on_ack = nullptr);
+    // Drops any partial frame and forgets the last binary sequence number, for a new or reopened
+    // source; the counters carry on.
+    void ResetStream();
+
+    uint64_t AsciiFrames() const { return ascii_frames_; }
+    uint64_t BinaryFrames() const { return binary_frames_; }
+    uint64_t AckFrames() const { return ack_frames_; }
+    uint64_t Rejected() const { return rejected_; }
+    uint64_t LostPackets() const { return lost_packets_; }          // gaps in the binary sequence numbers
+    uint64_t DuplicatePackets() const { return duplicate_packets_; }
+    uint64_t SequenceRestarts() const { return sequence_restarts_; }  // the sender's counter started over
+    ParseStatus LastError() const { return last_error_; }
+
+private:
+    size_t ScanAscii(const char* data, size_t length, const SampleCallback& on_sample, const AckCallback& on_ack);
+    void AppendBinaryCandidate(const uint8_t* data, size_t length);
+    void FinishBinaryCandidate(const SampleCallback& on_sample);
+    void Reject(ParseStatus status);
+    bool TrackSequence(uint16_t sequence);
+
+    char front_delimiter_;
+    char end_delimiter_;
+
+    std::string ascii_frame_;
+    bool in_ascii_frame_;
+
+    uint8_t binary_frame_[BINARY_ENCODED_SIZE];
+    size_t binary_length_;
+    bool binary_overflow_;
+
+    bool have_sequence_;
+    uint16_t last_sequence_;
+    uint32_t duplicate_run_;    // packets in a row that looked repeated
+
+    uint64_t ascii_frames_;
+    uint64_t binary_frames_;
+    uint64_t ack_frames_;
+    uint64_t rejected_;
+    uint64_t lost_packets_;
+    uint64_t duplicate_packets_;
+    uint64_t sequence_restarts_;
+    ParseStatus last_error_;
+};
@@ -0,0 +1,148 @@
+#include "linkMerger.h"
+#include <algorithm>
+#include <string.h>
+
+// FNV-1a over the channel values as received
+static uint32_t HashValues(const TelemetrySample& sample)
+{
+    uint32_t hash = 2166136261u;
+    for (const ChannelDef& channel : CHANNELS)
+    {
+        uint8_t bytes[4];
+        memcpy(bytes, &(sample.*channel.member), 4);
+        for (uint8_t byte : bytes)
+            hash = (hash ^ byte) * 16777619u;
+    }
+    return hash;
+}
+
+LinkMerger::LinkMerger(const LinkMergeConfig& config)
+    : config_(config)
+{
+    Reset();
+}
+
+void LinkMerger::Reset()
+{
+    held_count_ = 0;
+    for (int link = 0; link < MAX_LINKS; link++)
+    {
+        link_seen_[link] = false;
+        link_time_[link] = 0;
+        link_ordinal_[link] = 0;
+        link_arrival_ns_[link] = 0;
+    }
+    merged_any_ = false;
+    last_merged_ = SampleKey();
+    recent_count_ = 0;
+    recent_next_ = 0;
+}
+
+bool LinkMerger::SameSample(const SampleKey& a, const SampleKey& b)
+{
+    // a link never repeats itself: its decoder already dropped repeated binary packets
+    if (a.Link == b.Link || a.RocketMs != b.RocketMs)
+        return false;
+    if (a.Format == FRAME_FORMAT_BINARY && b.Format == FRAME_FORMAT_BINARY)
+        return a.Sequence == b.Sequence;
+    // an ASCII frame has no sequence number; its contents have to do
+    return a.Values == b.Values;
+}
+
+bool LinkMerger::Before(const SampleKey& a, const SampleKey& b)
+{
+    if (a.RocketMs != b.RocketMs)
+        return a.RocketMs < b.RocketMs;
+    if (a.Format == FRAME_FORMAT_BINARY && b.Format == FRAME_FORMAT_BINARY)
+        return (uint16_t)(b.Sequence - a.Sequence) < 0x8000 && a.Sequence != b.Sequence;
+    return a.Ordinal < b.Ordinal;
+}
+
+MergeResult LinkMerger::Push(int link, const TelemetrySample& sample, uint64_t now_ns)
+{
+    // this link's own clock went back: the flight computer restarted, so the merge starts over
+    if (link_seen_[link] && (double)sample.rocketMs < link_time_[link] - config_.RestartSeconds * 1000.0)
+        Reset();
+    bool same_ms = link_seen_[link] && sample.rocketMs == link_time_[link];
+    link_ordinal_[link] = same_ms ? link_ordinal_[link] + 1 : 0;
+    link_seen_[link] = true;
+    link_time_[link] = sample.rocketMs;
+    link_arrival_ns_[link] = now_ns;
+    SampleKey key = { sample.rocketMs, link_ordinal_[link], HashValues(sample), sample.sequence, sample.format, (uint8_t)link };
+
+    if (merged_any_ && key.RocketMs <= last_merged_.RocketMs)
+    {
+        for (size_t i = 0; i < recent_count_; i++)
+        {
+            if (SameSample(recent_[i], key))
+                return MergeResult::Duplicate;
+        }
+        // within the last merged millisecond only a sequence number can tell that one was passed
+        bool binary = key.Format == FRAME_FORMAT_BINARY && last_merged_.Format == FRAME_FORMAT_BINARY;
+        if (key.RocketMs < last_merged_.RocketMs || (binary && !Before(last_merged_, key)))
+            return MergeResult::Late;
+    }
+    for (size_t i = 0; i < held_count_; i++)
+    {
+        if (SameSample(held_[i].Key, key))
+            return MergeResult::Duplicate;
+    }
+
+    if (held_count_ == HOLD_CAPACITY)
+        return MergeResult::Late;
+
+    HeldSample& held = held_[held_count_++];
+    held.Sample = sample;
+    held.Key = key;
+    held.DeadlineNs = now_ns + config_.ReorderWindowMs * 1000000ull;
+    held.Link = link;
+    std::push_heap(held_, held_ + held_count_, LaterSample);
+
+    // full: the earliest held sample goes out now instead of the next one being lost
+    if (held_count_ == HOLD_CAPACITY)
+        held_[0].DeadlineNs = 0;
+    return MergeResult::Held;
+}
+
+bool LinkMerger::Ready(const HeldSample& held, uint64_t now_ns) const
+{
+    if (now_ns >= held.DeadlineNs)
+        return true;
+
+    const SampleKey& key = held.Key;
+    if (merged_any_ && key.Format == FRAME_FORMAT_BINARY && last_merged_.Format == FRAME_FORMAT_BINARY &&
+        key.Sequence == (uint16_t)(last_merged_.Sequence + 1))
+        return true;
+
+    uint64_t timeout_ns = config_.LinkTimeoutMs * 1000000ull;
+    for (int link = 0; link < MAX_LINKS; link++)
+    {
+        if (link == held.Link || !link_seen_[link] || link_arrival_ns_[link] + timeout_ns < now_ns)
+            continue;
+        if (link_time_[link] < key.RocketMs)
+            return false;
+    }
+    return true;
+}
+
+bool LinkMerger::Pop(TelemetrySample& out, uint64_t now_ns)
+{
+    if (held_count_ == 0 || !Ready(held_[0], now_ns))
+        return false;
+
+    std::pop_heap(held_, held_ + held_count_, LaterSample);
+    held_count_--;
+    out = held_[held_count_].Sample;
+
+    merged_any_ = true;
+    last_merged_ = held_[held_count_].Key;
+    recent_[recent_next_] = last_merged_;
+    recent_next_ = (recent_next_ + 1) % RECENT_SAMPLES;
+    recent_count_ = std::min(recent_count_ + 1, RECENT_SAMPLES);
+    return true;
+}
+
+uint64_t LinkMerger::NextDeadlineNs() const
+{
+    return held_count_ == 0 ? UINT64_MAX : held_[0].DeadlineNs;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "telemetrySample.h"
+
+struct LinkMergeConfig
+{
+    uint32_t ReorderWindowMs = 20;  // longest a sample waits for a slower link to catch up
+    uint32_t LinkTimeoutMs = 500;   // a link silent this long no longer holds samples back
+    float RestartSeconds = 1.0f;    // a link's rocket clock stepping back this far is a reboot
+};
+
+enum class MergeResult
+{
+    Held,       // queued; comes out of Pop() in rocket-time order
+    Duplicate,  // a copy of a sample already merged or held, from another radio
+    Late,       // older than the merged stream already is; a slower link lost the race
+};
+
+// Merges the samples of redundant links carrying the same vehicle into one stream, in the order
+// of the rocket's clock, with the copies dropped.
+//
+// A sample is held until no other live link can still deliver an earlier one: every other link
+// has passed its rocket time, it directly follows the last merged binary packet (sequence + 1),
+// or it has waited ReorderWindowMs. With one link nothing is ever held. Samples sharing a rocket
+// millisecond are ordered by packet sequence when both are binary, else by their arrival order on
+// their link. Copies come from different links and match on rocket time, and on the packet
+// sequence when both are binary, else on the channel values.
+//
+// Fixed storage, no allocation; not thread-safe (TelemetryIngest calls it under its merge lock).
+class LinkMerger
+{
+public:
+    static const int MAX_LINKS = 8;
+    static const size_t HOLD_CAPACITY = 256;
+    static const size_t RECENT_SAMPLES = 64;
+
+    explicit LinkMerger(const LinkMergeConfig& config = LinkMergeConfig());
+
+    void SetConfig(const LinkMergeConfig& config) { config_ = config; }
+    void Reset();
+
+    // Call Pop() until it returns false after every Push(); a full hold releases its earliest
+    // sample straight away.
+    MergeResult Push(int link, const TelemetrySample& sample, uint64_t now_ns);
+    // Next sample that can be merged at now_ns; false if none.
+    bool Pop(TelemetrySample& out, uint64_t now_ns);
+    // When the oldest held sample stops waiting for the other links; UINT64_MAX if none is held.
+    uint64_t NextDeadlineNs() const;
+    size_t Held() const { return held_count_; }
+
+private:
+    struct SampleKey
+    {
+        uint32_t RocketMs;
+        uint32_t Ordinal;   // samples its link delivered before it in the same rocket millisecond
+        uint32_t Values;    // hash of the channel values, to match ASCII copies
+        uint16_t Sequence;
+        uint8_t Format;
+        uint8_t Link;
+    };
+
+    struct HeldSample
+    {
+        TelemetrySample Sample;
+        SampleKey Key;
+        uint64_t DeadlineNs;
+        int Link;
+    };
+
+    static bool SameSample(const SampleKey& a, const SampleKey& b);
+    // merge order: rocket time, then sequence (both binary) or ordinal
+    static bool Before(const SampleKey& a, const SampleKey& b);
+    // heap order: the earliest sample on top
+    static bool LaterSample(const HeldSample& a, const HeldSample& b) { return Before(b.Key, a.Key); }
+    bool Ready(const HeldSample& held, uint64_t now_ns) const;
+
+    LinkMergeConfig config_;
+
+    // min-heap on rocket time
+    HeldSample held_[HOLD_CAPACITY];
+    size_t held_count_;
+
+    // per link: last rocket time pushed, how many in that millisecond, and when
+    bool link_seen_[MAX_LINKS];
+    uint32_t link_time_[MAX_LINKS];
+    uint32_t link_ordinal_[MAX_LINKS];
+    uint64_t link_arrival_ns_[MAX_LINKS];
+
+    // the merged stream so far
+    bool merged_any_;
+    SampleKey last_merged_;
+    SampleKey recent_[RECENT_SAMPLES];
+    size_t recent_count_;
+    size_t recent_next_;
+};
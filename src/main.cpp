@@ -20,10 +20,26 @@
 #include <simple-serial-port/simple-serial-port/SimpleSerial.h>
 #include <iostream>
 #include <thread>
-#include <future>
 #include <algorithm>
 #include <fstream>
 #include <list>
+#include <future>
+#include <memory>
+#include <vector>
+#include "clockAlignment.h"
+#include "derivedChannels.h"
+#include "flightArchive.h"
+#include "flightRecorder.h"
+#include "framePacer.h"
+#include "latencyHistogram.h"
+#include "telemetryCsv.h"
+#include "replaySource.h"
+#include "samplePublisher.h"
+#include "serialSource.h"
+#include "sharedSampleRing.h"
+#include "storeFeed.h"
+#include "telemetryIngest.h"
+#include "telemetryStore.h"
 #ifdef _DEBUG
 #define DX12_ENABLE_DEBUG_LAYER
 #endif
@@ -33,35 +49,24 @@
 #pragma comment(lib, "dxguid.lib")
 #endif
 
-// Serial task masks
-#define SEND_ENABLE 1
-#define SEND_DISABLE 2
-#define READ_SERIAL 4
-
-uint8_t passedSerialParams = 0;
-
-
 struct FrameContext
 {
     ID3D12CommandAllocator* CommandAllocator;
     UINT64                  FenceValue;
 };
 
-struct RollingBuffer {
-    float Span;
-    ImVector<ImVec2> Data;
-    RollingBuffer() {
-        Span = 10.0f;
-        Data.reserve(2000);
-    }
-    void AddPoint(float x, float y) {
-        float xmod = fmodf(x, Span);
-        if (!Data.empty() && xmod < Data.back().x)
-            Data.shrink(0);
-        Data.push_back(ImVec2(xmod, y));
-    }
+// Latency of each step a sample takes from the serial read to the screen
+enum LatencyStage
+{
+    LatencyStage_Parse,     // read returned -> frame decoded
+    LatencyStage_Store,     // decoded -> appended to the flight store and published by the store feed
+    LatencyStage_Draw,      // stored -> first presented frame that includes it
+    LatencyStage_Total,     // read returned -> presented
+    LatencyStage_COUNT
 };
 
+static const char* LATENCY_STAGE_NAMES[LatencyStage_COUNT] = { "Read -> parsed", "Parsed -> stored", "Stored -> drawn", "Read -> drawn" };
+
 // Data
 static int const                    NUM_FRAMES_IN_FLIGHT = 3;
 static FrameContext                 g_frameContext[NUM_FRAMES_IN_FLIGHT] = {};
@@ -88,20 +93,27 @@ void CreateRenderTarget();
 void CleanupRenderTarget();
 void WaitForLastSubmittedFrame();
 void LinkedText(bool active, char text[]);
-float vecMag(float a, float b, float c);
-
-string serialCommTasks();
-string GetSerialData();
-void payloadReleaseEnable();
-void payloadReleaseDisable();
+void PlotColumn(const char* label, const StoreSnapshot& store, int column, size_t first);
+void PlotChannels(PlotGroup group, const StoreSnapshot& store, size_t first);
+void PlotArchiveColumn(const char* label, const FlightArchive& archive, int column, double xMin, double xMax);
+void PlotFlightEvents(const TelemetryIngest& ingest);
+void SetupAutoscaleY(PlotGroup group, const ChannelSummary* summaries, AxisAutoscale& axis, float dt);
+void ShowChannelReadout(const ChannelSummary* summaries, float sampleRate);
+void ShowUplinkCommands(const CommandUplink& uplink);
+void ShowLinkHealth(const TelemetryIngest& ingest);
 
 FrameContext* WaitForNextFrameResources();
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-char com_port[] = "\\\\.\\COM5";
-DWORD COM_BAUD_RATE = CBR_9600;
-SimpleSerial Serial(com_port, COM_BAUD_RATE);
+ReplaySource Replay;
+TelemetryIngest Ingest;
+FlightRecorder Recorder;
+SamplePublisher Publisher;
+SharedSampleWriter SharedRing;
 
+static const char FLIGHT_JOURNAL_PATH[] = "flight.tvj";
+static const char FLIGHT_CSV_PATH[] = "data.csv";
+static const char FLIGHT_ARCHIVE_PATH[] = "flight.tva";
 
 
 // Main code
@@ -171,60 +183,124 @@ int main(int, char**)
     bool show_orientation = false;
     bool show_acceleration = false;
     bool show_velocity = false;
-    bool logData = false;
-
-    string lastData = "Data:00:00:00:00:00:00:00:00:00:00:00:00:";
-    float lastNum1 = 0;
-    float lastNum2 = 0;
-
-    std::ofstream dataFile;
-    dataFile.open("data.csv");
-    dataFile << "x orientatuin, y orientation, z orientation, x acceleration, y acceleration, z acceleration, x velocity, y velocity, z velocity, time";
-    
-
-    uint8_t state = 0;
+    bool logData = true;
+    bool show_latency = false;
+    bool show_archive = false;
+    bool show_replay = true;
+    bool show_links = true;
+
+    // CSV export runs off the UI thread; -2 = not run yet
+    std::future<long long> csvExport;
+    long long csvRows = -2;
+
+    // archive viewer; export from the journal also runs off the UI thread
+    static FlightArchive archive;
+    static char archivePath[260] = "flight.tva";
+    static double archiveOpenMs = 0.0;
+    static double archiveXMin = 0.0, archiveXMax = 1.0;
+    std::future<long long> archiveExport;
+    long long archiveSamples = -2;
 
     ImVec4 clear_color = ImVec4(0.4f, 0.35f, 0.7f, 1.00f);
 
-    // graph data points
-    static RollingBuffer altitude;
-    altitude.AddPoint(0, 0);
-    static RollingBuffer xOrient;
-    xOrient.AddPoint(0, 0);
-    static RollingBuffer yOrient;
-    yOrient.AddPoint(0, 0);
-    static RollingBuffer zOrient;
-    zOrient.AddPoint(0, 0);
-    static RollingBuffer xAccel;
-    xAccel.AddPoint(0, 0);
-    static RollingBuffer yAccel;
-    yAccel.AddPoint(0, 0);
-    static RollingBuffer zAccel;
-    zAccel.AddPoint(0, 0);
-    static RollingBuffer AccelerationMagnitude;
-    AccelerationMagnitude.AddPoint(0, 0);
-    static RollingBuffer xMag;
-    xMag.AddPoint(0, 0);
-    static RollingBuffer yMag;
-    yMag.AddPoint(0, 0);
-    static RollingBuffer zMag;
-    zMag.AddPoint(0, 0);
-
-    static RollingBuffer force;
-    force.AddPoint(0, 0);
-    static RollingBuffer temp;
-    temp.AddPoint(0, 0);
-    static RollingBuffer time;
-    time.AddPoint(0, 0);
-
-    std::future<string> dataThread = std::async(GetSerialData);
-    uint8_t serialActions = 0;
+    // graph data points for the whole flight, one column per COLUMNS entry (raw channels, then derived),
+    // filled by the store feed thread; frames draw from its latest published snapshot
+    static TelemetryStore flightStore(STORE_COLUMN_COUNT);
+    static StoreFeed storeFeed(Ingest, flightStore);
+
+    // latency stamps of samples in the snapshot being drawn, and the histograms they feed
+    static ImVector<SampleStamps> undrawnStamps;
+    static LatencyHistogram latency[LatencyStage_COUNT];
+
+    // Y axes follow the feed's sliding-window min/max of the channels each plot draws
+    static AxisAutoscale overviewAxis, altitudeAxis, velocityAxis, orientationAxis, accelerationAxis;
+
+    // frames follow the display while data or input arrive and drop to an idle rate otherwise;
+    // every store publish signals publishEvent to wake the loop
+    static FramePacer pacer;
+    static uint64_t pacedSamples = 0;
+    HANDLE publishEvent = ::CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    storeFeed.SetPublishCallback([publishEvent]() { ::SetEvent(publishEvent); });
+
+    // Serial links (redundant radios on one vehicle), opened here rather than during static
+    // initialization; the Links window adds more while ingest runs
+    static std::vector<std::unique_ptr<SerialSource>> serialLinks;
+    static char linkPort[64] = "COM5";
+    static int linkBaud = CBR_9600;
+    static bool linkOpenFailed = false;
+    serialLinks.emplace_back(new SerialSource(linkPort, (DWORD)linkBaud));
+    auto serialConnected = [&]()
+    {
+        for (const std::unique_ptr<SerialSource>& link : serialLinks)
+        {
+            if (link->Connected())
+                return true;
+        }
+        return false;
+    };
+
+    // Restarts ingest on another source (nullptr: every open serial link) and forgets everything
+    // drawn from the previous one. Both threads are stopped and no store Reader is held here, so
+    // the UI thread may clear the store.
+    auto switchSource = [&](TelemetrySource* source, FlightRecorder* recorder)
+    {
+        Ingest.Stop();
+        storeFeed.Stop();
+        TelemetrySample discarded[64];
+        while (Ingest.Drain(discarded, IM_ARRAYSIZE(discarded)) > 0)
+            ;
+        SampleStamps stamps[64];
+        while (storeFeed.DrainStamps(stamps, IM_ARRAYSIZE(stamps)) > 0)
+            ;
+        flightStore.Clear();
+        undrawnStamps.resize(0);
+        overviewAxis.Reset();
+        altitudeAxis.Reset();
+        velocityAxis.Reset();
+        orientationAxis.Reset();
+        accelerationAxis.Reset();
+        Ingest.SetSource(source);
+        for (size_t link = 0; !source && link < serialLinks.size(); link++)
+        {
+            if (serialLinks[link]->Connected())
+                Ingest.AddLink(serialLinks[link].get());
+        }
+        Ingest.SetRecorder(recorder);
+        Ingest.SetPublisher(&Publisher);
+        Ingest.SetSharedRing(&SharedRing);
+        Ingest.Start();
+        if (Ingest.Running())
+            storeFeed.Start();
+    };
+
+    // replay controls
+    static char replayPath[260] = "flight.tvj";
+    static const char* REPLAY_SPEED_NAMES[] = { "1x", "2x", "5x", "10x", "50x", "As fast as possible" };
+    static const double REPLAY_SPEEDS[] = { 1.0, 2.0, 5.0, 10.0, 50.0, 0.0 };
+    static int replaySpeed = 0;
+    static float replaySeekSeconds = 0.0f;
+    static bool replaySeekDragging = false;
+    static bool replayLoadFailed = false;
+
+    // analysis processes on this machine follow the decoded stream here (see telemetrytap)
+    SharedRing.Open(SHARED_RING_DEFAULT_NAME);
+
+    if (serialConnected())
+    {
+        Recorder.Start(FLIGHT_JOURNAL_PATH);
+        switchSource(nullptr, &Recorder);
+    }
 
     // Main loop
     bool done = false;
 
     while (!done)
     {
+        // Nothing changing: sleep until input, a store publish or the next idle redraw
+        uint32_t waitMs = pacer.WaitMs(MonotonicNanoseconds());
+        if (waitMs > 0)
+            ::MsgWaitForMultipleObjects(1, &publishEvent, FALSE, waitMs, QS_ALLINPUT);
+
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
         MSG msg;
@@ -234,10 +310,18 @@ int main(int, char**)
             ::DispatchMessage(&msg);
             if (msg.message == WM_QUIT)
                 done = true;
+            pacer.Activity(MonotonicNanoseconds());
         }
         if (done)
             break;
 
+        uint64_t samplesStored = storeFeed.SamplesStored();
+        if (samplesStored != pacedSamples)
+        {
+            pacedSamples = samplesStored;
+            pacer.Activity(MonotonicNanoseconds());
+        }
+
         // Start the Dear ImGui frame
         ImGui_ImplDX12_NewFrame();
         ImGui_ImplWin32_NewFrame();
@@ -247,90 +331,46 @@ int main(int, char**)
         if (show_demo_window)
             ImGui::ShowDemoWindow(&show_demo_window);
 
-        // serial communication
-        if (Serial.connected_) {
+        // serial communication or replay
+        if (Ingest.Running()) {
 
             ImGui::Begin("Rocket Altitude", &show_telemetry);
-            ImGui::Text("Arduino is connected :)");
-
-            string incoming = "nothin";
-
-            if (dataThread._Is_ready())
+            if (Ingest.Source() == &Replay)
+                ImGui::Text("Replaying %s", replayPath);
+            else
+                ImGui::Text(Ingest.LinkCount() > 1 ? "Arduino is connected over %d links :)" : "Arduino is connected :)", Ingest.LinkCount());
+
+            // The store feed derives and stores samples as they are decoded; draw this frame from its
+            // latest snapshot. Stamps are pushed after their publish, so taking them first means every
+            // one belongs to a sample in the snapshot.
+            SampleStamps stamps[256];
+            size_t stampCount;
+            while ((stampCount = storeFeed.DrainStamps(stamps, IM_ARRAYSIZE(stamps))) > 0)
             {
-                incoming = dataThread.get();
-                passedSerialParams = serialActions |= READ_SERIAL; // always read serial
-                dataThread = std::async(serialCommTasks);
+                for (size_t i = 0; i < stampCount; i++)
+                    undrawnStamps.push_back(stamps[i]);
             }
-                
-            // multithreading:
-            // 1. start reading serial port near program start with thread that returns the string
-            // 2. check if thread has finished
-            // 3. if finished, use value returned as data and start new thread listening for data
-            // 4. if not finished, continue and do not update data.
-            // "Data:" + String(recieveData.data.xG) + ":"
-            /*+String(recieveData.data.yG) + ":"
-                + String(recieveData.data.zG) + ":"
-                + String(recieveData.data.xA) + ":"
-                + String(recieveData.data.yA) + ":"
-                + String(recieveData.data.zA) + ":"
-                + String(recieveData.data.xM) + ":"
-                + String(recieveData.data.yM) + ":"
-                + String(recieveData.data.zM) + ":"
-                + String(recieveData.data.f) + ":"
-                + String(recieveData.data.t) + ":"
-                + String(recieveData.data.time) + ":"
-                + String(recieveData.data.alt) + ":"
-            */
-
-            
-            if (count(incoming.begin(), incoming.end(), ':') >= 13)
+            TelemetryStore::Reader storeReader(flightStore);
+            const StoreSnapshot& store = storeReader.Snapshot();
+
+            // window statistics as of the feed's last batch; they lead the snapshot by at most that batch
+            ChannelSummary summaries[STORE_COLUMN_COUNT];
+            float sampleRate = storeFeed.ChannelSummaries(summaries);
+            ShowChannelReadout(summaries, sampleRate);
+            ImGui::Text("Frames decoded: %llu  rejected: %llu (last: %s)  lost: %llu  dropped: %llu  store full: %llu",
+                (unsigned long long)Ingest.FramesDecoded(), (unsigned long long)Ingest.FramesRejected(),
+                ParseStatusName(Ingest.LastRejectReason()), (unsigned long long)Ingest.PacketsLost(),
+                (unsigned long long)Ingest.FramesDropped(), (unsigned long long)storeFeed.SamplesRejected());
+            ImGui::Text("Merge: %llu copies, %llu late", (unsigned long long)Ingest.MergeDuplicates(),
+                (unsigned long long)Ingest.MergeLate());
+            ImGui::Text("Journal %s: %llu records written, %llu dropped, %llu recovered%s", FLIGHT_JOURNAL_PATH,
+                (unsigned long long)Recorder.RecordsWritten(), (unsigned long long)Recorder.RecordsDropped(),
+                (unsigned long long)Recorder.RecoveredRecords(), Recorder.WriteFailed() ? " (write failed)" : "");
+            if (store.SealedSamples() > 0)
             {
-                lastData = incoming;  
-                if (lastData.length() >= 10)
-                {
-                    int delimiterPositions[16];
-                    delimiterPositions[0] = lastData.find_first_of(':');
-
-                    for (int i = 1; i < 16; i++)
-                    {
-                        delimiterPositions[i] = lastData.find(':', delimiterPositions[i-1] + 1);
-                    }
-
-                    int currentTime = ImGui::GetTime();
-
-                    xOrient.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[1] + 1, delimiterPositions[2] - 1)) / 1.0f);
-                    yOrient.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[2] + 1, delimiterPositions[3] - 1)) / 1.0f);
-                    zOrient.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[3] + 1, delimiterPositions[4] - 1)) / 1.0f);
-                    xAccel.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[4] + 1, delimiterPositions[5] - 1)) / 1.0f);
-                    yAccel.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[5] + 1, delimiterPositions[6] - 1)) / 1.0f);
-                    zAccel.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[6] + 1, delimiterPositions[7] - 1)) / 1.0f);
-                    xMag.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[7] + 1, delimiterPositions[8] - 1)) / 1.0f);
-                    yMag.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[8] + 1, delimiterPositions[9] - 1)) / 1.0f);
-                    zMag.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[9] + 1, delimiterPositions[10] - 1)) / 1.0f);
-
-                    AccelerationMagnitude.AddPoint(currentTime, vecMag(xAccel.Data.back()[0], yAccel.Data.back()[0], zAccel.Data.back()[0]));
-
-                    force.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[10] + 1, delimiterPositions[11] - 1)) / 1.0f);
-                    temp.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[11] + 1, delimiterPositions[12] - 1)) / 1.0f);
-                    time.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[12] + 1, delimiterPositions[13] - 1)) / 1.0f);
-
-                    altitude.AddPoint(currentTime, stoi(lastData.substr(delimiterPositions[14] + 1, delimiterPositions[15])) / 1.0f);
-
-                    if (logData)
-                    {
-                        // save data to csv file
-                        dataFile << xOrient.Data.back().x;
-                        dataFile << yOrient.Data.back().x;
-                        dataFile << zOrient.Data.back().x;
-                        dataFile << xAccel.Data.back().x;
-                        dataFile << yAccel.Data.back().x;
-                        dataFile << zAccel.Data.back().x;
-                    }
-                }
+                ImGui::Text("History: %zu samples compressed to %.1f MB (%.2f bytes/value)", store.SealedSamples(),
+                    store.CompressedBytes() / (1024.0 * 1024.0), (double)store.CompressedBytes() / ((double)store.SealedSamples() * STORE_COLUMN_COUNT));
             }
-            
-            ImGui::Text(lastData.c_str());
-            ImGui::Text(to_string(lastNum1).c_str());
 
             if (ImGui::BeginTable("split", 2))
             {
@@ -351,17 +391,23 @@ int main(int, char**)
 
                 static ImPlotAxisFlags flags = ImPlotAxisFlags_NoTickLabels;
                 static float history = 20.0f;
-                altitude.Span = history;
+                if (ImGui::SliderFloat("History (s)", &history, 1.0f, 120.0f, "%.0f"))
+                    storeFeed.SetStatsWindow(history);
+
+                // plots scroll over the last `history` seconds; start one sample early so the line reaches the left edge
+                float latestTime = store.Empty() ? 0.0f : store.Time(store.Size() - 1);
+                size_t windowStart = store.LowerBound(latestTime - history);
+                if (windowStart > 0)
+                    windowStart--;
 
                 if (show_overview)
                 {
                     if (ImPlot::BeginPlot("Overview", ImVec2(-1, 300))) {
                         ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
-                        ImPlot::SetupAxisLimits(ImAxis_X1, 0, history, ImGuiCond_Always);
-                        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
-                        ImPlot::PlotLine("Altitude", &altitude.Data[0].x, &altitude.Data[0].y, altitude.Data.size(), 0, 0, 2 * sizeof(float));
-                        //ImPlot::PlotLine("Velocity", &velMag.Data[0].x, &velMag.Data[0].y, velMag.Data.size(), 0, 0, 2 * sizeof(float));
-                        ImPlot::PlotLine("Acceleration", &AccelerationMagnitude.Data[0].x, &AccelerationMagnitude.Data[0].y, AccelerationMagnitude.Data.size(), 0, 0, 2 * sizeof(float));
+                        ImPlot::SetupAxisLimits(ImAxis_X1, latestTime - history, latestTime, ImGuiCond_Always);
+                        SetupAutoscaleY(PlotGroup_Overview, summaries, overviewAxis, io.DeltaTime);
+                        PlotChannels(PlotGroup_Overview, store, windowStart);
+                        PlotFlightEvents(Ingest);
                         ImPlot::EndPlot();
                     }
                 }
@@ -370,9 +416,9 @@ int main(int, char**)
                 {
                     if (ImPlot::BeginPlot("Altiude", ImVec2(-1, 300))) {
                         ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
-                        ImPlot::SetupAxisLimits(ImAxis_X1, 0, history, ImGuiCond_Always);
-                        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
-                        ImPlot::PlotLine("Rocket Alt", &altitude.Data[0].x, &altitude.Data[0].y, altitude.Data.size(), 0, 0, 2 * sizeof(float));
+                        ImPlot::SetupAxisLimits(ImAxis_X1, latestTime - history, latestTime, ImGuiCond_Always);
+                        SetupAutoscaleY(PlotGroup_Altitude, summaries, altitudeAxis, io.DeltaTime);
+                        PlotChannels(PlotGroup_Altitude, store, windowStart);
                         ImPlot::EndPlot();
                     }
                 }
@@ -381,11 +427,9 @@ int main(int, char**)
                 {
                     if (ImPlot::BeginPlot("Velocity", ImVec2(-1, 300))) {
                         ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
-                        ImPlot::SetupAxisLimits(ImAxis_X1, 0, history, ImGuiCond_Always);
-                        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
-                        //ImPlot::PlotLine("N-S Speed", &xVel.Data[0].x, &xVel.Data[0].y, xVel.Data.size(), 0, 0, 2 * sizeof(float));
-                        //ImPlot::PlotLine("E-W Speed", &yVel.Data[0].x, &yVel.Data[0].y, yVel.Data.size(), 0, 0, 2 * sizeof(float));
-                        //ImPlot::PlotLine("Veritcal Speed", &zVel.Data[0].x, &zVel.Data[0].y, zVel.Data.size(), 0, 0, 2 * sizeof(float));
+                        ImPlot::SetupAxisLimits(ImAxis_X1, latestTime - history, latestTime, ImGuiCond_Always);
+                        SetupAutoscaleY(PlotGroup_Velocity, summaries, velocityAxis, io.DeltaTime);
+                        PlotChannels(PlotGroup_Velocity, store, windowStart);
                         ImPlot::EndPlot();
                     }
                 }
@@ -394,11 +438,9 @@ int main(int, char**)
                 {
                     if (ImPlot::BeginPlot("Orientation", ImVec2(-1, 150))) {
                         ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
-                        ImPlot::SetupAxisLimits(ImAxis_X1, 0, history, ImGuiCond_Always);
-                        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
-                        ImPlot::PlotLine("X Orientation", &xOrient.Data[0].x, &xOrient.Data[0].y, xOrient.Data.size(), 0, 0, 2 * sizeof(float));
-                        ImPlot::PlotLine("Y Orientation", &yOrient.Data[0].x, &yOrient.Data[0].y, yOrient.Data.size(), 0, 0, 2 * sizeof(float));
-                        ImPlot::PlotLine("Z Orientation", &zOrient.Data[0].x, &zOrient.Data[0].y, zOrient.Data.size(), 0, 0, 2 * sizeof(float));
+                        ImPlot::SetupAxisLimits(ImAxis_X1, latestTime - history, latestTime, ImGuiCond_Always);
+                        SetupAutoscaleY(PlotGroup_Orientation, summaries, orientationAxis, io.DeltaTime);
+                        PlotChannels(PlotGroup_Orientation, store, windowStart);
                         ImPlot::EndPlot();
                     }
                 }
@@ -407,18 +449,18 @@ int main(int, char**)
                 {
                     if (ImPlot::BeginPlot("Acceleration", ImVec2(-1, 150))) {
                         ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
-                        ImPlot::SetupAxisLimits(ImAxis_X1, 0, history, ImGuiCond_Always);
-                        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
-                        ImPlot::PlotLine("X Acceleration", &xAccel.Data[0].x, &xAccel.Data[0].y, xAccel.Data.size(), 0, 0, 2 * sizeof(float));
-                        ImPlot::PlotLine("Y Acceleration", &yAccel.Data[0].x, &yAccel.Data[0].y, yAccel.Data.size(), 0, 0, 2 * sizeof(float));
-                        ImPlot::PlotLine("Z Acceleration", &zAccel.Data[0].x, &zAccel.Data[0].y, zAccel.Data.size(), 0, 0, 2 * sizeof(float));
+                        ImPlot::SetupAxisLimits(ImAxis_X1, latestTime - history, latestTime, ImGuiCond_Always);
+                        SetupAutoscaleY(PlotGroup_Acceleration, summaries, accelerationAxis, io.DeltaTime);
+                        PlotChannels(PlotGroup_Acceleration, store, windowStart);
                         ImPlot::EndPlot();
                     }
                 }
                 ImGui::TableNextColumn();
 
-                // rocket state table
-                
+                // rocket state table, from the phase detector on the ingest thread
+                FlightPhase phase = Ingest.Phase();
+                uint32_t events = Ingest.FlightEvents();
+                bool pastApogee = events & (1u << FlightEvent_Apogee);
 
                 char onPad[] = "On Pad";
                 char launched[] = "Launched";
@@ -429,23 +471,60 @@ int main(int, char**)
                 char mainDep[] = "Main Deployed";
                 char landed[] = "Landed";
 
-                LinkedText(state & 0x80, onPad);
-                LinkedText(state & 0x40, launched);
-                LinkedText(state & 0x20, apogee);
-                LinkedText(state & 0x10, asc);
-                LinkedText(state & 0x08, desc);
-                LinkedText(state & 0x04, drgDepl);
-                LinkedText(state & 0x02, mainDep);
-                LinkedText(state & 0x01, landed);
+                LinkedText(phase == FlightPhase_Pad, onPad);
+                LinkedText(events & (1u << FlightEvent_Launch), launched);
+                LinkedText(pastApogee, apogee);
+                LinkedText((phase == FlightPhase_Boost || phase == FlightPhase_Coast) && !pastApogee, asc);
+                LinkedText(pastApogee && phase != FlightPhase_Landed, desc);
+                LinkedText(events & (1u << FlightEvent_Drogue), drgDepl);
+                LinkedText(events & (1u << FlightEvent_Main), mainDep);
+                LinkedText(phase == FlightPhase_Landed, landed);
+
+                // each event at the sample that triggered it, relative to launch, and how long the
+                // detector's hold took to confirm it
+                FlightEventRecord launch;
+                if (Ingest.FlightEventRecorded(FlightEvent_Launch, launch))
+                {
+                    for (int event = 0; event < FlightEvent_COUNT; event++)
+                    {
+                        FlightEventRecord record;
+                        if (Ingest.FlightEventRecorded((FlightEvent)event, record))
+                            ImGui::TextDisabled("%s T+%.2f s (+%.0f ms)", FLIGHT_EVENT_NAMES[event], record.RocketTime - launch.RocketTime,
+                                (record.ConfirmedRocketTime - record.RocketTime) * 1000.0);
+                    }
+                }
+
+                // Rocket enable button; commands jump the queue and interrupt the link thread's read
+                if (ImGui::Button(UPLINK_COMMANDS[UplinkCommand_ReleasePayload].Name))
+                    Ingest.SendCommand(UplinkCommand_ReleasePayload);
+
+                if (ImGui::Button(UPLINK_COMMANDS[UplinkCommand_CancelRelease].Name))
+                    Ingest.SendCommand(UplinkCommand_CancelRelease);
+                ImGui::SameLine();
+                if (ImGui::SmallButton(UPLINK_COMMANDS[UplinkCommand_Ping].Name))
+                    Ingest.SendCommand(UplinkCommand_Ping);
 
-                // Rocket enable button
-                if (ImGui::Button("Release Payload"))
-                    serialActions |= SEND_ENABLE;
+                ShowUplinkCommands(Ingest.Uplink());
 
-                if (ImGui::Button("Cancel Release"))
-                   serialActions |= SEND_DISABLE;
+                if (ImGui::Checkbox("Enable Logging", &logData))
+                    Recorder.SetEnabled(logData);
 
-                ImGui::Checkbox("Enable Logging", &logData);
+                bool exporting = csvExport.valid();
+                if (exporting && csvExport.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                {
+                    csvRows = csvExport.get();
+                    exporting = false;
+                }
+                if (ImGui::Button(exporting ? "Exporting..." : "Export CSV") && !exporting)
+                    csvExport = std::async(std::launch::async, ExportJournalCsv, std::string(FLIGHT_JOURNAL_PATH), std::string(FLIGHT_CSV_PATH));
+                if (csvRows >= 0)
+                    ImGui::Text("%lld rows in %s", csvRows, FLIGHT_CSV_PATH);
+                else if (csvRows == -1)
+                    ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Export failed");
+
+                ImGui::Checkbox("Show Latency", &show_latency);
+                ImGui::Checkbox("Show Archive", &show_archive);
+                ImGui::Checkbox("Show Links", &show_links);
 
                 ImGui::EndTable();
             }
@@ -496,6 +575,247 @@ int main(int, char**)
             ImGui::End();
         }
 
+        // Latency from serial read to screen, per stage
+        if (show_latency)
+        {
+            ImGui::Begin("Latency", &show_latency);
+            if (ImGui::BeginTable("latency", 5, ImGuiTableFlags_Borders))
+            {
+                ImGui::TableSetupColumn("Stage");
+                ImGui::TableSetupColumn("p50 (ms)");
+                ImGui::TableSetupColumn("p99 (ms)");
+                ImGui::TableSetupColumn("max (ms)");
+                ImGui::TableSetupColumn("samples");
+                ImGui::TableHeadersRow();
+                for (int stage = 0; stage < LatencyStage_COUNT; stage++)
+                {
+                    const LatencyHistogram& histogram = latency[stage];
+                    ImGui::TableNextColumn(); ImGui::Text("%s", LATENCY_STAGE_NAMES[stage]);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", histogram.Percentile(0.50) * 1e-6);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", histogram.Percentile(0.99) * 1e-6);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", histogram.Max() * 1e-6);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)histogram.Count());
+                }
+                ImGui::EndTable();
+            }
+            if (ImGui::Button("Reset"))
+            {
+                for (LatencyHistogram& histogram : latency)
+                    histogram.Reset();
+            }
+
+            ImGui::Text("Frames: %d/s, %s", pacer.FramesPerSecond(), pacer.Idle(MonotonicNanoseconds()) ? "idle" : "live");
+
+            ClockAlignment rocketClock = storeFeed.RocketClock();
+            if (rocketClock.Valid())
+                ImGui::Text("Rocket clock: host = rocket %+.3f s, drift %+.1f ppm, restarts %llu",
+                    rocketClock.Offset(), rocketClock.DriftPpm(), (unsigned long long)rocketClock.Restarts());
+            else
+                ImGui::TextDisabled("Rocket clock: waiting for samples");
+            ImGui::End();
+        }
+
+        // Recorded flights, opened by mmap and drawn from the archive's summaries
+        if (show_archive)
+        {
+            ImGui::Begin("Flight Archive", &show_archive);
+            ImGui::InputText("File", archivePath, IM_ARRAYSIZE(archivePath));
+            ImGui::SameLine();
+            if (ImGui::Button("Open"))
+            {
+                uint64_t openStart = MonotonicNanoseconds();
+                if (archive.Open(archivePath))
+                {
+                    archiveOpenMs = (MonotonicNanoseconds() - openStart) * 1e-6;
+                    archiveXMin = archive.StartTime();
+                    archiveXMax = archive.EndTime() > archive.StartTime() ? archive.EndTime() : archive.StartTime() + 1.0;
+                }
+            }
+
+            bool exporting = archiveExport.valid();
+            if (exporting && archiveExport.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                archiveSamples = archiveExport.get();
+                exporting = false;
+            }
+            if (ImGui::Button(exporting ? "Exporting..." : "Export Journal to Archive") && !exporting)
+            {
+                archive.Close();
+                archiveExport = std::async(std::launch::async, ExportJournalArchive, std::string(FLIGHT_JOURNAL_PATH), std::string(archivePath));
+            }
+            if (archiveSamples >= 0)
+            {
+                ImGui::SameLine();
+                ImGui::Text("%lld samples exported", archiveSamples);
+            }
+            else if (archiveSamples == -1)
+            {
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Export failed");
+            }
+
+            if (archive.IsOpen())
+            {
+                ImGui::Text("%llu samples, %.1f s, opened in %.2f ms", (unsigned long long)archive.SampleCount(),
+                    archive.EndTime() - archive.StartTime(), archiveOpenMs);
+
+                static const PlotGroup ARCHIVE_GROUPS[] = { PlotGroup_Overview, PlotGroup_Altitude, PlotGroup_Velocity, PlotGroup_Orientation, PlotGroup_Acceleration };
+                static const char* ARCHIVE_GROUP_TITLES[] = { "Overview##archive", "Altitude##archive", "Velocity##archive", "Orientation##archive", "Acceleration##archive" };
+                for (int i = 0; i < IM_ARRAYSIZE(ARCHIVE_GROUPS); i++)
+                {
+                    if (ImPlot::BeginPlot(ARCHIVE_GROUP_TITLES[i], ImVec2(-1, 200)))
+                    {
+                        ImPlot::SetupAxes(nullptr, nullptr, 0, ImPlotAxisFlags_AutoFit);
+                        ImPlot::SetupAxisLinks(ImAxis_X1, &archiveXMin, &archiveXMax);
+                        ImPlotRect limits = ImPlot::GetPlotLimits();
+                        for (int c = 0; c < STORE_COLUMN_COUNT; c++)
+                        {
+                            int column = archive.FindColumn(COLUMNS[c].id);
+                            if ((COLUMNS[c].plotGroups & ARCHIVE_GROUPS[i]) && column >= 0)
+                                PlotArchiveColumn(COLUMNS[c].label, archive, column, limits.X.Min, limits.X.Max);
+                        }
+                        ImPlot::EndPlot();
+                    }
+                }
+            }
+            else
+                ImGui::TextDisabled("No archive open");
+            ImGui::End();
+        }
+
+        // Replay a recorded journal through the live decode, store and plot path
+        if (show_replay)
+        {
+            ImGui::Begin("Replay", &show_replay);
+            bool replaying = Ingest.Running() && Ingest.Source() == &Replay;
+
+            ImGui::InputText("Journal", replayPath, IM_ARRAYSIZE(replayPath));
+            ImGui::SameLine();
+            if (ImGui::Button("Load"))
+            {
+                if (replaying)
+                    Ingest.Stop();
+                replayLoadFailed = !Replay.Load(replayPath);
+                if (!replayLoadFailed)
+                {
+                    Replay.SetSpeed(REPLAY_SPEEDS[replaySpeed]);
+                    switchSource(&Replay, nullptr);
+                }
+                // only a replay stopped above goes back to serial; a live session was never touched
+                else if (replaying && serialConnected())
+                    switchSource(nullptr, &Recorder);
+            }
+            if (replayLoadFailed)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Could not load %s", replayPath);
+            if (replaying && serialConnected())
+            {
+                ImGui::SameLine();
+                if (ImGui::Button("Back to Serial"))
+                    switchSource(nullptr, &Recorder);
+            }
+
+            if (Replay.Connected())
+            {
+                if (ImGui::Combo("Speed", &replaySpeed, REPLAY_SPEED_NAMES, IM_ARRAYSIZE(REPLAY_SPEED_NAMES)))
+                    Replay.SetSpeed(REPLAY_SPEEDS[replaySpeed]);
+
+                bool paused = Replay.Paused();
+                if (ImGui::Checkbox("Pause", &paused))
+                    Replay.SetPaused(paused);
+
+                float durationSeconds = Replay.DurationNs() * 1e-9f;
+                if (!replaySeekDragging)
+                    replaySeekSeconds = Replay.PositionNs() * 1e-9f;
+                ImGui::SliderFloat("Position (s)", &replaySeekSeconds, 0.0f, durationSeconds, "%.1f");
+                replaySeekDragging = ImGui::IsItemActive();
+                if (ImGui::IsItemDeactivatedAfterEdit() && replaying)
+                {
+                    Ingest.Stop();
+                    Replay.Seek((uint64_t)(replaySeekSeconds * 1e9));
+                    switchSource(&Replay, nullptr);
+                }
+
+                if (Replay.Finished() && Replay.RunSeconds() > 0)
+                    ImGui::Text("Finished in %.2f s: %.0f frames/s, %.2f MB/s", Replay.RunSeconds(),
+                        Ingest.FramesDecoded() / Replay.RunSeconds(), Replay.BytesReplayed() / Replay.RunSeconds() * 1e-6);
+                else
+                    ImGui::Text("%.1f / %.1f s, %llu frames", Replay.PositionNs() * 1e-9, durationSeconds,
+                        (unsigned long long)Ingest.FramesDecoded());
+                if (Replay.CommandsIgnored())
+                    ImGui::TextDisabled("%llu uplink commands not sent during replay", (unsigned long long)Replay.CommandsIgnored());
+            }
+            ImGui::End();
+        }
+
+        // Redundant serial links; a new one joins the running merge straight away
+        if (show_links)
+        {
+            ImGui::Begin("Links", &show_links);
+            bool replaying = Ingest.Running() && Ingest.Source() == &Replay;
+
+            ImGui::InputText("Port", linkPort, IM_ARRAYSIZE(linkPort));
+            ImGui::InputInt("Baud", &linkBaud, 0);
+            if (ImGui::Button("Add link"))
+            {
+                std::unique_ptr<SerialSource> link(new SerialSource(linkPort, (DWORD)linkBaud));
+                linkOpenFailed = !link->Connected() || Ingest.LinkCount() >= TelemetryIngest::MAX_LINKS;
+                if (!linkOpenFailed)
+                {
+                    serialLinks.push_back(std::move(link));
+                    if (Ingest.Running() && !replaying)
+                        Ingest.AddLink(serialLinks.back().get());
+                    else if (!Ingest.Running())
+                    {
+                        if (!Recorder.Running())
+                            Recorder.Start(FLIGHT_JOURNAL_PATH);
+                        switchSource(nullptr, &Recorder);
+                    }
+                }
+            }
+            if (linkOpenFailed)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Could not open %s", linkPort);
+
+            if (replaying)
+                ImGui::TextDisabled("%d serial links wait while replaying", (int)serialLinks.size());
+            else
+                ShowLinkHealth(Ingest);
+
+            // decoded samples for the tracker and other tools: multicast on loopback, WebSocket on 127.0.0.1
+            ImGui::Separator();
+            bool publishing = Publisher.Running();
+            if (ImGui::Checkbox("Publish samples", &publishing))
+            {
+                if (publishing)
+                {
+                    PublisherConfig config;
+                    config.WebSocketPort = config.MulticastPort + 1;
+                    Publisher.Start(config);
+                }
+                else
+                    Publisher.Stop();
+            }
+            if (Publisher.Running())
+            {
+                ImGui::Text("Multicast %s:%u, WebSocket port %u", PublisherConfig().MulticastGroup.c_str(),
+                    (unsigned)PublisherConfig().MulticastPort, (unsigned)PublisherConfig().MulticastPort + 1);
+                ImGui::Text("%llu samples (%llu dropped), %llu datagrams (%llu dropped)",
+                    (unsigned long long)Publisher.SamplesPublished(), (unsigned long long)Publisher.SamplesDropped(),
+                    (unsigned long long)Publisher.PacketsSent(), (unsigned long long)Publisher.MulticastDropped());
+                ImGui::Text("%d subscribers, %llu packets dropped for slow ones", Publisher.Subscribers(),
+                    (unsigned long long)Publisher.SubscriberDropped());
+            }
+            if (SharedRing.IsOpen())
+                ImGui::Text("Shared memory ring \"%s\": %llu samples written", SHARED_RING_DEFAULT_NAME,
+                    (unsigned long long)SharedRing.SamplesWritten());
+            else
+                ImGui::TextDisabled("Shared memory ring unavailable");
+            ImGui::End();
+        }
+
+        // a drag or an edit in progress keeps the full frame rate between input events
+        if (ImGui::IsAnyItemActive())
+            pacer.Activity(MonotonicNanoseconds());
+
         // Rendering
         ImGui::Render();
 
@@ -529,6 +849,17 @@ int main(int, char**)
         g_pSwapChain->Present(1, 0); // Present with vsync
         //g_pSwapChain->Present(0, 0); // Present without vsync
 
+        uint64_t presentedNs = MonotonicNanoseconds();
+        for (const SampleStamps& stamps : undrawnStamps)
+        {
+            latency[LatencyStage_Parse].Record(stamps.Parsed - stamps.Arrival);
+            latency[LatencyStage_Store].Record(stamps.Stored - stamps.Parsed);
+            latency[LatencyStage_Draw].Record(presentedNs - stamps.Stored);
+            latency[LatencyStage_Total].Record(presentedNs - stamps.Arrival);
+        }
+        undrawnStamps.resize(0);
+        pacer.FrameDrawn(presentedNs);
+
         UINT64 fenceValue = g_fenceLastSignaledValue + 1;
         g_pd3dCommandQueue->Signal(g_fence, fenceValue);
         g_fenceLastSignaledValue = fenceValue;
@@ -536,6 +867,16 @@ int main(int, char**)
     }
 
     WaitForLastSubmittedFrame();
+    Ingest.Stop();
+    storeFeed.Stop();
+    ::CloseHandle(publishEvent);
+    Recorder.Stop();
+    Publisher.Stop();
+    SharedRing.Close();
+    if (csvExport.valid())
+        csvExport.wait();
+    if (archiveExport.valid())
+        archiveExport.wait();
 
     // Cleanup
     ImGui_ImplDX12_Shutdown();
@@ -546,7 +887,6 @@ int main(int, char**)
     CleanupDeviceD3D();
     ::DestroyWindow(hwnd);
     ::UnregisterClassW(wc.lpszClassName, wc.hInstance);
-    dataFile.close();
     return 0;
 }
 
@@ -759,42 +1099,292 @@ void LinkedText(bool active, char text[])
         ImGui::TextDisabled(text);
 }
 
-string serialCommTasks()
+// Buckets of one pyramid level, drawn as min/max pairs at each bucket's start time
+struct PyramidPlotData
+{
+    const StoreSnapshot* Store;
+    int Column;
+    int Level;
+    size_t FirstBucket;
+};
+
+ImPlotPoint PyramidMinMaxPoint(int idx, void* user_data)
 {
-    string output = "";
-    if (passedSerialParams & SEND_ENABLE)
-        payloadReleaseEnable();
-    if (passedSerialParams & SEND_DISABLE)
-        payloadReleaseDisable();
-    if (passedSerialParams & READ_SERIAL)
-        output = GetSerialData();
-
-    return output;
+    const PyramidPlotData& data = *(const PyramidPlotData*)user_data;
+    size_t bucket = data.FirstBucket + idx / 2;
+    float time = data.Store->BucketTime(data.Level, bucket);
+    return ImPlotPoint(time, (idx & 1) ? data.Store->Max(data.Level, data.Column, bucket) : data.Store->Min(data.Level, data.Column, bucket));
 }
 
-string GetSerialData()
+ImPlotPoint PyramidMinPoint(int idx, void* user_data) { return PyramidMinMaxPoint(idx * 2, user_data); }
+ImPlotPoint PyramidMaxPoint(int idx, void* user_data) { return PyramidMinMaxPoint(idx * 2 + 1, user_data); }
+
+// Draws samples [first, end) of one store column. Short ranges are plotted straight from the
+// store's chunks; longer ones from the coarsest pyramid level that still gives ~2 points per pixel.
+void PlotColumn(const char* label, const StoreSnapshot& store, int column, size_t first)
 {
-    int reply_wait_time = 1;
-    string syntax_type = "json";
+    size_t sampleCount = store.Size() - first;
+    size_t maxPoints = 2 * (size_t)std::max(ImPlot::GetPlotSize().x, 1.0f);
+    int level = TelemetryPyramid::ChooseLevel(sampleCount, maxPoints);
 
-    return Serial.ReadSerialPort(reply_wait_time, syntax_type);
+    if (level == 0)
+    {
+        store.ForEachSpan(column, first, store.Size(), [label](const float* times, const float* values, int count)
+        {
+            ImPlot::PlotLine(label, times, values, count, 0, 0, sizeof(float));
+        });
+        return;
+    }
+
+    PyramidPlotData data = { &store, column, level, first / TelemetryPyramid::BucketSamples(level) };
+    int bucketCount = (int)(store.BucketCount(level) - data.FirstBucket);
+    ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.25f);
+    ImPlot::PlotShadedG(label, PyramidMinPoint, &data, PyramidMaxPoint, &data, bucketCount);
+    ImPlot::PlotLineG(label, PyramidMinMaxPoint, &data, 2 * bucketCount);
 }
 
-void payloadReleaseEnable()
+// Draws every raw and derived channel whose plotGroups include group, in schema order
+void PlotChannels(PlotGroup group, const StoreSnapshot& store, size_t first)
 {
-    char data = 'r';
-    Serial.WriteSerialPort(&data);
+    for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+    {
+        if (COLUMNS[column].plotGroups & group)
+            PlotColumn(COLUMNS[column].label, store, column, first);
+    }
 }
 
-void payloadReleaseDisable()
+// Fits the current plot's Y axis to the window min/max of every channel drawn in group; keeps
+// the last range (or 0..1 before any data) while the group's channels have no samples
+void SetupAutoscaleY(PlotGroup group, const ChannelSummary* summaries, AxisAutoscale& axis, float dt)
 {
-    char data = 'u';
-    Serial.WriteSerialPort(&data);
+    bool any = false;
+    float min = 0.0f, max = 0.0f;
+    for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+    {
+        const ChannelSummary& summary = summaries[column];
+        if (!(COLUMNS[column].plotGroups & group) || summary.Samples == 0)
+            continue;
+        if (!any || summary.Min < min)
+            min = summary.Min;
+        if (!any || summary.Max > max)
+            max = summary.Max;
+        any = true;
+    }
+    if (any)
+        axis.Update(min, max, dt);
+
+    if (axis.Valid())
+        ImPlot::SetupAxisLimits(ImAxis_Y1, axis.Min(), axis.Max(), ImGuiCond_Always);
+    else
+        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
 }
 
-float vecMag(float a, float b, float c)
+// Latest value and window statistics of every raw and derived channel, in schema order
+void ShowChannelReadout(const ChannelSummary* summaries, float sampleRate)
 {
-    return sqrt(a * a + b * b + c * c);
+    ImGui::Text("Channels: %.1f samples/s over the window", sampleRate);
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_ScrollY;
+    if (!ImGui::BeginTable("readout", 8, flags, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 8)))
+        return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Channel");
+    ImGui::TableSetupColumn("Value");
+    ImGui::TableSetupColumn("Unit");
+    ImGui::TableSetupColumn("Min");
+    ImGui::TableSetupColumn("Max");
+    ImGui::TableSetupColumn("Mean");
+    ImGui::TableSetupColumn("Std dev");
+    ImGui::TableSetupColumn("Rate (/s)");
+    ImGui::TableHeadersRow();
+
+    for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+    {
+        const ChannelSummary& summary = summaries[column];
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted(COLUMNS[column].label);
+        if (summary.Samples == 0)
+        {
+            ImGui::TableNextColumn(); ImGui::TextDisabled("-");
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(COLUMNS[column].unit);
+            continue;
+        }
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", summary.Latest);
+        ImGui::TableNextColumn(); ImGui::TextUnformatted(COLUMNS[column].unit);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", summary.Min);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", summary.Max);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", summary.Mean);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", summary.StdDev);
+        ImGui::TableNextColumn(); ImGui::Text("%+.3f", summary.Rate);
+    }
+    ImGui::EndTable();
+}
+
+// Vertical markers at the host time of every detected flight event
+void PlotFlightEvents(const TelemetryIngest& ingest)
+{
+    for (int event = 0; event < FlightEvent_COUNT; event++)
+    {
+        FlightEventRecord record;
+        if (ingest.FlightEventRecorded((FlightEvent)event, record))
+        {
+            double x = record.HostTime;
+            ImPlot::PlotInfLines(FLIGHT_EVENT_NAMES[event], &x, 1);
+        }
+    }
+}
+
+// One row per link: up/down, frames, rejects, sequence gaps and restarts, duplicates and late
+// samples dropped by the merge, and seconds since it last delivered data; the uplink link is marked
+void ShowLinkHealth(const TelemetryIngest& ingest)
+{
+    if (!ImGui::BeginTable("links", 9, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        return;
+    ImGui::TableSetupColumn("Link");
+    ImGui::TableSetupColumn("State");
+    ImGui::TableSetupColumn("Frames");
+    ImGui::TableSetupColumn("Rejected");
+    ImGui::TableSetupColumn("Lost");
+    ImGui::TableSetupColumn("Restarts");
+    ImGui::TableSetupColumn("Duplicates");
+    ImGui::TableSetupColumn("Late");
+    ImGui::TableSetupColumn("Silent (s)");
+    ImGui::TableHeadersRow();
+
+    uint64_t now = MonotonicNanoseconds();
+    for (int link = 0; link < ingest.LinkCount(); link++)
+    {
+        LinkHealth health = ingest.Health(link);
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%s%s", ingest.Source(link)->Name(), link == ingest.UplinkLink() ? " (uplink)" : "");
+        ImGui::TableNextColumn();
+        if (health.Connected)
+            ImGui::TextColored(ImVec4(0.3f, 1.0f, 0.3f, 1.0f), "up");
+        else
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "DOWN");
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)health.FramesDecoded);
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)health.FramesRejected);
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)health.PacketsLost);
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)health.SequenceRestarts);
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)health.Duplicates);
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)health.Late);
+        ImGui::TableNextColumn();
+        if (health.LastArrivalNs)
+            ImGui::Text("%.1f", (now - health.LastArrivalNs) * 1e-9);
+        else
+            ImGui::TextDisabled("-");
+    }
+    ImGui::EndTable();
+}
+
+// Last few uplink commands: state, attempts, button-to-wire and button-to-ack latency
+void ShowUplinkCommands(const CommandUplink& uplink)
+{
+    static const ImVec4 STATE_COLORS[CommandState_COUNT] =
+    {
+        ImVec4(0.8f, 0.8f, 0.8f, 1.0f),     // queued
+        ImVec4(1.0f, 0.8f, 0.2f, 1.0f),     // sent
+        ImVec4(0.3f, 1.0f, 0.3f, 1.0f),     // acked
+        ImVec4(0.8f, 0.8f, 0.8f, 1.0f),     // written
+        ImVec4(1.0f, 0.3f, 0.3f, 1.0f),     // failed
+    };
+
+    CommandStatus commands[4];
+    size_t count = uplink.Recent(commands, 4);
+    for (size_t i = 0; i < count; i++)
+    {
+        const CommandStatus& command = commands[i];
+        ImGui::TextColored(STATE_COLORS[command.State], "#%u %s: %s", (unsigned)command.Sequence, UPLINK_COMMANDS[command.Command].Name,
+            COMMAND_STATE_NAMES[command.State]);
+        if (command.WrittenNs == 0)
+            continue;
+        ImGui::SameLine();
+        if (command.State == CommandState_Acked)
+            ImGui::TextDisabled("wire %.2f ms, ack %.1f ms, attempt %u", (command.WrittenNs - command.RequestedNs) * 1e-6,
+                (command.AckedNs - command.RequestedNs) * 1e-6, (unsigned)command.Attempts);
+        else
+            ImGui::TextDisabled("wire %.2f ms, attempt %u", (command.WrittenNs - command.RequestedNs) * 1e-6, (unsigned)command.Attempts);
+    }
+}
+
+// Range of one archive column, drawn raw, from the fine summaries or from (grouped) block summaries
+struct ArchivePlotData
+{
+    const FlightArchive* Archive;
+    int Column;
+    uint64_t First;     // first sample, fine summary or block
+    uint64_t End;       // one past the last
+    uint64_t Group;     // blocks merged into each point pair
+    ImPlotGetter MinMax;
+};
+
+ImPlotPoint ArchiveSamplePoint(int idx, void* user_data)
+{
+    const ArchivePlotData& data = *(const ArchivePlotData*)user_data;
+    uint64_t index = data.First + idx;
+    return ImPlotPoint(data.Archive->Time(index), data.Archive->Value(data.Column, index));
+}
+
+ImPlotPoint ArchiveFinePoint(int idx, void* user_data)
+{
+    const ArchivePlotData& data = *(const ArchivePlotData*)user_data;
+    size_t fine = (size_t)(data.First + idx / 2);
+    float value = (idx & 1) ? data.Archive->FineMax(data.Column, fine) : data.Archive->FineMin(data.Column, fine);
+    return ImPlotPoint(data.Archive->FineTime(fine), value);
+}
+
+ImPlotPoint ArchiveBlockPoint(int idx, void* user_data)
+{
+    const ArchivePlotData& data = *(const ArchivePlotData*)user_data;
+    size_t first = (size_t)(data.First + (idx / 2) * data.Group);
+    size_t end = (size_t)std::min<uint64_t>(first + data.Group, data.End);
+    float value = (idx & 1) ? data.Archive->BlockMax(data.Column, first) : data.Archive->BlockMin(data.Column, first);
+    for (size_t block = first + 1; block < end; block++)
+        value = (idx & 1) ? std::max(value, data.Archive->BlockMax(data.Column, block)) : std::min(value, data.Archive->BlockMin(data.Column, block));
+    return ImPlotPoint(data.Archive->BlockFirstTime(first), value);
+}
+
+ImPlotPoint ArchiveMinPoint(int idx, void* user_data) { return ((ArchivePlotData*)user_data)->MinMax(idx * 2, user_data); }
+ImPlotPoint ArchiveMaxPoint(int idx, void* user_data) { return ((ArchivePlotData*)user_data)->MinMax(idx * 2 + 1, user_data); }
+
+// Draws the part of an archive column inside [xMin, xMax] with ~2 points per pixel. Raw samples are
+// only touched when they fit; wider ranges read the summaries and never page in sample data.
+void PlotArchiveColumn(const char* label, const FlightArchive& archive, int column, double xMin, double xMax)
+{
+    uint64_t first = archive.LowerBound((float)xMin);
+    uint64_t last = archive.LowerBound((float)xMax);
+    if (first > 0)
+        first--;
+    if (last < archive.SampleCount())
+        last++;
+    if (last <= first)
+        return;
+
+    uint64_t sampleCount = last - first;
+    uint64_t maxPoints = 2 * (uint64_t)std::max(ImPlot::GetPlotSize().x, 1.0f);
+    ArchivePlotData data = { &archive, column, first, last, 1, ArchiveSamplePoint };
+
+    if (sampleCount <= maxPoints)
+    {
+        ImPlot::PlotLineG(label, ArchiveSamplePoint, &data, (int)sampleCount);
+        return;
+    }
+
+    data.First = first / ARCHIVE_FINE_SAMPLES;
+    data.End = (last - 1) / ARCHIVE_FINE_SAMPLES + 1;
+    data.MinMax = ArchiveFinePoint;
+    if (2 * (data.End - data.First) > maxPoints)
+    {
+        data.First = first / ARCHIVE_BLOCK_SAMPLES;
+        data.End = (last - 1) / ARCHIVE_BLOCK_SAMPLES + 1;
+        data.Group = (2 * (data.End - data.First) + maxPoints - 1) / maxPoints;
+        data.MinMax = ArchiveBlockPoint;
+    }
+
+    int bucketCount = (int)((data.End - data.First + data.Group - 1) / data.Group);
+    ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.25f);
+    ImPlot::PlotShadedG(label, ArchiveMinPoint, &data, ArchiveMaxPoint, &data, bucketCount);
+    ImPlot::PlotLineG(label, data.MinMax, &data, 2 * bucketCount);
 }
 
 // Forward declare message handler from imgui_impl_win32.cpp
@@ -0,0 +1,260 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : file_(INVALID_HANDLE_VALUE), mapping_(nullptr), data_(nullptr), size_(0), writable_(false)
+{
+}
+
+bool MappedFile::OpenWrite(const std::string& path, size_t min_size)
+{
+    Close();
+    file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER current;
+    if (!GetFileSizeEx(file_, &current))
+    {
+        Close();
+        return false;
+    }
+
+    writable_ = true;
+    size_ = (size_t)current.QuadPart;
+    if (size_ < min_size)
+        return Resize(min_size);
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::OpenRead(const std::string& path)
+{
+    Close();
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER current;
+    writable_ = false;
+    if (!GetFileSizeEx(file_, &current) || current.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+    size_ = (size_t)current.QuadPart;
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::Resize(size_t size)
+{
+    if (!writable_ || file_ == INVALID_HANDLE_VALUE)
+        return false;
+
+    Unmap();
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)size;
+    if (!SetFilePointerEx(file_, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file_))
+    {
+        Close();
+        return false;
+    }
+    size_ = size;
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::Flush(size_t offset, size_t length)
+{
+    if (!data_ || !writable_)
+        return false;
+    if (length && !FlushViewOfFile(data_ + offset, length))
+        return false;
+    return FlushFileBuffers(file_) != 0;
+}
+
+bool MappedFile::Map()
+{
+    mapping_ = CreateFileMappingA(file_, nullptr, writable_ ? PAGE_READWRITE : PAGE_READONLY,
+        (DWORD)((uint64_t)size_ >> 32), (DWORD)size_, nullptr);
+    if (!mapping_)
+        return false;
+
+    data_ = (uint8_t*)MapViewOfFile(mapping_, writable_ ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size_);
+    if (!data_)
+    {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Unmap()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+}
+
+void MappedFile::Close()
+{
+    Unmap();
+    if (file_ != INVALID_HANDLE_VALUE)
+        CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+    size_ = 0;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : fd_(-1), data_(nullptr), size_(0), writable_(false)
+{
+}
+
+bool MappedFile::OpenWrite(const std::string& path, size_t min_size)
+{
+    Close();
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd_, &info) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    writable_ = true;
+    size_ = (size_t)info.st_size;
+    if (size_ < min_size)
+        return Resize(min_size);
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::OpenRead(const std::string& path)
+{
+    Close();
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        return false;
+
+    struct stat info;
+    writable_ = false;
+    if (fstat(fd_, &info) != 0 || info.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+    size_ = (size_t)info.st_size;
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::Resize(size_t size)
+{
+    if (!writable_ || fd_ < 0)
+        return false;
+
+    Unmap();
+#ifdef __linux__
+    // allocate the blocks now so a full disk fails here rather than as SIGBUS on a later write
+    bool grown = size <= size_ || posix_fallocate(fd_, 0, (off_t)size) == 0;
+#else
+    bool grown = ftruncate(fd_, (off_t)size) == 0;
+#endif
+    if (!grown)
+    {
+        Close();
+        return false;
+    }
+    size_ = size;
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::Flush(size_t offset, size_t length)
+{
+    if (!data_ || !writable_)
+        return false;
+
+    // msync needs a page aligned start
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = offset - offset % page;
+    return msync(data_ + start, length + (offset - start), MS_SYNC) == 0;
+}
+
+bool MappedFile::Map()
+{
+    void* data = mmap(nullptr, size_, writable_ ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED)
+        return false;
+    data_ = (uint8_t*)data;
+    return true;
+}
+
+void MappedFile::Unmap()
+{
+    if (data_)
+        munmap(data_, size_);
+    data_ = nullptr;
+}
+
+void MappedFile::Close()
+{
+    Unmap();
+    if (fd_ >= 0)
+        close(fd_);
+    fd_ = -1;
+    size_ = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Whole-file memory mapping, read/write or read-only.
+// Writable files are grown (and their blocks allocated) up front, so appending through Data()
+// never extends the file and a later Flush() only has to write the dirty pages.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps path read/write, creating it and growing it to at least min_size bytes.
+    bool OpenWrite(const std::string& path, size_t min_size);
+    // Maps an existing file read-only. Other processes and threads may keep writing to it.
+    bool OpenRead(const std::string& path);
+    void Close();
+
+    // Grows a writable file and remaps it; pointers from Data() are invalid afterwards.
+    bool Resize(size_t size);
+    // Writes [offset, offset + length) back to disk and waits until it is durable.
+    bool Flush(size_t offset, size_t length);
+
+    bool IsOpen() const { return data_ != nullptr; }
+    uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+private:
+    bool Map();
+    void Unmap();
+
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int fd_;
+#endif
+    uint8_t* data_;
+    size_t size_;
+    bool writable_;
+};
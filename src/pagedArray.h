@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <stddef.h>
+
+// Append-only array of fixed-size elements, kept in pages under a fixed page directory.
+// An element never moves once its page exists, so another thread may read any element below a
+// count the writer has published (with release ordering) while the writer keeps extending.
+// Pages are only freed with the array; an owner that starts over simply writes them again.
+template<typename T>
+class PagedArray
+{
+public:
+    static const size_t MAX_PAGES = 4096;
+
+    // element_size Ts per element, page_elements (a power of two) elements per page
+    PagedArray(size_t element_size, size_t page_elements)
+        : element_size_(element_size), page_shift_(0)
+    {
+        while (((size_t)1 << page_shift_) < page_elements)
+            page_shift_++;
+    }
+
+    PagedArray(const PagedArray&) = delete;
+    PagedArray& operator=(const PagedArray&) = delete;
+
+    size_t Capacity() const { return MAX_PAGES << page_shift_; }
+
+    // Writer: element index, allocating its page on first use. index must be below Capacity().
+    T* Extend(size_t index)
+    {
+        std::unique_ptr<T[]>& page = pages_[index >> page_shift_];
+        if (!page)
+            page.reset(new T[element_size_ << page_shift_]);
+        return At(index);
+    }
+
+    T* At(size_t index) { return pages_[index >> page_shift_].get() + (index & PageMask()) * element_size_; }
+    const T* At(size_t index) const { return pages_[index >> page_shift_].get() + (index & PageMask()) * element_size_; }
+
+private:
+    size_t PageMask() const { return ((size_t)1 << page_shift_) - 1; }
+
+    size_t element_size_;
+    int page_shift_;
+    std::unique_ptr<T[]> pages_[MAX_PAGES];
+};
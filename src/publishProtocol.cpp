@@ -0,0 +1,77 @@
+#include "publishProtocol.h"
+#include <string.h>
+
+size_t EncodePublishPacket(const TelemetrySample* samples, size_t count, uint32_t sequence, uint8_t* out)
+{
+    if (count > PUBLISH_MAX_SAMPLES)
+        count = PUBLISH_MAX_SAMPLES;
+
+    uint8_t* p = out;
+    *p++ = PUBLISH_PACKET_TYPE;
+    *p++ = (uint8_t)Channel_COUNT;
+    *p++ = (uint8_t)Estimate_COUNT;
+    *p++ = (uint8_t)count;
+    memcpy(p, &sequence, 4); p += 4;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const TelemetrySample& sample = samples[i];
+        memcpy(p, &sample.arrivalNs, 8); p += 8;
+        memcpy(p, &sample.hostTime, 4); p += 4;
+        memcpy(p, &sample.sequence, 2); p += 2;
+        *p++ = sample.format;
+        *p++ = 0;
+        for (const ChannelDef& channel : CHANNELS)
+        {
+            if (channel.member == &TelemetrySample::time)
+                memcpy(p, &sample.rocketMs, 4);
+            else
+                memcpy(p, &(sample.*channel.member), 4);
+            p += 4;
+        }
+        for (const EstimateDef& estimate : ESTIMATES)
+        {
+            memcpy(p, &(sample.*estimate.member), 4);
+            p += 4;
+        }
+    }
+    return p - out;
+}
+
+size_t DecodePublishPacket(const uint8_t* packet, size_t length, uint32_t& sequence, TelemetrySample* out)
+{
+    if (length < PUBLISH_HEADER_SIZE || packet[0] != PUBLISH_PACKET_TYPE || packet[1] != Channel_COUNT
+        || packet[2] != Estimate_COUNT)
+        return 0;
+    size_t count = packet[3];
+    if (count == 0 || count > PUBLISH_MAX_SAMPLES || length != PUBLISH_HEADER_SIZE + count * PUBLISH_SAMPLE_SIZE)
+        return 0;
+
+    const uint8_t* p = packet + 4;
+    memcpy(&sequence, p, 4); p += 4;
+    for (size_t i = 0; i < count; i++)
+    {
+        TelemetrySample& sample = out[i];
+        sample = TelemetrySample();
+        memcpy(&sample.arrivalNs, p, 8); p += 8;
+        memcpy(&sample.hostTime, p, 4); p += 4;
+        memcpy(&sample.sequence, p, 2); p += 2;
+        sample.format = *p++;
+        p++;
+        for (const ChannelDef& channel : CHANNELS)
+        {
+            if (channel.member == &TelemetrySample::time)
+                memcpy(&sample.rocketMs, p, 4);
+            else
+                memcpy(&(sample.*channel.member), p, 4);
+            p += 4;
+        }
+        sample.time = (float)sample.rocketMs;
+        for (const EstimateDef& estimate : ESTIMATES)
+        {
+            memcpy(&(sample.*estimate.member), p, 4);
+            p += 4;
+        }
+    }
+    return count;
+}
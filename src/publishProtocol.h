@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "telemetrySample.h"
+
+// Batched sample packet that SamplePublisher sends to other tools at the ground station, as a UDP
+// datagram or as one binary WebSocket message each.
+//
+// Packet (little-endian):
+//   u8  type            PUBLISH_PACKET_TYPE
+//   u8  channel count   Channel_COUNT of the sender
+//   u8  estimate count  Estimate_COUNT of the sender
+//   u8  sample count    1 .. PUBLISH_MAX_SAMPLES
+//   u32 sequence        +1 per packet, so a subscriber can count what it missed
+//   per sample:
+//     u64 arrival ns    MonotonicNanoseconds() at the read that completed the frame, on the sender
+//     f32 host time     seconds since ingest started
+//     u16 sequence      link packet counter, binary frames only
+//     u8  format        FRAME_FORMAT_ASCII or FRAME_FORMAT_BINARY
+//     u8  reserved
+//     f32 per channel in TELEMETRY_CHANNELS order, then per channel in ESTIMATED_CHANNELS order;
+//         the time channel alone is the u32 ms count as the rocket sent it
+//
+// The packet size follows from the header, so a subscriber built against another schema can
+// tell and refuse it. At the maximum sample count a packet fits in one Ethernet frame.
+
+static const uint8_t PUBLISH_PACKET_TYPE = 0xB2;
+static const size_t PUBLISH_HEADER_SIZE = 8;
+static const size_t PUBLISH_SAMPLE_SIZE = 16 + 4 * (Channel_COUNT + Estimate_COUNT);
+static const size_t PUBLISH_MAX_SAMPLES = 16;
+static const size_t PUBLISH_MAX_PACKET_SIZE = PUBLISH_HEADER_SIZE + PUBLISH_MAX_SAMPLES * PUBLISH_SAMPLE_SIZE;
+static_assert(PUBLISH_MAX_PACKET_SIZE <= 1472, "a full packet must fit in one UDP datagram on Ethernet");
+
+// Writes min(count, PUBLISH_MAX_SAMPLES) samples into out (PUBLISH_MAX_PACKET_SIZE bytes); returns
+// the packet size.
+size_t EncodePublishPacket(const TelemetrySample* samples, size_t count, uint32_t sequence, uint8_t* out);
+
+// Decodes a packet into out (PUBLISH_MAX_SAMPLES entries). Returns the sample count, or 0 if the
+// packet is malformed or from a sender with another channel schema.
+size_t DecodePublishPacket(const uint8_t* packet, size_t length, uint32_t& sequence, TelemetrySample* out);
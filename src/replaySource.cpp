@@ -0,0 +1,139 @@
+#include "replaySource.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include <thread>
+#include "flightJournal.h"
+#include "latencyHistogram.h"
+
+// gap left between sessions when several are laid end to end
+static const uint64_t SESSION_GAP_NS = 1000000000ull;
+
+ReplaySource::ReplaySource()
+    : position_(0), speed_(1.0), paused_(false), finished_(false), position_ns_(0), bytes_replayed_(0),
+      commands_ignored_(0), run_ns_(0), begin_wall_ns_(0), anchor_wall_ns_(0), anchor_timeline_ns_(0),
+      anchor_speed_(1.0), anchored_(false)
+{
+}
+
+bool ReplaySource::Load(const std::string& journal_path)
+{
+    JournalReader reader;
+    if (!reader.Open(journal_path))
+        return false;
+
+    chunks_.clear();
+    bytes_.clear();
+
+    uint64_t session_base = 0;
+    uint64_t session_first_arrival = 0;
+    bool session_started = false;
+    JournalRecord record;
+    while (reader.Next(record))
+    {
+        if (record.Type == JournalRecord_Session)
+        {
+            if (!chunks_.empty())
+                session_base = chunks_.back().TimelineNs + SESSION_GAP_NS;
+            session_started = false;
+            continue;
+        }
+        if (record.Type != JournalRecord_Raw || record.Length <= 8)
+            continue;
+
+        uint64_t arrival;
+        memcpy(&arrival, record.Payload, 8);
+        if (!session_started)
+        {
+            session_first_arrival = arrival;
+            session_started = true;
+        }
+
+        Chunk chunk = { session_base + (arrival - session_first_arrival), bytes_.size(), record.Length - 8 };
+        bytes_.insert(bytes_.end(), record.Payload + 8, record.Payload + record.Length);
+        chunks_.push_back(chunk);
+    }
+
+    Seek(0);
+    return !chunks_.empty();
+}
+
+void ReplaySource::Seek(uint64_t timeline_ns)
+{
+    auto it = std::lower_bound(chunks_.begin(), chunks_.end(), timeline_ns,
+        [](const Chunk& chunk, uint64_t time) { return chunk.TimelineNs < time; });
+    position_ = it - chunks_.begin();
+    position_ns_.store(it != chunks_.end() ? it->TimelineNs : DurationNs());
+    finished_.store(false);
+}
+
+void ReplaySource::Begin()
+{
+    begin_wall_ns_ = MonotonicNanoseconds();
+    anchored_ = false;
+    bytes_replayed_.store(0);
+    run_ns_.store(0);
+    finished_.store(position_ >= chunks_.size());
+}
+
+int ReplaySource::Read(uint8_t* buffer, size_t length, uint32_t timeout_ms, uint64_t& timeline_ns)
+{
+    if (position_ >= chunks_.size() || paused_.load())
+    {
+        if (position_ >= chunks_.size() && !finished_.exchange(true))
+            run_ns_.store(MonotonicNanoseconds() - begin_wall_ns_);
+        anchored_ = false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return 0;
+    }
+
+    const Chunk& first = chunks_[position_];
+    double speed = speed_.load();
+    if (!anchored_ || speed != anchor_speed_)
+    {
+        anchor_wall_ns_ = MonotonicNanoseconds();
+        anchor_timeline_ns_ = first.TimelineNs;
+        anchor_speed_ = speed;
+        anchored_ = true;
+    }
+
+    if (speed > 0)
+    {
+        uint64_t due = anchor_wall_ns_ + (uint64_t)((first.TimelineNs - anchor_timeline_ns_) / speed);
+        uint64_t now = MonotonicNanoseconds();
+        if (due > now)
+        {
+            uint64_t wait_ns = std::min<uint64_t>(due - now, (uint64_t)timeout_ms * 1000000ull);
+            std::this_thread::sleep_for(std::chrono::nanoseconds(wait_ns));
+            if (MonotonicNanoseconds() < due)
+                return 0;
+        }
+    }
+
+    // one original read: the recorder splits it into consecutive records with the same arrival time
+    size_t copied = 0;
+    size_t next = position_;
+    while (next < chunks_.size() && chunks_[next].TimelineNs == first.TimelineNs)
+    {
+        const Chunk& chunk = chunks_[next];
+        if (copied + chunk.Length > length && copied > 0)
+            break;
+        size_t count = std::min<size_t>(chunk.Length, length - copied);
+        memcpy(buffer + copied, &bytes_[chunk.Offset], count);
+        copied += count;
+        next++;
+    }
+
+    timeline_ns = first.TimelineNs;
+    position_ = next;
+    position_ns_.store(first.TimelineNs, std::memory_order_relaxed);
+    bytes_replayed_.fetch_add(copied, std::memory_order_relaxed);
+    return (int)copied;
+}
+
+bool ReplaySource::Write(const char*)
+{
+    // nothing is listening on a recording; count it so the UI can say so
+    commands_ignored_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
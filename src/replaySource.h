@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "telemetrySource.h"
+
+// Replays the raw link bytes recorded in a flight journal through the normal ingest path.
+//
+// Each Read() returns exactly the bytes of one original serial read, stamped with its recorded
+// arrival time, so the decoder sees the same chunk boundaries and produces the same samples at
+// the same host times regardless of replay speed. Reads are paced against the recorded timeline
+// at real time, N times faster, or not at all (speed 0), which makes the whole decode/store/plot
+// pipeline measurable without a board attached.
+class ReplaySource : public TelemetrySource
+{
+public:
+    ReplaySource();
+
+    // Loads every raw record in the journal; sessions are laid end to end on one timeline.
+    // Only while the ingest thread is not reading from this source.
+    bool Load(const std::string& journal_path);
+
+    // UI thread, any time. speed: 1 = real time, N = N times faster, 0 = as fast as possible.
+    void SetSpeed(double speed) { speed_.store(speed); }
+    void SetPaused(bool paused) { paused_.store(paused); }
+    double Speed() const { return speed_.load(); }
+    bool Paused() const { return paused_.load(); }
+
+    // Moves to the first read at or after timeline_ns. Only while the ingest thread is stopped.
+    void Seek(uint64_t timeline_ns);
+
+    uint64_t DurationNs() const { return chunks_.empty() ? 0 : chunks_.back().TimelineNs; }
+    uint64_t PositionNs() const { return position_ns_.load(std::memory_order_relaxed); }
+    uint64_t BytesReplayed() const { return bytes_replayed_.load(std::memory_order_relaxed); }
+    uint64_t CommandsIgnored() const { return commands_ignored_.load(std::memory_order_relaxed); }
+    bool Finished() const { return finished_.load(); }
+    // Wall time from Begin() to the end of the recording, once Finished().
+    double RunSeconds() const { return run_ns_.load() * 1e-9; }
+
+    const char* Name() const override { return "Replay"; }
+    bool Connected() const override { return !chunks_.empty(); }
+    void Begin() override;
+    int Read(uint8_t* buffer, size_t length, uint32_t timeout_ms, uint64_t& timeline_ns) override;
+    bool Write(const char* data) override;
+    bool Lossless() const override { return true; }
+
+private:
+    struct Chunk
+    {
+        uint64_t TimelineNs;
+        size_t Offset;
+        uint32_t Length;
+    };
+
+    std::vector<Chunk> chunks_;
+    std::vector<uint8_t> bytes_;
+    size_t position_;
+
+    std::atomic<double> speed_;
+    std::atomic<bool> paused_;
+    std::atomic<bool> finished_;
+    std::atomic<uint64_t> position_ns_;
+    std::atomic<uint64_t> bytes_replayed_;
+    std::atomic<uint64_t> commands_ignored_;
+    std::atomic<uint64_t> run_ns_;
+
+    // pacing, ingest thread only: chunk time anchor_timeline_ns_ is due at anchor_wall_ns_
+    uint64_t begin_wall_ns_;
+    uint64_t anchor_wall_ns_;
+    uint64_t anchor_timeline_ns_;
+    double anchor_speed_;
+    bool anchored_;
+};
@@ -0,0 +1,563 @@
+#include "samplePublisher.h"
+#include <chrono>
+#include <ctype.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+static const intptr_t NO_SOCKET = (intptr_t)INVALID_SOCKET;
+static void CloseSocket(intptr_t socket) { closesocket((SocketHandle)socket); }
+static bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static bool SetNonBlocking(intptr_t socket)
+{
+    u_long on = 1;
+    return ioctlsocket((SocketHandle)socket, FIONBIO, &on) == 0;
+}
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SocketHandle;
+static const intptr_t NO_SOCKET = -1;
+static void CloseSocket(intptr_t socket) { close((SocketHandle)socket); }
+static bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS; }
+static bool SetNonBlocking(intptr_t socket)
+{
+    int flags = fcntl((SocketHandle)socket, F_GETFL, 0);
+    return flags >= 0 && fcntl((SocketHandle)socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+#endif
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;     // a subscriber hanging up must not raise SIGPIPE
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+// Longest WebSocket handshake, or unread client frames, kept per subscriber.
+static const size_t MAX_SUBSCRIBER_INPUT = 16 * 1024;
+// Kernel send buffer per subscriber. Left to autotune on loopback it grows to megabytes, seconds of
+// data that the subscriber's own bounded buffer would never see.
+static const int SUBSCRIBER_SOCKET_BUFFER = 64 * 1024;
+
+// SHA-1, only for the WebSocket handshake's Sec-WebSocket-Accept.
+static void Sha1(const uint8_t* data, size_t length, uint8_t digest[20])
+{
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    auto rotate = [](uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); };
+
+    uint64_t total_bits = (uint64_t)length * 8;
+    size_t padded = (length + 9 + 63) / 64 * 64;
+    for (size_t block = 0; block < padded; block += 64)
+    {
+        uint8_t bytes[64];
+        for (size_t i = 0; i < 64; i++)
+        {
+            size_t at = block + i;
+            if (at < length)
+                bytes[i] = data[at];
+            else if (at == length)
+                bytes[i] = 0x80;
+            else if (at >= padded - 8)
+                bytes[i] = (uint8_t)(total_bits >> (8 * (padded - 1 - at)));
+            else
+                bytes[i] = 0;
+        }
+
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++)
+            w[i] = (uint32_t)bytes[4 * i] << 24 | (uint32_t)bytes[4 * i + 1] << 16 | (uint32_t)bytes[4 * i + 2] << 8 | bytes[4 * i + 3];
+        for (int i = 16; i < 80; i++)
+            w[i] = rotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++)
+        {
+            uint32_t f, k;
+            if (i < 20)
+            {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            }
+            else if (i < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            }
+            else if (i < 60)
+            {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t next = rotate(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotate(b, 30);
+            b = a;
+            a = next;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    for (int i = 0; i < 20; i++)
+        digest[i] = (uint8_t)(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+static std::string Base64(const uint8_t* data, size_t length)
+{
+    static const char DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < length; i += 3)
+    {
+        uint32_t group = (uint32_t)data[i] << 16;
+        if (i + 1 < length)
+            group |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < length)
+            group |= data[i + 2];
+        out += DIGITS[(group >> 18) & 63];
+        out += DIGITS[(group >> 12) & 63];
+        out += i + 1 < length ? DIGITS[(group >> 6) & 63] : '=';
+        out += i + 2 < length ? DIGITS[group & 63] : '=';
+    }
+    return out;
+}
+
+// Value of an HTTP header in request (case-insensitive name), or "" if absent.
+static std::string HeaderValue(const std::string& request, const char* name)
+{
+    size_t name_length = strlen(name);
+    size_t line = request.find("\r\n");
+    while (line != std::string::npos && line + 2 < request.size())
+    {
+        size_t start = line + 2;
+        size_t end = request.find("\r\n", start);
+        if (end == std::string::npos)
+            break;
+        if (end - start > name_length && request[start + name_length] == ':')
+        {
+            bool match = true;
+            for (size_t i = 0; i < name_length && match; i++)
+                match = tolower((unsigned char)request[start + i]) == tolower((unsigned char)name[i]);
+            if (match)
+            {
+                size_t value = request.find_first_not_of(" \t", start + name_length + 1);
+                size_t value_end = request.find_last_not_of(" \t", end - 1);
+                return value < end && value_end >= value ? request.substr(value, value_end - value + 1) : std::string();
+            }
+        }
+        line = end;
+    }
+    return std::string();
+}
+
+SamplePublisher::SamplePublisher()
+    : running_(false), multicast_socket_(NO_SOCKET), multicast_group_(0), listen_socket_(NO_SOCKET), packet_sequence_(0),
+      packet_sizes_(), samples_published_(0), samples_dropped_(0), packets_sent_(0), multicast_dropped_(0),
+      subscriber_dropped_(0), subscriber_count_(0), waiting_(false)
+{
+}
+
+SamplePublisher::~SamplePublisher()
+{
+    Stop();
+}
+
+bool SamplePublisher::Start(const PublisherConfig& config)
+{
+    if (running_.load())
+        return true;
+    config_ = config;
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+        return false;
+#endif
+
+    bool ok = true;
+    if (!config.MulticastGroup.empty())
+    {
+        in_addr group, local;
+        local.s_addr = htonl(INADDR_ANY);
+        ok = inet_pton(AF_INET, config.MulticastGroup.c_str(), &group) == 1
+            && (config.MulticastInterface.empty() || inet_pton(AF_INET, config.MulticastInterface.c_str(), &local) == 1);
+        multicast_group_ = group.s_addr;
+        if (ok)
+            multicast_socket_ = (intptr_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        ok = ok && multicast_socket_ != NO_SOCKET && SetNonBlocking(multicast_socket_);
+        if (ok)
+        {
+#ifdef _WIN32
+            DWORD ttl = (DWORD)config.MulticastTtl, loop = 1;
+#else
+            unsigned char ttl = (unsigned char)config.MulticastTtl, loop = 1;
+#endif
+            ok = setsockopt((SocketHandle)multicast_socket_, IPPROTO_IP, IP_MULTICAST_TTL, (const char*)&ttl, sizeof(ttl)) == 0
+                && setsockopt((SocketHandle)multicast_socket_, IPPROTO_IP, IP_MULTICAST_LOOP, (const char*)&loop, sizeof(loop)) == 0
+                && (config.MulticastInterface.empty()
+                    || setsockopt((SocketHandle)multicast_socket_, IPPROTO_IP, IP_MULTICAST_IF, (const char*)&local, sizeof(local)) == 0);
+        }
+    }
+
+    if (ok && config.WebSocketPort != 0)
+    {
+        listen_socket_ = (intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        ok = listen_socket_ != NO_SOCKET && SetNonBlocking(listen_socket_);
+        if (ok)
+        {
+            int reuse = 1;
+            setsockopt((SocketHandle)listen_socket_, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(config.WebSocketPort);
+            address.sin_addr.s_addr = htonl(config.WebSocketLoopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+            ok = bind((SocketHandle)listen_socket_, (const sockaddr*)&address, sizeof(address)) == 0
+                && listen((SocketHandle)listen_socket_, MAX_SUBSCRIBERS) == 0;
+        }
+    }
+
+    if (!ok)
+    {
+        CloseSockets();
+        return false;
+    }
+
+    packet_sequence_ = 0;
+    samples_published_.store(0);
+    samples_dropped_.store(0);
+    packets_sent_.store(0);
+    multicast_dropped_.store(0);
+    subscriber_dropped_.store(0);
+    running_.store(true);
+    thread_ = std::thread(&SamplePublisher::Run, this);
+    return true;
+}
+
+void SamplePublisher::Stop()
+{
+    if (!running_.exchange(false))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_.notify_one();
+    }
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void SamplePublisher::CloseSockets()
+{
+    for (Subscriber& subscriber : subscribers_)
+        CloseSocket(subscriber.Socket);
+    subscribers_.clear();
+    subscriber_count_.store(0);
+    if (listen_socket_ != NO_SOCKET)
+        CloseSocket(listen_socket_);
+    if (multicast_socket_ != NO_SOCKET)
+        CloseSocket(multicast_socket_);
+    listen_socket_ = multicast_socket_ = NO_SOCKET;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void SamplePublisher::PublishSample(const TelemetrySample& sample)
+{
+    if (!running_.load(std::memory_order_relaxed))
+        return;
+    if (!queue_.Push(sample))
+    {
+        samples_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // pairs with the fence in WaitForSamples(): either it sees the sample or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_.notify_one();
+    }
+}
+
+bool SamplePublisher::WaitForSamples(uint32_t timeout_ms)
+{
+    if (queue_.Size() > 0)
+        return true;
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    waiting_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ready = wake_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+        [this]() { return queue_.Size() > 0 || !running_.load(std::memory_order_relaxed); });
+    waiting_.store(false);
+    return ready;
+}
+
+void SamplePublisher::Run()
+{
+    static const size_t BATCH_SAMPLES = PACKETS_PER_SEND * PUBLISH_MAX_SAMPLES;
+    TelemetrySample batch[BATCH_SAMPLES];
+
+    while (running_.load(std::memory_order_relaxed))
+    {
+        // subscribers with unsent data are retried soon; new ones are accepted within the idle wait
+        bool backlog = false;
+        for (const Subscriber& subscriber : subscribers_)
+            backlog |= subscriber.OutSent < subscriber.Out.size();
+        WaitForSamples(backlog ? 5 : 50);
+
+        AcceptSubscribers();
+        for (size_t i = 0; i < subscribers_.size();)
+        {
+            if (ReadSubscriber(subscribers_[i]))
+                i++;
+            else
+            {
+                CloseSocket(subscribers_[i].Socket);
+                subscribers_.erase(subscribers_.begin() + i);
+            }
+        }
+
+        size_t count;
+        while ((count = queue_.PopBatch(batch, BATCH_SAMPLES)) > 0)
+            Send(batch, count);
+
+        for (size_t i = 0; i < subscribers_.size();)
+        {
+            if (FlushSubscriber(subscribers_[i]))
+                i++;
+            else
+            {
+                CloseSocket(subscribers_[i].Socket);
+                subscribers_.erase(subscribers_.begin() + i);
+            }
+        }
+        subscriber_count_.store((int)subscribers_.size(), std::memory_order_relaxed);
+    }
+
+    // nothing queued before Stop() goes out after the next Start()
+    while (queue_.PopBatch(batch, BATCH_SAMPLES) > 0)
+        ;
+    CloseSockets();
+}
+
+void SamplePublisher::Send(const TelemetrySample* samples, size_t count)
+{
+    // every packet is encoded once and the same bytes go to every output
+    size_t packet_count = 0;
+    for (size_t first = 0; first < count; first += PUBLISH_MAX_SAMPLES)
+    {
+        packet_sizes_[packet_count] = EncodePublishPacket(samples + first, count - first, packet_sequence_++, packets_[packet_count]);
+        packet_count++;
+    }
+    samples_published_.fetch_add(count, std::memory_order_relaxed);
+
+    if (multicast_socket_ != NO_SOCKET)
+        SendMulticast(packet_count);
+
+    for (Subscriber& subscriber : subscribers_)
+    {
+        if (!subscriber.Upgraded)
+            continue;
+        for (size_t packet = 0; packet < packet_count; packet++)
+            Queue(subscriber, packets_[packet], packet_sizes_[packet]);
+    }
+}
+
+void SamplePublisher::SendMulticast(size_t packet_count)
+{
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config_.MulticastPort);
+    address.sin_addr.s_addr = multicast_group_;
+    size_t sent = 0;
+
+#if defined(__linux__)
+    mmsghdr messages[PACKETS_PER_SEND];
+    iovec vectors[PACKETS_PER_SEND];
+    for (size_t i = 0; i < packet_count; i++)
+    {
+        vectors[i].iov_base = packets_[i];
+        vectors[i].iov_len = packet_sizes_[i];
+        messages[i] = mmsghdr();
+        messages[i].msg_hdr.msg_name = &address;
+        messages[i].msg_hdr.msg_namelen = sizeof(address);
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    while (sent < packet_count)
+    {
+        int result = sendmmsg((SocketHandle)multicast_socket_, messages + sent, (unsigned)(packet_count - sent), 0);
+        if (result <= 0)
+            break;
+        sent += result;
+    }
+#else
+    for (; sent < packet_count; sent++)
+    {
+        if (sendto((SocketHandle)multicast_socket_, (const char*)packets_[sent], (int)packet_sizes_[sent], 0,
+            (const sockaddr*)&address, sizeof(address)) < 0)
+            break;
+    }
+#endif
+
+    packets_sent_.fetch_add(sent, std::memory_order_relaxed);
+    multicast_dropped_.fetch_add(packet_count - sent, std::memory_order_relaxed);
+}
+
+void SamplePublisher::AcceptSubscribers()
+{
+    if (listen_socket_ == NO_SOCKET)
+        return;
+
+    for (;;)
+    {
+        intptr_t socket = (intptr_t)accept((SocketHandle)listen_socket_, nullptr, nullptr);
+        if (socket == NO_SOCKET)
+            return;
+        if ((int)subscribers_.size() >= MAX_SUBSCRIBERS || !SetNonBlocking(socket))
+        {
+            CloseSocket(socket);
+            continue;
+        }
+        int on = 1;
+        setsockopt((SocketHandle)socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+        setsockopt((SocketHandle)socket, SOL_SOCKET, SO_SNDBUF, (const char*)&SUBSCRIBER_SOCKET_BUFFER, sizeof(SUBSCRIBER_SOCKET_BUFFER));
+        subscribers_.push_back({ socket, false, {}, {}, 0 });
+    }
+}
+
+void SamplePublisher::Queue(Subscriber& subscriber, const uint8_t* data, size_t length)
+{
+    // unmasked binary message; 126 + u16 length covers every packet
+    uint8_t header[4] = { 0x82, 0, 0, 0 };
+    size_t header_size = 2;
+    if (length < 126)
+        header[1] = (uint8_t)length;
+    else
+    {
+        header[1] = 126;
+        header[2] = (uint8_t)(length >> 8);
+        header[3] = (uint8_t)length;
+        header_size = 4;
+    }
+
+    if (subscriber.Out.size() - subscriber.OutSent + header_size + length > config_.SubscriberBufferBytes)
+    {
+        subscriber_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (subscriber.OutSent == subscriber.Out.size())
+    {
+        subscriber.Out.clear();
+        subscriber.OutSent = 0;
+    }
+    subscriber.Out.insert(subscriber.Out.end(), header, header + header_size);
+    subscriber.Out.insert(subscriber.Out.end(), data, data + length);
+}
+
+bool SamplePublisher::ReadSubscriber(Subscriber& subscriber)
+{
+    uint8_t buffer[4096];
+    for (;;)
+    {
+        int received = (int)recv((SocketHandle)subscriber.Socket, (char*)buffer, sizeof(buffer), 0);
+        if (received == 0)
+            return false;
+        if (received < 0)
+        {
+            if (!WouldBlock())
+                return false;
+            break;
+        }
+        subscriber.In.insert(subscriber.In.end(), buffer, buffer + received);
+        if (subscriber.In.size() > MAX_SUBSCRIBER_INPUT)
+            return false;
+    }
+
+    if (!subscriber.Upgraded)
+    {
+        std::string request(subscriber.In.begin(), subscriber.In.end());
+        size_t end = request.find("\r\n\r\n");
+        if (end == std::string::npos)
+            return true;
+        std::string key = HeaderValue(request.substr(0, end + 2), "Sec-WebSocket-Key");
+        if (request.compare(0, 4, "GET ") != 0 || key.empty())
+            return false;
+
+        std::string accept = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        uint8_t digest[20];
+        Sha1((const uint8_t*)accept.data(), accept.size(), digest);
+        std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+            "Sec-WebSocket-Accept: " + Base64(digest, sizeof(digest)) + "\r\n\r\n";
+        subscriber.Out.insert(subscriber.Out.end(), response.begin(), response.end());
+        subscriber.In.erase(subscriber.In.begin(), subscriber.In.begin() + end + 4);
+        subscriber.Upgraded = true;
+    }
+
+    // client frames: answer pings, stop at a close, ignore anything else
+    size_t at = 0;
+    const std::vector<uint8_t>& in = subscriber.In;
+    while (in.size() - at >= 2)
+    {
+        int opcode = in[at] & 0x0F;
+        bool masked = (in[at + 1] & 0x80) != 0;
+        uint64_t length = in[at + 1] & 0x7F;
+        size_t header = 2;
+        if (length == 126)
+        {
+            if (in.size() - at < 4)
+                break;
+            length = (uint64_t)in[at + 2] << 8 | in[at + 3];
+            header = 4;
+        }
+        else if (length == 127)
+            return false;   // nothing a subscriber should send is that long
+        if (masked)
+            header += 4;
+        if (in.size() - at < header + length)
+            break;
+
+        if (opcode == 0x8)
+            return false;
+        if (opcode == 0x9 && length <= 125)
+        {
+            uint8_t pong[2 + 125] = { 0x8A, (uint8_t)length };
+            for (size_t i = 0; i < length; i++)
+                pong[2 + i] = in[at + header + i] ^ (masked ? in[at + header - 4 + i % 4] : 0);
+            subscriber.Out.insert(subscriber.Out.end(), pong, pong + 2 + length);
+        }
+        at += header + (size_t)length;
+    }
+    subscriber.In.erase(subscriber.In.begin(), subscriber.In.begin() + at);
+    return true;
+}
+
+bool SamplePublisher::FlushSubscriber(Subscriber& subscriber)
+{
+    while (subscriber.OutSent < subscriber.Out.size())
+    {
+        int sent = (int)send((SocketHandle)subscriber.Socket, (const char*)subscriber.Out.data() + subscriber.OutSent,
+            (int)(subscriber.Out.size() - subscriber.OutSent), SEND_FLAGS);
+        if (sent < 0)
+            return WouldBlock();
+        subscriber.OutSent += sent;
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "publishProtocol.h"
+#include "spscRing.h"
+#include "telemetrySample.h"
+
+struct PublisherConfig
+{
+    std::string MulticastGroup = "239.255.76.1";    // empty: no multicast
+    uint16_t MulticastPort = 7600;
+    std::string MulticastInterface = "127.0.0.1";   // local address sent from; loopback keeps it on this machine
+    int MulticastTtl = 1;
+    uint16_t WebSocketPort = 0;                     // 0: no WebSocket server
+    bool WebSocketLoopbackOnly = true;              // listen on 127.0.0.1 rather than every interface
+    size_t SubscriberBufferBytes = 256 * 1024;      // per WebSocket subscriber; packets beyond it are dropped for it
+};
+
+// Fans decoded samples out to other tools at the ground station (antenna tracker, recovery
+// laptops, notebooks) as PublishProtocol packets: UDP multicast datagrams, and binary messages
+// to WebSocket subscribers.
+//
+// The ingest's merge step hands samples over through a lock-free ring, like FlightRecorder; a
+// dedicated thread wakes as soon as there are some, packs everything queued into packets once
+// and sends them, through sendmmsg() in a single call where the platform has it. Batches form
+// by themselves under load; a lone sample goes out at once.
+//
+// Nothing downstream can slow ingest: a full ring drops samples, a full socket buffer drops
+// datagrams, and each WebSocket subscriber has its own bounded buffer whose overflow drops that
+// subscriber's packets only. Every drop is counted; subscribers see them as sequence gaps.
+class SamplePublisher
+{
+public:
+    static const size_t QUEUE_CAPACITY = 4096;
+    static const size_t PACKETS_PER_SEND = 16;
+    static const int MAX_SUBSCRIBERS = 16;
+
+    SamplePublisher();
+    ~SamplePublisher();
+
+    // Opens the configured outputs and starts the publisher thread. Fails if any of them cannot be opened.
+    bool Start(const PublisherConfig& config);
+    void Stop();
+    bool Running() const { return running_.load(std::memory_order_relaxed); }
+
+    // One producer at a time (the ingest serializes its link threads). Never blocks.
+    void PublishSample(const TelemetrySample& sample);
+
+    uint64_t SamplesPublished() const { return samples_published_.load(std::memory_order_relaxed); }
+    uint64_t SamplesDropped() const { return samples_dropped_.load(std::memory_order_relaxed); }
+    uint64_t PacketsSent() const { return packets_sent_.load(std::memory_order_relaxed); }
+    // datagrams the multicast socket had no room for
+    uint64_t MulticastDropped() const { return multicast_dropped_.load(std::memory_order_relaxed); }
+    // packets not queued to a WebSocket subscriber that was too far behind, over all subscribers
+    uint64_t SubscriberDropped() const { return subscriber_dropped_.load(std::memory_order_relaxed); }
+    int Subscribers() const { return subscriber_count_.load(std::memory_order_relaxed); }
+
+private:
+    struct Subscriber
+    {
+        intptr_t Socket;
+        bool Upgraded;              // past the HTTP handshake
+        std::vector<uint8_t> In;
+        std::vector<uint8_t> Out;
+        size_t OutSent;
+    };
+
+    void Run();
+    bool WaitForSamples(uint32_t timeout_ms);
+    void Send(const TelemetrySample* samples, size_t count);
+    void SendMulticast(size_t packet_count);
+    void AcceptSubscribers();
+    bool ReadSubscriber(Subscriber& subscriber);
+    bool FlushSubscriber(Subscriber& subscriber);
+    void Queue(Subscriber& subscriber, const uint8_t* data, size_t length);
+    void CloseSockets();
+
+    PublisherConfig config_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+
+    intptr_t multicast_socket_;
+    uint32_t multicast_group_;          // IPv4 address, network byte order
+    intptr_t listen_socket_;
+    std::vector<Subscriber> subscribers_;
+
+    uint32_t packet_sequence_;
+    uint8_t packets_[PACKETS_PER_SEND][PUBLISH_MAX_PACKET_SIZE];
+    size_t packet_sizes_[PACKETS_PER_SEND];
+
+    std::atomic<uint64_t> samples_published_;
+    std::atomic<uint64_t> samples_dropped_;
+    std::atomic<uint64_t> packets_sent_;
+    std::atomic<uint64_t> multicast_dropped_;
+    std::atomic<uint64_t> subscriber_dropped_;
+    std::atomic<int> subscriber_count_;
+
+    SpscRing<TelemetrySample, QUEUE_CAPACITY> queue_;
+    // the producer only takes wake_mutex_ to wake the publisher thread when it said it is waiting
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> waiting_;
+};
@@ -0,0 +1,40 @@
+#include "serialSource.h"
+#include "latencyHistogram.h"
+
+SerialSource::SerialSource(SimpleSerial& serial)
+    : serial_(serial), port_("Serial"), origin_ns_(0)
+{
+}
+
+// Windows wants "\\.\COM10" for ports past COM9; the prefix works for every port
+static std::string DevicePath(const std::string& port)
+{
+#ifdef _WIN32
+    if (port.compare(0, 4, "\\\\.\\") != 0)
+        return "\\\\.\\" + port;
+#endif
+    return port;
+}
+
+SerialSource::SerialSource(const std::string& port, DWORD baud_rate)
+    : owned_(new SimpleSerial(&DevicePath(port)[0], baud_rate)), serial_(*owned_), port_(port), origin_ns_(0)
+{
+}
+
+void SerialSource::Begin()
+{
+    origin_ns_ = MonotonicNanoseconds();
+}
+
+int SerialSource::Read(uint8_t* buffer, size_t length, uint32_t timeout_ms, uint64_t& timeline_ns)
+{
+    int bytes_read = serial_.ReadSerialBytes(timeout_ms, (char*)buffer, length);
+    timeline_ns = MonotonicNanoseconds() - origin_ns_;
+    return bytes_read;
+}
+
+bool SerialSource::Write(const char* data)
+{
+    std::string command(data);
+    return serial_.WriteSerialPort(&command[0]);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <simple-serial-port/simple-serial-port/SimpleSerial.h>
+#include "telemetrySource.h"
+
+// Live telemetry from the radio on a serial port.
+class SerialSource : public TelemetrySource
+{
+public:
+    explicit SerialSource(SimpleSerial& serial);
+    // Opens port itself ("COM5" / "\\\\.\\COM5" on Windows, a device path on POSIX); check Connected().
+    SerialSource(const std::string& port, DWORD baud_rate);
+
+    const char* Name() const override { return port_.c_str(); }
+    bool Connected() const override { return serial_.connected_; }
+    void Begin() override;
+    int Read(uint8_t* buffer, size_t length, uint32_t timeout_ms, uint64_t& timeline_ns) override;
+    bool Write(const char* data) override;
+    void Interrupt() override { serial_.InterruptRead(); }
+
+private:
+    std::unique_ptr<SimpleSerial> owned_;
+    SimpleSerial& serial_;
+    std::string port_;
+    uint64_t origin_ns_;
+};
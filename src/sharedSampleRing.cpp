@@ -0,0 +1,337 @@
+#include "sharedSampleRing.h"
+#include <atomic>
+#include <new>
+#include <string.h>
+#include "latencyHistogram.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct alignas(64) SharedRingHeader
+{
+    uint32_t Magic;
+    uint16_t Version;
+    uint8_t ChannelCount;
+    uint8_t EstimateCount;
+    uint32_t SampleSize;
+    uint32_t SlotSize;
+    uint64_t Capacity;
+    uint64_t Session;
+    std::atomic<uint32_t> WriterOpen;
+    // readers poll it; keep it off the line holding the fields above
+    alignas(64) std::atomic<uint64_t> Head;
+};
+static_assert(sizeof(SharedRingHeader) == 128, "slots start at byte 128");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring's atomics must work across processes");
+
+static const size_t SAMPLE_WORDS = (sizeof(TelemetrySample) + 7) / 8;
+// a whole number of cache lines, so the slot being written never shares one with a slot being read
+static const size_t SLOT_SIZE = (8 * (1 + SAMPLE_WORDS) + 63) / 64 * 64;
+
+static SharedRingHeader* Header(uint8_t* data) { return reinterpret_cast<SharedRingHeader*>(data); }
+static const SharedRingHeader* Header(const uint8_t* data) { return reinterpret_cast<const SharedRingHeader*>(data); }
+
+// Word 0 is the slot's sequence, the sample follows.
+static std::atomic<uint64_t>* Slot(uint8_t* slots, size_t mask, uint64_t n)
+{
+    return reinterpret_cast<std::atomic<uint64_t>*>(slots + (n & mask) * SLOT_SIZE);
+}
+
+static const std::atomic<uint64_t>* Slot(const uint8_t* slots, size_t mask, uint64_t n)
+{
+    return reinterpret_cast<const std::atomic<uint64_t>*>(slots + (n & mask) * SLOT_SIZE);
+}
+
+#ifdef _WIN32
+
+SharedRingMapping::SharedRingMapping()
+    : mapping_(nullptr), data_(nullptr), size_(0)
+{
+}
+
+bool SharedRingMapping::Create(const std::string& name, size_t size)
+{
+    Close();
+    std::string path = "Local\\" + name;
+    mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32),
+        (DWORD)size, path.c_str());
+    if (!mapping_ || GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        Close();
+        return false;
+    }
+    data_ = (uint8_t*)MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!data_)
+    {
+        Close();
+        return false;
+    }
+    size_ = size;
+    return true;
+}
+
+bool SharedRingMapping::OpenRead(const std::string& name)
+{
+    Close();
+    std::string path = "Local\\" + name;
+    mapping_ = OpenFileMappingA(FILE_MAP_READ, FALSE, path.c_str());
+    if (!mapping_)
+        return false;
+    data_ = (uint8_t*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION region;
+    if (!data_ || VirtualQuery(data_, &region, sizeof(region)) == 0)
+    {
+        Close();
+        return false;
+    }
+    size_ = region.RegionSize;
+    return true;
+}
+
+void SharedRingMapping::Close()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    mapping_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#else
+
+SharedRingMapping::SharedRingMapping()
+    : data_(nullptr), size_(0)
+{
+}
+
+bool SharedRingMapping::Create(const std::string& name, size_t size)
+{
+    Close();
+    // readers of the old ring keep their mapping; they see it closed
+    std::string path = "/" + name;
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        return false;
+    void* data = ftruncate(fd, (off_t)size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        shm_unlink(path.c_str());
+        return false;
+    }
+    data_ = (uint8_t*)data;
+    size_ = size;
+    unlink_name_ = path;
+    return true;
+}
+
+bool SharedRingMapping::OpenRead(const std::string& name)
+{
+    Close();
+    std::string path = "/" + name;
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void* data = fstat(fd, &info) == 0 && info.st_size > 0
+        ? mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    data_ = (uint8_t*)data;
+    size_ = (size_t)info.st_size;
+    return true;
+}
+
+void SharedRingMapping::Close()
+{
+    if (data_)
+        munmap(data_, size_);
+    if (!unlink_name_.empty())
+        shm_unlink(unlink_name_.c_str());
+    unlink_name_.clear();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
+
+SharedRingMapping::~SharedRingMapping()
+{
+    Close();
+}
+
+SharedSampleWriter::SharedSampleWriter()
+    : slots_(nullptr), mask_(0), written_(0)
+{
+}
+
+SharedSampleWriter::~SharedSampleWriter()
+{
+    Close();
+}
+
+bool SharedSampleWriter::Open(const std::string& name, size_t capacity)
+{
+    Close();
+    size_t slots = 1;
+    while (slots < capacity)
+        slots <<= 1;
+    if (!mapping_.Create(name, sizeof(SharedRingHeader) + slots * SLOT_SIZE))
+        return false;
+
+    SharedRingHeader* header = new (mapping_.Data()) SharedRingHeader();
+    header->Magic = SHARED_RING_MAGIC;
+    header->Version = SHARED_RING_VERSION;
+    header->ChannelCount = (uint8_t)Channel_COUNT;
+    header->EstimateCount = (uint8_t)Estimate_COUNT;
+    header->SampleSize = (uint32_t)sizeof(TelemetrySample);
+    header->SlotSize = (uint32_t)SLOT_SIZE;
+    header->Capacity = slots;
+    header->Session = MonotonicNanoseconds();
+    header->Head.store(0, std::memory_order_relaxed);
+    // readers check this first: everything above is in place once it reads 1
+    header->WriterOpen.store(1, std::memory_order_release);
+
+    slots_ = mapping_.Data() + sizeof(SharedRingHeader);
+    mask_ = slots - 1;
+    written_.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void SharedSampleWriter::Close()
+{
+    if (!IsOpen())
+        return;
+    Header(mapping_.Data())->WriterOpen.store(0, std::memory_order_release);
+    mapping_.Close();
+    slots_ = nullptr;
+}
+
+void SharedSampleWriter::Write(const TelemetrySample& sample)
+{
+    if (!slots_)
+        return;
+
+    uint64_t words[SAMPLE_WORDS] = {};
+    memcpy(words, &sample, sizeof(sample));
+
+    uint64_t n = written_.load(std::memory_order_relaxed);
+    std::atomic<uint64_t>* slot = Slot(slots_, mask_, n);
+    slot[0].store(2 * n + 1, std::memory_order_relaxed);
+    // a reader that sees any of the new words also sees the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < SAMPLE_WORDS; i++)
+        slot[1 + i].store(words[i], std::memory_order_relaxed);
+    slot[0].store(2 * n + 2, std::memory_order_release);
+
+    written_.store(n + 1, std::memory_order_relaxed);
+    Header(mapping_.Data())->Head.store(n + 1, std::memory_order_release);
+}
+
+SharedSampleReader::SharedSampleReader()
+    : slots_(nullptr), mask_(0), next_(0), overruns_(0)
+{
+}
+
+bool SharedSampleReader::Open(const std::string& name, bool from_oldest)
+{
+    Close();
+    if (!mapping_.OpenRead(name))
+        return false;
+
+    const SharedRingHeader* header = Header((const uint8_t*)mapping_.Data());
+    bool valid = mapping_.Size() >= sizeof(SharedRingHeader) && header->WriterOpen.load(std::memory_order_acquire) == 1
+        && header->Magic == SHARED_RING_MAGIC && header->Version == SHARED_RING_VERSION
+        && header->ChannelCount == Channel_COUNT && header->EstimateCount == Estimate_COUNT
+        && header->SampleSize == sizeof(TelemetrySample) && header->SlotSize == SLOT_SIZE
+        && header->Capacity != 0 && (header->Capacity & (header->Capacity - 1)) == 0
+        && header->Capacity <= (mapping_.Size() - sizeof(SharedRingHeader)) / SLOT_SIZE;
+    if (!valid)
+    {
+        Close();
+        return false;
+    }
+
+    slots_ = mapping_.Data() + sizeof(SharedRingHeader);
+    mask_ = (size_t)header->Capacity - 1;
+    uint64_t head = header->Head.load(std::memory_order_acquire);
+    next_ = !from_oldest ? head : head > header->Capacity ? head - header->Capacity : 0;
+    overruns_ = 0;
+    return true;
+}
+
+void SharedSampleReader::Close()
+{
+    mapping_.Close();
+    slots_ = nullptr;
+}
+
+size_t SharedSampleReader::Read(TelemetrySample* out, size_t max_count)
+{
+    if (!slots_)
+        return 0;
+
+    const std::atomic<uint64_t>& head_counter = Header((const uint8_t*)mapping_.Data())->Head;
+    uint64_t capacity = (uint64_t)mask_ + 1;
+    uint64_t head = head_counter.load(std::memory_order_acquire);
+    size_t count = 0;
+    while (count < max_count && next_ < head)
+    {
+        if (head - next_ > capacity)
+        {
+            overruns_ += head - capacity - next_;
+            next_ = head - capacity;
+        }
+
+        const std::atomic<uint64_t>* slot = Slot(slots_, mask_, next_);
+        uint64_t expected = 2 * next_ + 2;
+        if (slot[0].load(std::memory_order_acquire) == expected)
+        {
+            uint64_t words[SAMPLE_WORDS];
+            for (size_t i = 0; i < SAMPLE_WORDS; i++)
+                words[i] = slot[1 + i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot[0].load(std::memory_order_relaxed) == expected)
+            {
+                memcpy(&out[count++], words, sizeof(TelemetrySample));
+                next_++;
+                continue;
+            }
+        }
+
+        // the writer lapped us while we copied. Resuming right behind it would only lose the race
+        // again, so give up the older half of the ring.
+        head = head_counter.load(std::memory_order_acquire);
+        uint64_t resume = head >= capacity / 2 ? head - capacity / 2 : 0;
+        overruns_ += resume > next_ ? resume - next_ : 1;
+        next_ = resume > next_ ? resume : next_ + 1;
+    }
+    return count;
+}
+
+uint64_t SharedSampleReader::Pending() const
+{
+    if (!slots_)
+        return 0;
+    return Header((const uint8_t*)mapping_.Data())->Head.load(std::memory_order_acquire) - next_;
+}
+
+bool SharedSampleReader::WriterOpen() const
+{
+    return slots_ && Header((const uint8_t*)mapping_.Data())->WriterOpen.load(std::memory_order_acquire) == 1;
+}
+
+uint64_t SharedSampleReader::Session() const
+{
+    return slots_ ? Header((const uint8_t*)mapping_.Data())->Session : 0;
+}
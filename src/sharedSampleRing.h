@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "telemetrySample.h"
+
+// Decoded samples in a named shared-memory ring, for analysis processes on the same machine.
+// One writer (the ingest thread) and any number of readers; readers never write to the mapping,
+// take no locks and make no system calls, so they cannot slow the writer or each other. A reader
+// that falls more than a ring behind skips what was overwritten and counts it.
+//
+// The name maps to POSIX shared memory "/<name>" (shm_open), or to "Local\<name>" on Windows.
+//
+// Layout (native byte order, the writer's build):
+//   header, 64 bytes
+//     u32 magic           SHARED_RING_MAGIC
+//     u16 version         SHARED_RING_VERSION
+//     u8  channel count   Channel_COUNT of the writer
+//     u8  estimate count  Estimate_COUNT of the writer
+//     u32 sample size     sizeof(TelemetrySample) of the writer
+//     u32 slot size       bytes per slot
+//     u64 capacity        slots, a power of two
+//     u64 session         MonotonicNanoseconds() when the writer opened the ring
+//     u32 writer open     1 until the writer closes the ring
+//   u64 head, alone in the next 64 bytes: samples written so far
+//   slots from byte 128; sample n lives in slot n % capacity:
+//     u64 sequence        2n + 1 while sample n is being written, 2n + 2 once it is complete
+//     TelemetrySample     padded to a whole number of u64 words
+//
+// A reader copies a slot between two loads of its sequence and keeps the copy only if both show
+// the sample it wanted, complete: a seqlock per slot.
+//
+// The ring is shared only between builds with the same TelemetrySample; Open() on the reader
+// checks the counts and sizes in the header and refuses anything else.
+
+static const uint32_t SHARED_RING_MAGIC = 0x52535654;   // "TVSR"
+static const uint16_t SHARED_RING_VERSION = 1;
+static const char SHARED_RING_DEFAULT_NAME[] = "telemetryview";
+
+class SharedRingMapping
+{
+public:
+    SharedRingMapping();
+    ~SharedRingMapping();
+
+    SharedRingMapping(const SharedRingMapping&) = delete;
+    SharedRingMapping& operator=(const SharedRingMapping&) = delete;
+
+    // Replaces any ring of that name with a new one of size bytes, zero-filled, read/write. On
+    // Windows the name lives as long as anyone maps it, so this fails while readers still hold a
+    // previous ring.
+    bool Create(const std::string& name, size_t size);
+    // Maps an existing ring read-only.
+    bool OpenRead(const std::string& name);
+    void Close();
+
+    uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+private:
+#ifdef _WIN32
+    void* mapping_;
+#else
+    std::string unlink_name_;   // set on the side that created it
+#endif
+    uint8_t* data_;
+    size_t size_;
+};
+
+// Writer side; one thread at a time.
+class SharedSampleWriter
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 65536;   // a minute at 1 kHz, ~8 MB
+
+    SharedSampleWriter();
+    ~SharedSampleWriter();
+
+    // capacity is rounded up to a power of two. Readers of a previous ring of that name see it
+    // closed and have to open the new one.
+    bool Open(const std::string& name, size_t capacity = DEFAULT_CAPACITY);
+    void Close();
+    bool IsOpen() const { return mapping_.Data() != nullptr; }
+
+    // Never blocks and makes no system calls; overwrites the oldest sample once the ring is full.
+    void Write(const TelemetrySample& sample);
+    // any thread
+    uint64_t SamplesWritten() const { return written_.load(std::memory_order_relaxed); }
+
+private:
+    SharedRingMapping mapping_;
+    uint8_t* slots_;
+    size_t mask_;
+    std::atomic<uint64_t> written_;
+};
+
+// Reader side, in any process; each reader has its own position and one thread at a time may use it.
+class SharedSampleReader
+{
+public:
+    SharedSampleReader();
+
+    // Maps the ring and starts after its newest sample, or at its oldest with from_oldest. False if
+    // there is no ring of that name or it was written by a build with another TelemetrySample.
+    bool Open(const std::string& name, bool from_oldest = false);
+    void Close();
+    bool IsOpen() const { return mapping_.Data() != nullptr; }
+
+    // Copies up to max_count samples written since the last call into out, oldest first.
+    // Samples overwritten before they could be copied are skipped and added to Overruns().
+    size_t Read(TelemetrySample* out, size_t max_count);
+    // Samples written and not read yet (overwritten ones included).
+    uint64_t Pending() const;
+
+    uint64_t Overruns() const { return overruns_; }
+    // False once the writer has closed the ring; a restarted writer makes a new one to Open().
+    bool WriterOpen() const;
+    uint64_t Session() const;
+
+private:
+    SharedRingMapping mapping_;
+    const uint8_t* slots_;
+    size_t mask_;
+    uint64_t next_;
+    uint64_t overruns_;
+};
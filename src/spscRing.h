@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+// Lock-free single-producer/single-consumer ring buffer.
+// Exactly one thread may call Push() and exactly one other thread may call PopBatch().
+// Head and tail are free running counters, so all Capacity slots are usable.
+template<typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head_(0), tail_(0), cached_tail_(0), cached_head_(0) {}
+
+    // Producer side. Returns false (and drops the item) when the ring is full.
+    bool Push(const T& item)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ == Capacity)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ == Capacity)
+                return false;
+        }
+        items_[head & (Capacity - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Copies up to max_count items into out and returns how many were copied.
+    size_t PopBatch(T* out, size_t max_count)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (cached_head_ == tail)
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (cached_head_ == tail)
+                return 0;
+        }
+
+        size_t count = cached_head_ - tail;
+        if (count > max_count)
+            count = max_count;
+        for (size_t i = 0; i < count; i++)
+            out[i] = items_[(tail + i) & (Capacity - 1)];
+
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Approximate number of queued items, safe to call from either side.
+    size_t Size() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    // Producer and consumer indices live on separate cache lines so the two threads do not false share.
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) size_t cached_tail_;    // producer's last view of tail_
+    alignas(64) size_t cached_head_;    // consumer's last view of head_
+    alignas(64) T items_[Capacity];
+};
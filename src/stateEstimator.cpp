@@ -0,0 +1,181 @@
+#include "stateEstimator.h"
+#include <math.h>
+
+static const float GRAVITY = 9.80665f;
+static const float RAD_TO_DEG = 57.2957795f;
+
+// Longer than this without a sample and the altitude filter starts over from the barometer.
+static const double MAX_GAP_SECONDS = 1.0;
+
+StateEstimator::StateEstimator(const StateEstimatorConfig& config)
+    : config_(config)
+{
+    Reset();
+}
+
+void StateEstimator::Reset()
+{
+    started_ = false;
+    start_time_ = 0.0;
+    last_time_ = 0.0;
+    q_[0] = 1.0f;
+    q_[1] = q_[2] = q_[3] = 0.0f;
+    integral_[0] = integral_[1] = integral_[2] = 0.0f;
+    x_ = Matrix<3, 1>::Zero();
+    p_ = Matrix<3, 3>::Identity();
+}
+
+void StateEstimator::Update(TelemetrySample& sample)
+{
+    double time = RocketSeconds(sample);
+    if (started_ && time < last_time_)
+        Reset();
+
+    if (!started_)
+    {
+        start_time_ = time;
+        StartKalman(sample.altitude);
+    }
+    else if (time - last_time_ > MAX_GAP_SECONDS)
+        StartKalman(sample.altitude);
+    else if (time > last_time_)
+    {
+        float dt = (float)(time - last_time_);
+        float gain = time - start_time_ < config_.SettleSeconds ? config_.SettleGain : config_.AttitudeGain;
+        UpdateAttitude(sample, dt, gain);
+        UpdateKalman(sample.altitude, VerticalAcceleration(sample), dt);
+    }
+    started_ = true;
+    last_time_ = time;
+
+    const float q0 = q_[0], q1 = q_[1], q2 = q_[2], q3 = q_[3];
+    sample.filteredAltitude = x_(0, 0);
+    sample.verticalVelocity = x_(1, 0);
+    sample.roll = atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * RAD_TO_DEG;
+    sample.pitch = asinf(fmaxf(-1.0f, fminf(1.0f, 2.0f * (q0 * q2 - q3 * q1)))) * RAD_TO_DEG;
+    sample.yaw = atan2f(2.0f * (q0 * q3 + q1 * q2), 1.0f - 2.0f * (q2 * q2 + q3 * q3)) * RAD_TO_DEG;
+}
+
+void StateEstimator::UpdateAttitude(const TelemetrySample& sample, float dt, float gain)
+{
+    float rate_scale = config_.GyroDegreesPerLsb / RAD_TO_DEG;
+    float gx = sample.xOrient * rate_scale;
+    float gy = sample.yOrient * rate_scale;
+    float gz = sample.zOrient * rate_scale;
+    float q0 = q_[0], q1 = q_[1], q2 = q_[2], q3 = q_[3];
+
+    // correct towards gravity (and magnetic north) only when the accelerometer is measuring gravity
+    float ax = sample.xAccel, ay = sample.yAccel, az = sample.zAccel;
+    float accel_norm = sqrtf(ax * ax + ay * ay + az * az);
+    if (accel_norm > 0.0f && fabsf(accel_norm * 1e-3f - 1.0f) < config_.AccelGate)
+    {
+        ax /= accel_norm;
+        ay /= accel_norm;
+        az /= accel_norm;
+
+        // gravity direction predicted by the attitude, and the error to the measured one
+        float vx = q1 * q3 - q0 * q2;
+        float vy = q0 * q1 + q2 * q3;
+        float vz = q0 * q0 - 0.5f + q3 * q3;
+        float ex = ay * vz - az * vy;
+        float ey = az * vx - ax * vz;
+        float ez = ax * vy - ay * vx;
+
+        float mx = sample.xMag, my = sample.yMag, mz = sample.zMag;
+        float mag_norm = sqrtf(mx * mx + my * my + mz * mz);
+        if (mag_norm > 0.0f)
+        {
+            mx /= mag_norm;
+            my /= mag_norm;
+            mz /= mag_norm;
+
+            // earth field in the earth frame, rotated to horizontal north + vertical, then back to
+            // the sensor frame
+            float hx = 2.0f * (mx * (0.5f - q2 * q2 - q3 * q3) + my * (q1 * q2 - q0 * q3) + mz * (q1 * q3 + q0 * q2));
+            float hy = 2.0f * (mx * (q1 * q2 + q0 * q3) + my * (0.5f - q1 * q1 - q3 * q3) + mz * (q2 * q3 - q0 * q1));
+            float bx = sqrtf(hx * hx + hy * hy);
+            float bz = 2.0f * (mx * (q1 * q3 - q0 * q2) + my * (q2 * q3 + q0 * q1) + mz * (0.5f - q1 * q1 - q2 * q2));
+            float wx = bx * (0.5f - q2 * q2 - q3 * q3) + bz * (q1 * q3 - q0 * q2);
+            float wy = bx * (q1 * q2 - q0 * q3) + bz * (q0 * q1 + q2 * q3);
+            float wz = bx * (q0 * q2 + q1 * q3) + bz * (0.5f - q1 * q1 - q2 * q2);
+            ex += my * wz - mz * wy;
+            ey += mz * wx - mx * wz;
+            ez += mx * wy - my * wx;
+        }
+
+        if (config_.AttitudeIntegralGain > 0.0f)
+        {
+            integral_[0] += 2.0f * config_.AttitudeIntegralGain * ex * dt;
+            integral_[1] += 2.0f * config_.AttitudeIntegralGain * ey * dt;
+            integral_[2] += 2.0f * config_.AttitudeIntegralGain * ez * dt;
+            gx += integral_[0];
+            gy += integral_[1];
+            gz += integral_[2];
+        }
+        gx += 2.0f * gain * ex;
+        gy += 2.0f * gain * ey;
+        gz += 2.0f * gain * ez;
+    }
+
+    // integrate the quaternion rate
+    gx *= 0.5f * dt;
+    gy *= 0.5f * dt;
+    gz *= 0.5f * dt;
+    q_[0] = q0 + (-q1 * gx - q2 * gy - q3 * gz);
+    q_[1] = q1 + (q0 * gx + q2 * gz - q3 * gy);
+    q_[2] = q2 + (q0 * gy - q1 * gz + q3 * gx);
+    q_[3] = q3 + (q0 * gz + q1 * gy - q2 * gx);
+
+    float norm = sqrtf(q_[0] * q_[0] + q_[1] * q_[1] + q_[2] * q_[2] + q_[3] * q_[3]);
+    for (float& q : q_)
+        q /= norm;
+}
+
+float StateEstimator::VerticalAcceleration(const TelemetrySample& sample) const
+{
+    // earth vertical in the sensor frame; the specific force along it, less gravity
+    const float q0 = q_[0], q1 = q_[1], q2 = q_[2], q3 = q_[3];
+    float vx = 2.0f * (q1 * q3 - q0 * q2);
+    float vy = 2.0f * (q0 * q1 + q2 * q3);
+    float vz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+    return (sample.xAccel * vx + sample.yAccel * vy + sample.zAccel * vz) * ACCEL_MPS2 - GRAVITY;
+}
+
+void StateEstimator::StartKalman(float altitude)
+{
+    x_ = Matrix<3, 1>::Zero();
+    x_(0, 0) = altitude;
+    p_ = Matrix<3, 3>::Zero();
+    p_(0, 0) = config_.BaroSigma * config_.BaroSigma;
+    p_(1, 1) = 1.0f;
+    p_(2, 2) = 0.25f;
+}
+
+void StateEstimator::UpdateKalman(float altitude, float acceleration, float dt)
+{
+    // predict: altitude += v dt + (a - bias) dt^2 / 2, v += (a - bias) dt, bias random walk
+    Matrix<3, 3> f = Matrix<3, 3>::Identity();
+    f(0, 1) = dt;
+    f(0, 2) = -0.5f * dt * dt;
+    f(1, 2) = -dt;
+    Matrix<3, 1> g = Matrix<3, 1>::Zero();
+    g(0, 0) = 0.5f * dt * dt;
+    g(1, 0) = dt;
+
+    Matrix<3, 3> q = g * g.Transposed() * (config_.AccelSigma * config_.AccelSigma);
+    q(2, 2) += config_.AccelBiasSigma * config_.AccelBiasSigma * dt;
+    x_ = f * x_ + g * acceleration;
+    p_ = f * p_ * f.Transposed() + q;
+
+    // correct with the barometer
+    Matrix<1, 3> h = Matrix<1, 3>::Zero();
+    h(0, 0) = 1.0f;
+    float innovation = altitude - x_(0, 0);
+    float s = (h * p_ * h.Transposed())(0, 0) + config_.BaroSigma * config_.BaroSigma;
+    Matrix<3, 1> k = p_ * h.Transposed() * (1.0f / s);
+    x_ = x_ + k * innovation;
+    p_ = (Matrix<3, 3>::Identity() - k * h) * p_;
+
+    // keep the covariance symmetric against rounding
+    p_ = (p_ + p_.Transposed()) * 0.5f;
+}
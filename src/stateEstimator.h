@@ -0,0 +1,59 @@
+#pragma once
+
+#include "fixedMatrix.h"
+#include "telemetrySample.h"
+
+struct StateEstimatorConfig
+{
+    float GyroDegreesPerLsb = 1.0f / 16.4f; // gyro channels; MPU-6050 at +/-2000 deg/s
+    float AttitudeGain = 1.0f;              // Mahony proportional gain, 1/s
+    float AttitudeIntegralGain = 0.0f;      // Mahony integral gain (gyro bias), 1/s^2; 0 = off
+    float SettleGain = 10.0f;               // proportional gain for the first SettleSeconds, to
+    float SettleSeconds = 2.0f;             //   converge from level on power-up
+    float AccelGate = 0.15f;                // skip attitude correction when |accel| is further than this from 1 g
+    float BaroSigma = 1.0f;                 // altitude measurement noise, m
+    float AccelSigma = 0.5f;                // vertical acceleration noise, m/s^2
+    float AccelBiasSigma = 0.02f;           // accelerometer bias random walk, m/s^2 per sqrt(s)
+};
+
+// Ground-side state estimation for every decoded sample: fills the ESTIMATED_CHANNELS fields.
+//
+// Attitude: Mahony complementary filter on the gyro, accelerometer and magnetometer channels. The
+// accelerometer only corrects the attitude while it reads close to 1 g, so thrust and parachute
+// shocks do not pull the horizon.
+// Altitude and vertical velocity: Kalman filter over [altitude, velocity, accelerometer bias],
+// predicted with the accelerometer's vertical component (through the attitude) and corrected
+// with the barometric altitude.
+//
+// Fixed-size state, no allocation; a few hundred flops per sample.
+class StateEstimator
+{
+public:
+    explicit StateEstimator(const StateEstimatorConfig& config = StateEstimatorConfig());
+
+    void SetConfig(const StateEstimatorConfig& config) { config_ = config; }
+    void Reset();
+
+    // Writes the estimated channels of sample, from its raw channels and everything before it.
+    // A rocket clock that steps back (reboot) or a gap over a second restarts the filters.
+    void Update(TelemetrySample& sample);
+
+private:
+    void UpdateAttitude(const TelemetrySample& sample, float dt, float gain);
+    float VerticalAcceleration(const TelemetrySample& sample) const;
+    void StartKalman(float altitude);
+    void UpdateKalman(float altitude, float acceleration, float dt);
+
+    StateEstimatorConfig config_;
+    bool started_;
+    double start_time_;
+    double last_time_;
+
+    // attitude, sensor frame to earth frame, and the Mahony integral term
+    float q_[4];
+    float integral_[3];
+
+    // [altitude, vertical velocity, accelerometer bias] and its covariance
+    Matrix<3, 1> x_;
+    Matrix<3, 3> p_;
+};
@@ -0,0 +1,108 @@
+#include "storeFeed.h"
+#include "latencyHistogram.h"
+
+StoreFeed::StoreFeed(TelemetryIngest& ingest, TelemetryStore& store)
+    : ingest_(ingest), store_(store), running_(false), samples_stored_(0), samples_rejected_(0),
+      stats_(STORE_COLUMN_COUNT), stats_window_(ChannelStatsConfig().WindowSeconds), summaries_(), sample_rate_(0.0f)
+{
+}
+
+StoreFeed::~StoreFeed()
+{
+    Stop();
+}
+
+void StoreFeed::Start()
+{
+    if (running_.exchange(true))
+        return;
+
+    derived_.Reset();
+    stats_.Reset();
+    {
+        std::lock_guard<std::mutex> lock(status_mutex_);
+        rocket_clock_.Reset();
+        for (ChannelSummary& summary : summaries_)
+            summary = ChannelSummary();
+        sample_rate_ = 0.0f;
+    }
+    samples_stored_.store(0);
+    samples_rejected_.store(0);
+    thread_ = std::thread(&StoreFeed::Run, this);
+}
+
+void StoreFeed::Stop()
+{
+    running_.store(false);
+    if (thread_.joinable())
+        thread_.join();
+}
+
+ClockAlignment StoreFeed::RocketClock() const
+{
+    std::lock_guard<std::mutex> lock(status_mutex_);
+    return rocket_clock_;
+}
+
+float StoreFeed::ChannelSummaries(ChannelSummary* out) const
+{
+    std::lock_guard<std::mutex> lock(status_mutex_);
+    for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+        out[column] = summaries_[column];
+    return sample_rate_;
+}
+
+void StoreFeed::Run()
+{
+    TelemetrySample batch[BATCH_SAMPLES];
+    SampleStamps stamps[BATCH_SAMPLES];
+
+    while (running_.load(std::memory_order_relaxed))
+    {
+        // bounded so Stop() is noticed while the link is quiet
+        if (!ingest_.WaitForSamples(100))
+            continue;
+
+        float window = stats_window_.load(std::memory_order_relaxed);
+        if (window != stats_.Window(0))
+        {
+            for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+                stats_.SetWindow(column, window);
+        }
+
+        size_t count;
+        while (running_.load(std::memory_order_relaxed) && (count = ingest_.Drain(batch, BATCH_SAMPLES)) > 0)
+        {
+            size_t stored = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                const TelemetrySample& sample = batch[i];
+                float row[STORE_COLUMN_COUNT];
+                derived_.Evaluate(sample, RocketSeconds(sample), row);
+                if (!store_.Append(sample.hostTime, row))
+                {
+                    // full: the rest of the batch cannot go in either
+                    samples_rejected_.fetch_add(count - i, std::memory_order_relaxed);
+                    break;
+                }
+                stats_.Add(sample.hostTime, row);
+                stamps[stored++] = { sample.arrivalNs, sample.parsedNs, MonotonicNanoseconds() };
+            }
+            {
+                std::lock_guard<std::mutex> lock(status_mutex_);
+                for (size_t i = 0; i < count; i++)
+                    rocket_clock_.Update(RocketSeconds(batch[i]), batch[i].hostTime);
+                for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+                    summaries_[column] = stats_.Summary(column);
+                sample_rate_ = stats_.SampleRate();
+            }
+
+            store_.Publish();
+            for (size_t i = 0; i < stored; i++)
+                stamps_.Push(stamps[i]);
+            samples_stored_.fetch_add(stored, std::memory_order_relaxed);
+            if (on_publish_)
+                on_publish_();
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+#include "channelStats.h"
+#include "clockAlignment.h"
+#include "derivedChannels.h"
+#include "spscRing.h"
+#include "telemetryIngest.h"
+#include "telemetryStore.h"
+
+// When one stored sample was read, decoded and appended, for the read -> drawn latency histograms.
+struct SampleStamps
+{
+    uint64_t Arrival;
+    uint64_t Parsed;
+    uint64_t Stored;
+};
+
+// Moves merged samples from a TelemetryIngest into a TelemetryStore on a thread of its own: it
+// evaluates the derived channels, appends, and publishes a store snapshot after every batch. The
+// render loop only reads published snapshots, so drawing never waits for ingest and ingest never
+// waits for a frame. Sliding-window statistics of every column are kept up to date on the way.
+class StoreFeed
+{
+public:
+    static const size_t BATCH_SAMPLES = 256;
+    static const size_t STAMP_CAPACITY = 4096;
+
+    StoreFeed(TelemetryIngest& ingest, TelemetryStore& store);
+    ~StoreFeed();
+
+    // Called on the feed thread after every Publish(), e.g. to wake a sleeping render loop. Set while stopped.
+    void SetPublishCallback(std::function<void()> on_publish) { on_publish_ = std::move(on_publish); }
+
+    // Any thread: the statistics window of every column, in seconds of host time.
+    void SetStatsWindow(float seconds) { stats_window_.store(seconds, std::memory_order_relaxed); }
+
+    // Starts a session on an empty store: the derived channels, statistics and clock fit start over.
+    void Start();
+    void Stop();
+    bool Running() const { return running_.load(std::memory_order_relaxed); }
+
+    uint64_t SamplesStored() const { return samples_stored_.load(std::memory_order_relaxed); }
+    // Samples the store turned away because it was full.
+    uint64_t SamplesRejected() const { return samples_rejected_.load(std::memory_order_relaxed); }
+
+    // One consumer thread: stamps of samples published since the last call, oldest first. Stamps
+    // are pushed after their snapshot is published; they are dropped if nobody drains them.
+    size_t DrainStamps(SampleStamps* out, size_t max_count) { return stamps_.PopBatch(out, max_count); }
+    // Any thread: a copy of the rocket clock's fit to host time.
+    ClockAlignment RocketClock() const;
+    // Any thread: every column's statistics as of the last batch; returns samples per second.
+    float ChannelSummaries(ChannelSummary* out) const;
+
+private:
+    void Run();
+
+    TelemetryIngest& ingest_;
+    TelemetryStore& store_;
+    std::function<void()> on_publish_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> samples_stored_;
+    std::atomic<uint64_t> samples_rejected_;
+
+    DerivedChannels derived_;
+    ChannelStats stats_;
+    std::atomic<float> stats_window_;
+
+    // copied out by other threads
+    mutable std::mutex status_mutex_;
+    ClockAlignment rocket_clock_;
+    ChannelSummary summaries_[STORE_COLUMN_COUNT];
+    float sample_rate_;
+
+    SpscRing<SampleStamps, STAMP_CAPACITY> stamps_;
+};
@@ -0,0 +1,56 @@
+#include "telemetryCsv.h"
+#include <fstream>
+#include "flightJournal.h"
+#include "stateEstimator.h"
+
+void WriteCsvHeader(std::ostream& out)
+{
+    out << "host time (s)";
+    for (const ColumnDef& column : COLUMNS)
+        out << ", " << column.id << " (" << column.unit << ")";
+    out << "\n";
+}
+
+void WriteCsvRow(std::ostream& out, float host_time, const float* row)
+{
+    out << host_time;
+    for (int column = 0; column < STORE_COLUMN_COUNT; column++)
+        out << ", " << row[column];
+    out << "\n";
+}
+
+long long ExportJournalCsv(const std::string& journal_path, const std::string& csv_path)
+{
+    JournalReader reader;
+    if (!reader.Open(journal_path))
+        return -1;
+
+    std::ofstream out(csv_path);
+    if (!out)
+        return -1;
+
+    WriteCsvHeader(out);
+    long long rows = 0;
+    JournalRecord record;
+    TelemetrySample sample = {};
+    StateEstimator estimator;
+    DerivedChannels derived;
+    float row[STORE_COLUMN_COUNT];
+    while (reader.Next(record))
+    {
+        // each session is a new link, so estimated and derived channels start over
+        if (record.Type == JournalRecord_Session)
+        {
+            estimator.Reset();
+            derived.Reset();
+        }
+        if (DecodeSampleRecord(record, sample))
+        {
+            estimator.Update(sample);
+            derived.Evaluate(sample, RocketSeconds(sample), row);
+            WriteCsvRow(out, sample.hostTime, row);
+            rows++;
+        }
+    }
+    return rows;
+}
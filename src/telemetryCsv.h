@@ -0,0 +1,15 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include "derivedChannels.h"
+
+// CSV log layout, generated from COLUMNS: host time first, then every raw and derived channel.
+void WriteCsvHeader(std::ostream& out);
+// row holds STORE_COLUMN_COUNT values, as filled by DerivedChannels::Evaluate
+void WriteCsvRow(std::ostream& out, float host_time, const float* row);
+
+// Post-processing: writes every sample record in a flight journal to a CSV file.
+// Safe to run while the recorder is still appending; it stops at the last durable record.
+// Returns the number of rows written, or -1 if either file could not be opened.
+long long ExportJournalCsv(const std::string& journal_path, const std::string& csv_path);
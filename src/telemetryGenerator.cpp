@@ -0,0 +1,251 @@
+#include "telemetryGenerator.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const double GRAVITY = 9.80665;
+static const double PI = 3.14159265358979;
+
+// Gyro channels count 16.4 per deg/s (MPU-6050 at +/-2000 deg/s), as StateEstimatorConfig assumes.
+static const double GYRO_LSB_PER_DEG_S = 16.4;
+static const double ROLL_RATE = 30.0;   // deg/s about the long axis, from launch to apogee
+
+// Sensor noise (one standard deviation) at noise level 1, per channel.
+static const double NOISE_SIGMA[Channel_COUNT] =
+{
+    2.0, 2.0, 2.0,      // gyro, LSB
+    15.0, 15.0, 15.0,   // acceleration, mg
+    4.0, 4.0, 4.0,      // magnetometer
+    5.0,                // force
+    0.1,                // temperature
+    0.0,                // rocket time
+    1.0,                // altitude
+};
+static_assert(Channel_COUNT == 13, "add a noise level for the new channel");
+
+TelemetryGenerator::TelemetryGenerator(const FlightProfile& profile, uint32_t seed)
+    : profile_(profile), rng_(seed), gaussian_(0.0, 1.0), uniform_(0.0, 1.0), noise_(1.0),
+      binary_fraction_(0.0), corrupt_fraction_(0.0), sequence_(0), sent_binary_(false), frames_(0), corrupted_(0)
+{
+    double burnout_time = profile_.PadSeconds + profile_.BurnSeconds;
+    burnout_velocity_ = profile_.BoostAcceleration * profile_.BurnSeconds;
+    burnout_altitude_ = 0.5 * profile_.BoostAcceleration * profile_.BurnSeconds * profile_.BurnSeconds;
+    apogee_time_ = burnout_time + burnout_velocity_ / GRAVITY;
+    apogee_altitude_ = burnout_altitude_ + burnout_velocity_ * burnout_velocity_ / (2.0 * GRAVITY);
+    main_time_ = apogee_time_ + std::max(0.0, apogee_altitude_ - profile_.MainDeployAltitude) / profile_.DrogueDescentRate;
+    landed_time_ = main_time_ + std::min(apogee_altitude_, profile_.MainDeployAltitude) / profile_.MainDescentRate;
+}
+
+FlightPhase TelemetryGenerator::Phase(double t) const
+{
+    if (t < profile_.PadSeconds)
+        return FlightPhase_Pad;
+    if (t < profile_.PadSeconds + profile_.BurnSeconds)
+        return FlightPhase_Boost;
+    if (t < apogee_time_)
+        return FlightPhase_Coast;
+    if (t < main_time_)
+        return FlightPhase_Drogue;
+    if (t < landed_time_)
+        return FlightPhase_Main;
+    return FlightPhase_Landed;
+}
+
+double TelemetryGenerator::PhaseStart(FlightPhase phase) const
+{
+    switch (phase)
+    {
+    case FlightPhase_Boost:  return profile_.PadSeconds;
+    case FlightPhase_Coast:  return profile_.PadSeconds + profile_.BurnSeconds;
+    case FlightPhase_Drogue: return apogee_time_;
+    case FlightPhase_Main:   return main_time_;
+    case FlightPhase_Landed: return landed_time_;
+    default:                 return 0.0;
+    }
+}
+
+double TelemetryGenerator::Altitude(double t) const
+{
+    double burn = t - profile_.PadSeconds;
+    double coast = burn - profile_.BurnSeconds;
+    switch (Phase(t))
+    {
+    case FlightPhase_Boost:  return 0.5 * profile_.BoostAcceleration * burn * burn;
+    case FlightPhase_Coast:  return burnout_altitude_ + burnout_velocity_ * coast - 0.5 * GRAVITY * coast * coast;
+    case FlightPhase_Drogue: return apogee_altitude_ - profile_.DrogueDescentRate * (t - apogee_time_);
+    case FlightPhase_Main:   return std::max(0.0, std::min(apogee_altitude_, profile_.MainDeployAltitude) - profile_.MainDescentRate * (t - main_time_));
+    default:                 return 0.0;
+    }
+}
+
+double TelemetryGenerator::Velocity(double t) const
+{
+    switch (Phase(t))
+    {
+    case FlightPhase_Boost:  return profile_.BoostAcceleration * (t - profile_.PadSeconds);
+    case FlightPhase_Coast:  return burnout_velocity_ - GRAVITY * (t - profile_.PadSeconds - profile_.BurnSeconds);
+    case FlightPhase_Drogue: return -profile_.DrogueDescentRate;
+    case FlightPhase_Main:   return -profile_.MainDescentRate;
+    default:                 return 0.0;
+    }
+}
+
+double TelemetryGenerator::Tilt(double t) const
+{
+    // slow gravity turn on the way up, pendulum swing under the canopies, tipping over on landing;
+    // continuous so the gyro never sees a step
+    double flight = t - profile_.PadSeconds;
+    switch (Phase(t))
+    {
+    case FlightPhase_Boost:
+    case FlightPhase_Coast:
+        return 10.0 * flight / (apogee_time_ - profile_.PadSeconds);
+    case FlightPhase_Drogue:
+        return 10.0 * exp(-(t - apogee_time_) / 2.0) + 15.0 * sin(2.0 * PI * 0.5 * (t - apogee_time_));
+    case FlightPhase_Main:
+        return Tilt(main_time_ - 1e-9) * exp(-(t - main_time_)) + 8.0 * sin(2.0 * PI * 0.3 * (t - main_time_));
+    case FlightPhase_Landed:
+    {
+        double touchdown = Tilt(landed_time_ - 1e-9);
+        return touchdown + (90.0 - touchdown) * std::min(1.0, t - landed_time_);
+    }
+    default:
+        return 0.0;
+    }
+}
+
+void TelemetryGenerator::Truth(double t, double* values) const
+{
+    FlightPhase phase = Phase(t);
+    double altitude = Altitude(t);
+
+    // axial specific force: thrust plus 1 g on the rail, weightless while coasting, and a decaying
+    // shock at each deployment
+    double axial = 0.0;
+    if (phase == FlightPhase_Boost)
+        axial = (profile_.BoostAcceleration + GRAVITY) / GRAVITY * 1000.0;
+    if (phase == FlightPhase_Drogue)
+        axial += 5000.0 * exp(-(t - apogee_time_) / 0.2);
+    else if (phase == FlightPhase_Main)
+        axial += 8000.0 * exp(-(t - main_time_) / 0.2);
+
+    // tilt is about the sensor x axis; whenever the airframe is held up (pad, canopies, ground) the
+    // accelerometer also reads 1 g along the local vertical, which the tilt moves towards y
+    double tilt = Tilt(t);
+    double tilt_rate = (Tilt(t + 1e-4) - Tilt(t - 1e-4)) / 2e-4;
+    double support_y = 0.0;
+    double support_z = 0.0;
+    if (phase != FlightPhase_Boost && phase != FlightPhase_Coast)
+    {
+        support_y = 1000.0 * sin(tilt * PI / 180.0);
+        support_z = 1000.0 * cos(tilt * PI / 180.0);
+    }
+
+    // the airframe spins about its long (z) axis on the way up; the horizontal part of the earth
+    // field turns the other way in the sensor frame
+    double flight = t - profile_.PadSeconds;
+    double roll = 0.0;
+    double roll_rate = 0.0;
+    if (flight > 0.0)
+        roll = ROLL_RATE * std::min(flight, apogee_time_ - profile_.PadSeconds);
+    if (phase == FlightPhase_Boost || phase == FlightPhase_Coast)
+        roll_rate = ROLL_RATE;
+
+    values[Channel_xOrient] = tilt_rate * GYRO_LSB_PER_DEG_S;
+    values[Channel_yOrient] = 0.0;
+    values[Channel_zOrient] = roll_rate * GYRO_LSB_PER_DEG_S;
+    values[Channel_xAccel] = 0.0;
+    values[Channel_yAccel] = support_y;
+    values[Channel_zAccel] = support_z + axial;
+    values[Channel_xMag] = 300.0 * cos(roll * PI / 180.0);
+    values[Channel_yMag] = -300.0 * sin(roll * PI / 180.0);
+    values[Channel_zMag] = -400.0;
+    values[Channel_force] = phase == FlightPhase_Boost ? 1500.0 : 0.0;
+    values[Channel_temp] = 24.0 - 0.0065 * altitude;
+    values[Channel_time] = t * 1000.0;
+    values[Channel_altitude] = altitude;
+}
+
+TelemetrySample TelemetryGenerator::Quantize(const double* values)
+{
+    TelemetrySample sample = {};
+    for (int c = 0; c < Channel_COUNT; c++)
+    {
+        const ChannelDef& def = CHANNELS[c];
+        double value = values[c] / def.scale;
+        if (def.type == ChannelType::I16)
+            value = std::min(32767.0, std::max(-32768.0, floor(value + 0.5)));
+        else if (def.type == ChannelType::I32)
+            value = std::min(2147483647.0, std::max(-2147483648.0, floor(value + 0.5)));
+        else if (def.type == ChannelType::U32)
+            value = std::min(4294967295.0, std::max(0.0, floor(value + 0.5)));
+        sample.*def.member = (float)(value * def.scale);
+        if (def.member == &TelemetrySample::time)
+            sample.rocketMs = (uint32_t)value;
+    }
+    return sample;
+}
+
+TelemetrySample TelemetryGenerator::Sample(double t) const
+{
+    double values[Channel_COUNT];
+    Truth(t, values);
+    return Quantize(values);
+}
+
+TelemetrySample TelemetryGenerator::NoisySample(double t)
+{
+    double values[Channel_COUNT];
+    Truth(t, values);
+    if (noise_ > 0.0)
+    {
+        for (int c = 0; c < Channel_COUNT; c++)
+            values[c] += NOISE_SIGMA[c] * noise_ * gaussian_(rng_);
+    }
+    return Quantize(values);
+}
+
+size_t TelemetryGenerator::EncodeFrame(const TelemetrySample& sample, uint8_t* out)
+{
+    size_t length = 0;
+    if (binary_fraction_ > 0.0 && uniform_(rng_) < binary_fraction_)
+    {
+        // a receiver syncs on the 0x00 before the first packet
+        if (!sent_binary_)
+            out[length++] = 0;
+        sent_binary_ = true;
+        length += EncodeBinaryPacket(sample, sequence_++, out + length);
+    }
+    else
+        length = FormatAsciiFrame(sample, (char*)out);
+
+    frames_++;
+    if (corrupt_fraction_ > 0.0 && uniform_(rng_) < corrupt_fraction_)
+    {
+        size_t bit = (size_t)(uniform_(rng_) * length * 8) % (length * 8);
+        out[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        corrupted_++;
+    }
+    return length;
+}
+
+size_t FormatAsciiFrame(const TelemetrySample& sample, char* out)
+{
+    char* p = out;
+    char* end = out + TelemetryGenerator::MAX_FRAME_BYTES;
+    p += snprintf(p, end - p, "{Data:");
+    for (int wire = 0; wire < Channel_COUNT; wire++)
+    {
+        const ChannelDef& def = CHANNELS[WIRE_ORDER.Channels[wire]];
+        float value = sample.*def.member / def.scale;
+        if (def.member == &TelemetrySample::time)
+            p += snprintf(p, end - p, "%u:", (unsigned)sample.rocketMs);
+        else if (def.type == ChannelType::F32)
+            p += snprintf(p, end - p, "%g:", value);
+        else
+            p += snprintf(p, end - p, "%.0f:", value);
+    }
+    p += snprintf(p, end - p, "}");
+    return p - out;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <random>
+#include <stddef.h>
+#include <stdint.h>
+#include "binaryProtocol.h"
+#include "flightPhase.h"
+#include "telemetrySample.h"
+
+// Simple vertical flight: constant-thrust boost, drag-free coast to apogee, then fixed descent
+// rates under drogue and main. Accelerations are in milli-g, with z along the airframe axis; the
+// gyro channels carry the angular rates of a slow gravity turn, a spin on the way up and the
+// swing under the canopies.
+struct FlightProfile
+{
+    double PadSeconds = 5.0;
+    double BurnSeconds = 2.5;
+    double BoostAcceleration = 80.0;    // m/s^2 net of gravity
+    double DrogueDescentRate = 25.0;    // m/s
+    double MainDeployAltitude = 300.0;  // m
+    double MainDescentRate = 6.0;       // m/s
+    double LandedSeconds = 10.0;
+};
+
+// Synthetic telemetry from a FlightProfile, for exercising the pipeline without a board.
+// Produces the same frames the flight computer sends: ASCII "{Data:...:}" and/or COBS binary
+// packets, with sensor noise and an optional fraction of frames corrupted by a flipped bit.
+class TelemetryGenerator
+{
+public:
+    // Longest frame NextFrame() writes.
+    static const size_t MAX_FRAME_BYTES = 256;
+
+    explicit TelemetryGenerator(const FlightProfile& profile = FlightProfile(), uint32_t seed = 1);
+
+    // noise: 1 = typical sensor noise, 0 = none. binary_fraction: share of frames sent as binary
+    // packets. corrupt_fraction: share of frames with one bit flipped on the wire.
+    void SetNoise(double noise) { noise_ = noise; }
+    void SetBinaryFraction(double fraction) { binary_fraction_ = fraction; }
+    void SetCorruptFraction(double fraction) { corrupt_fraction_ = fraction; }
+
+    double Duration() const { return landed_time_ + profile_.LandedSeconds; }
+    FlightPhase Phase(double t) const;
+    double PhaseStart(FlightPhase phase) const;
+    double Altitude(double t) const;
+    double Velocity(double t) const;
+
+    // Noise-free sample at t seconds since power-on, quantized as the wire would carry it.
+    TelemetrySample Sample(double t) const;
+
+    // Sample(t) plus sensor noise.
+    TelemetrySample NoisySample(double t);
+
+    // Encodes sample as the next frame on the wire (ASCII or binary, possibly corrupted) into out,
+    // which must hold MAX_FRAME_BYTES; returns its length.
+    size_t EncodeFrame(const TelemetrySample& sample, uint8_t* out);
+    size_t NextFrame(double t, uint8_t* out) { return EncodeFrame(NoisySample(t), out); }
+
+    uint64_t FramesGenerated() const { return frames_; }
+    uint64_t FramesCorrupted() const { return corrupted_; }
+
+private:
+    double Tilt(double t) const;
+    void Truth(double t, double* values) const;
+    static TelemetrySample Quantize(const double* values);
+
+    FlightProfile profile_;
+    double burnout_velocity_;
+    double burnout_altitude_;
+    double apogee_time_;
+    double apogee_altitude_;
+    double main_time_;
+    double landed_time_;
+
+    std::mt19937 rng_;
+    std::normal_distribution<double> gaussian_;
+    std::uniform_real_distribution<double> uniform_;
+    double noise_;
+    double binary_fraction_;
+    double corrupt_fraction_;
+    uint16_t sequence_;
+    bool sent_binary_;
+    uint64_t frames_;
+    uint64_t corrupted_;
+};
+
+// Writes "{Data:...:}" for sample into out (at least TelemetryGenerator::MAX_FRAME_BYTES).
+size_t FormatAsciiFrame(const TelemetrySample& sample, char* out);
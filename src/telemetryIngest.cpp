@@ -0,0 +1,433 @@
+#include "telemetryIngest.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include "latencyHistogram.h"
+
+TelemetryIngest::Link::Link(TelemetrySource* source)
+    : Source(source), TimelineOffsetNs(0), Connected(false), BytesRead(0), FramesDecoded(0), FramesRejected(0),
+      PacketsLost(0), SequenceRestarts(0), Duplicates(0), Late(0), LastArrivalNs(0), LastError((uint8_t)ParseStatus::Ok)
+{
+}
+
+TelemetryIngest::TelemetryIngest(TelemetrySource* source)
+    : recorder_(nullptr), publisher_(nullptr), shared_ring_(nullptr), running_(false), start_ns_(0), uplink_link_(0), link_count_(0),
+      merge_pending_(false), merge_deadline_ns_(UINT64_MAX), last_host_time_(0.0f), have_sequence_(false), last_sequence_(0),
+      frames_decoded_(0), frames_dropped_(0), merge_duplicates_(0), merge_late_(0), packets_lost_(0), last_reject_((uint8_t)ParseStatus::Ok),
+      flight_records_(), flight_phase_(FlightPhase_Pad), flight_events_(0), drain_waiting_(false)
+{
+    if (source)
+        AddLink(source);
+}
+
+TelemetryIngest::~TelemetryIngest()
+{
+    Stop();
+}
+
+void TelemetryIngest::SetSource(TelemetrySource* source)
+{
+    ClearLinks();
+    if (source)
+        AddLink(source);
+}
+
+int TelemetryIngest::AddLink(TelemetrySource* source)
+{
+    int index = link_count_.load(std::memory_order_relaxed);
+    if (index >= MAX_LINKS)
+        return -1;
+
+    links_[index].reset(new Link(source));
+    if (!running_.load())
+    {
+        link_count_.store(index + 1, std::memory_order_release);
+        return index;
+    }
+
+    // hot-plugged: this source's timeline starts now, not when the session did
+    Link& link = *links_[index];
+    link.TimelineOffsetNs = MonotonicNanoseconds() - start_ns_;
+    source->Begin();
+    link_count_.store(index + 1, std::memory_order_release);
+    link.Thread = std::thread(&TelemetryIngest::Run, this, index);
+    return index;
+}
+
+void TelemetryIngest::ClearLinks()
+{
+    if (running_.load())
+        return;
+    for (std::unique_ptr<Link>& link : links_)
+        link.reset();
+    link_count_.store(0);
+}
+
+TelemetrySource* TelemetryIngest::Source(int link) const
+{
+    return link < LinkCount() ? links_[link]->Source : nullptr;
+}
+
+LinkHealth TelemetryIngest::Health(int index) const
+{
+    LinkHealth health = {};
+    if (index >= LinkCount())
+        return health;
+    const Link& link = *links_[index];
+    health.Connected = link.Connected.load(std::memory_order_relaxed) && link.Source->Connected();
+    health.BytesRead = link.BytesRead.load(std::memory_order_relaxed);
+    health.FramesDecoded = link.FramesDecoded.load(std::memory_order_relaxed);
+    health.FramesRejected = link.FramesRejected.load(std::memory_order_relaxed);
+    health.PacketsLost = link.PacketsLost.load(std::memory_order_relaxed);
+    health.SequenceRestarts = link.SequenceRestarts.load(std::memory_order_relaxed);
+    health.Duplicates = link.Duplicates.load(std::memory_order_relaxed);
+    health.Late = link.Late.load(std::memory_order_relaxed);
+    health.LastArrivalNs = link.LastArrivalNs.load(std::memory_order_relaxed);
+    health.LastError = (ParseStatus)link.LastError.load(std::memory_order_relaxed);
+    return health;
+}
+
+uint64_t TelemetryIngest::FramesRejected() const
+{
+    uint64_t rejected = 0;
+    int count = LinkCount();
+    for (int link = 0; link < count; link++)
+        rejected += links_[link]->FramesRejected.load(std::memory_order_relaxed);
+    return rejected + merge_duplicates_.load(std::memory_order_relaxed);
+}
+
+void TelemetryIngest::Start()
+{
+    int count = LinkCount();
+    if (count == 0 || running_.exchange(true))
+        return;
+
+    frames_decoded_.store(0);
+    frames_dropped_.store(0);
+    merge_duplicates_.store(0);
+    merge_late_.store(0);
+    packets_lost_.store(0);
+    last_reject_.store((uint8_t)ParseStatus::Ok);
+    merger_.Reset();
+    merge_deadline_ns_.store(UINT64_MAX);
+    last_host_time_ = 0.0f;
+    have_sequence_ = false;
+    estimator_.Reset();
+    phase_detector_.Reset();
+    flight_phase_.store(FlightPhase_Pad);
+    flight_events_.store(0);
+    uplink_.Reset();
+    uplink_link_.store(0);
+
+    // fresh decoders and counters
+    for (int index = 0; index < count; index++)
+        links_[index].reset(new Link(links_[index]->Source));
+    start_ns_ = MonotonicNanoseconds();
+    for (int index = 0; index < count; index++)
+        links_[index]->Source->Begin();
+    for (int index = 0; index < count; index++)
+        links_[index]->Thread = std::thread(&TelemetryIngest::Run, this, index);
+}
+
+void TelemetryIngest::Stop()
+{
+    running_.store(false);
+    int count = LinkCount();
+    for (int index = 0; index < count; index++)
+    {
+        if (links_[index]->Thread.joinable())
+            links_[index]->Thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    drain_ready_.notify_all();
+}
+
+size_t TelemetryIngest::Drain(TelemetrySample* out, size_t max_count)
+{
+    return ring_.PopBatch(out, max_count);
+}
+
+bool TelemetryIngest::WaitForSamples(uint32_t timeout_ms)
+{
+    if (ring_.Size() > 0)
+        return true;
+
+    // Say we are waiting before looking at the ring once more; the merge step pushes before it
+    // looks at drain_waiting_, so one of the two always sees the other.
+    std::unique_lock<std::mutex> lock(drain_mutex_);
+    drain_waiting_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ready = drain_ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return ring_.Size() > 0; });
+    drain_waiting_.store(false);
+    return ready;
+}
+
+int TelemetryIngest::SendCommand(UplinkCommand command)
+{
+    int sequence = uplink_.Submit(command);
+    TelemetrySource* source = Source(UplinkLink());
+    if (sequence >= 0 && source && running_.load())
+        source->Interrupt();
+    return sequence;
+}
+
+bool TelemetryIngest::FlightEventRecorded(FlightEvent event, FlightEventRecord& out) const
+{
+    const PublishedRecord& record = flight_records_[event];
+    uint64_t words[sizeof(record.Words) / sizeof(record.Words[0])];
+    for (;;)
+    {
+        if (!(flight_events_.load(std::memory_order_acquire) & (1u << event)))
+            return false;
+        uint32_t version = record.Version.load(std::memory_order_acquire);
+        if (version & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++)
+            words[i] = record.Words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.Version.load(std::memory_order_relaxed) == version)
+            break;
+    }
+    memcpy(&out, words, sizeof(out));
+    return true;
+}
+
+void TelemetryIngest::WriteFlightRecord(int event, const FlightEventRecord& record)
+{
+    PublishedRecord& published = flight_records_[event];
+    uint64_t words[sizeof(published.Words) / sizeof(published.Words[0])] = {};
+    memcpy(words, &record, sizeof(record));
+
+    uint32_t version = published.Version.load(std::memory_order_relaxed);
+    published.Version.store(version + 1, std::memory_order_relaxed);
+    // a reader that sees any of the new words also sees the odd version
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++)
+        published.Words[i].store(words[i], std::memory_order_relaxed);
+    published.Version.store(version + 2, std::memory_order_release);
+}
+
+void TelemetryIngest::Merge()
+{
+    merge_pending_.store(true);
+    while (merge_pending_.load() && merge_mutex_.try_lock())
+    {
+        merge_pending_.store(false);
+        MergeLocked();
+        merge_mutex_.unlock();
+    }
+}
+
+void TelemetryIngest::MergeLocked()
+{
+    TelemetrySample batch[64];
+    TelemetrySample merged;
+    uint64_t published = frames_decoded_.load(std::memory_order_relaxed);
+    int count = LinkCount();
+    for (int index = 0; index < count; index++)
+    {
+        Link& link = *links_[index];
+        size_t decoded;
+        while ((decoded = link.Decoded.PopBatch(batch, 64)) > 0)
+        {
+            for (size_t i = 0; i < decoded; i++)
+            {
+                // one link has nothing to merge with: its samples go out as they were decoded
+                if (count == 1 && merger_.Held() == 0)
+                {
+                    Publish(batch[i]);
+                    continue;
+                }
+                MergeResult result = merger_.Push(index, batch[i], batch[i].arrivalNs);
+                if (result == MergeResult::Duplicate)
+                {
+                    link.Duplicates.fetch_add(1, std::memory_order_relaxed);
+                    merge_duplicates_.fetch_add(1, std::memory_order_relaxed);
+                }
+                else if (result == MergeResult::Late)
+                {
+                    link.Late.fetch_add(1, std::memory_order_relaxed);
+                    merge_late_.fetch_add(1, std::memory_order_relaxed);
+                    frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                while (merger_.Pop(merged, MonotonicNanoseconds()))
+                    Publish(merged);
+            }
+        }
+    }
+
+    // samples whose wait for a slower link ran out
+    while (merger_.Pop(merged, MonotonicNanoseconds()))
+        Publish(merged);
+    merge_deadline_ns_.store(merger_.NextDeadlineNs(), std::memory_order_relaxed);
+
+    if (frames_decoded_.load(std::memory_order_relaxed) != published)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (drain_waiting_.load())
+        {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            drain_ready_.notify_one();
+        }
+    }
+
+    // uplink on whichever link heard from the rocket last
+    int uplink = uplink_link_.load(std::memory_order_relaxed);
+    uint64_t latest = uplink < count ? links_[uplink]->LastArrivalNs.load(std::memory_order_relaxed) : 0;
+    for (int index = 0; index < count; index++)
+    {
+        uint64_t arrival = links_[index]->LastArrivalNs.load(std::memory_order_relaxed);
+        if (arrival > latest && links_[index]->Connected.load(std::memory_order_relaxed))
+        {
+            latest = arrival;
+            uplink = index;
+        }
+    }
+    uplink_link_.store(uplink, std::memory_order_relaxed);
+}
+
+void TelemetryIngest::Publish(TelemetrySample& sample)
+{
+    // links started at different times, or a sample that waited for another link, never move
+    // the timeline back
+    sample.hostTime = std::max(sample.hostTime, last_host_time_);
+    last_host_time_ = sample.hostTime;
+
+    if (sample.format == FRAME_FORMAT_BINARY)
+    {
+        uint16_t delta = (uint16_t)(sample.sequence - last_sequence_);
+        if (have_sequence_ && delta != 0 && delta < 0x8000)
+            packets_lost_.fetch_add(delta - 1, std::memory_order_relaxed);
+        have_sequence_ = true;
+        last_sequence_ = sample.sequence;
+    }
+
+    frames_decoded_.fetch_add(1, std::memory_order_relaxed);
+    estimator_.Update(sample);
+
+    // publish new events only after their records are written; a restarted rocket clock
+    // (detector reset) clears the published set first
+    uint32_t fired = phase_detector_.Update(sample);
+    uint32_t detected = phase_detector_.Events();
+    if (detected != flight_events_.load(std::memory_order_relaxed))
+    {
+        flight_events_.store(detected & ~fired, std::memory_order_release);
+        for (int event = 0; event < FlightEvent_COUNT; event++)
+        {
+            if (fired & (1u << event))
+                WriteFlightRecord(event, phase_detector_.Event((FlightEvent)event));
+        }
+        flight_phase_.store((uint8_t)phase_detector_.Phase(), std::memory_order_release);
+        flight_events_.store(detected, std::memory_order_release);
+    }
+
+    if (recorder_)
+        recorder_->RecordSample(sample);
+    if (publisher_)
+        publisher_->PublishSample(sample);
+    if (shared_ring_)
+        shared_ring_->Write(sample);
+
+    // a lossless source (a single replay) waits for the UI to catch up rather than losing samples
+    bool lossless = LinkCount() == 1 && links_[0]->Source->Lossless();
+    while (!ring_.Push(sample))
+    {
+        if (!lossless || !running_.load(std::memory_order_relaxed))
+        {
+            frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void TelemetryIngest::Run(int index)
+{
+    // short enough that Stop() is serviced promptly when the link is quiet; queued commands
+    // interrupt the read rather than wait for it
+    uint32_t reply_wait_ms = 100;
+    Link& link = *links_[index];
+    TelemetrySource& source = *link.Source;
+
+    uint64_t arrival_ns = 0;
+    uint64_t timeline_ns = 0;
+    auto on_sample = [this, &link, &arrival_ns, &timeline_ns](const TelemetrySample& decoded)
+    {
+        TelemetrySample sample = decoded;
+        sample.arrivalNs = arrival_ns;
+        sample.parsedNs = MonotonicNanoseconds();
+        sample.hostTime = (float)((timeline_ns + link.TimelineOffsetNs) * 1e-9);
+        link.FramesDecoded.fetch_add(1, std::memory_order_relaxed);
+
+        // a chunk with more frames than the link ring holds is merged as it goes
+        while (!link.Decoded.Push(sample))
+        {
+            if (!running_.load(std::memory_order_relaxed))
+            {
+                frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            Merge();
+            std::this_thread::yield();
+        }
+    };
+
+    auto on_ack = [this, &arrival_ns](uint16_t sequence)
+    {
+        uplink_.Acknowledge(sequence, arrival_ns);
+    };
+
+    while (running_.load(std::memory_order_relaxed))
+    {
+        // commands first, then wait no longer than the next retry or merge deadline
+        uint32_t wait_ms = reply_wait_ms;
+        if (UplinkLink() == index)
+            wait_ms = std::min(wait_ms, uplink_.Service(source));
+        uint64_t deadline_ns = merge_deadline_ns_.load(std::memory_order_relaxed);
+        if (deadline_ns != UINT64_MAX)
+        {
+            uint64_t now = MonotonicNanoseconds();
+            wait_ms = std::min<uint64_t>(wait_ms, deadline_ns > now ? (deadline_ns - now) / 1000000 + 1 : 0);
+        }
+
+        // one read per chunk; every complete frame in it is decoded before the next read
+        int bytes_read = source.Read(link.ReadBuffer, sizeof(link.ReadBuffer), wait_ms, timeline_ns);
+        // a reopened port may carry another radio, or come back mid-frame: its stream starts over
+        if (bytes_read >= 0 && !link.Connected.load(std::memory_order_relaxed))
+            link.Decoder.ResetStream();
+        link.Connected.store(bytes_read >= 0, std::memory_order_relaxed);
+        if (bytes_read < 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(reply_wait_ms));
+            continue;
+        }
+
+        if (bytes_read > 0)
+        {
+            arrival_ns = MonotonicNanoseconds();
+            if (recorder_)
+            {
+                std::lock_guard<std::mutex> lock(record_mutex_);
+                recorder_->RecordRaw(arrival_ns, link.ReadBuffer, bytes_read, (uint8_t)index);
+            }
+            link.Decoder.Feed(link.ReadBuffer, bytes_read, on_sample, on_ack);
+            link.BytesRead.fetch_add(bytes_read, std::memory_order_relaxed);
+            link.LastArrivalNs.store(arrival_ns, std::memory_order_relaxed);
+            link.PacketsLost.store(link.Decoder.LostPackets(), std::memory_order_relaxed);
+            link.SequenceRestarts.store(link.Decoder.SequenceRestarts(), std::memory_order_relaxed);
+            if (link.Decoder.Rejected() != link.FramesRejected.load(std::memory_order_relaxed))
+            {
+                link.FramesRejected.store(link.Decoder.Rejected(), std::memory_order_relaxed);
+                link.LastError.store((uint8_t)link.Decoder.LastError(), std::memory_order_relaxed);
+                last_reject_.store((uint8_t)link.Decoder.LastError(), std::memory_order_relaxed);
+            }
+        }
+
+        if (link.Decoded.Size() > 0 || MonotonicNanoseconds() >= merge_deadline_ns_.load(std::memory_order_relaxed))
+            Merge();
+    }
+}
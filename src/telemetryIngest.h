@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include "commandUplink.h"
+#include "flightPhase.h"
+#include "flightRecorder.h"
+#include "linkDecoder.h"
+#include "linkMerger.h"
+#include "samplePublisher.h"
+#include "sharedSampleRing.h"
+#include "spscRing.h"
+#include "stateEstimator.h"
+#include "telemetrySample.h"
+#include "telemetrySource.h"
+
+// Counters of one link, before the merge.
+struct LinkHealth
+{
+    bool Connected;
+    uint64_t BytesRead;
+    uint64_t FramesDecoded;
+    uint64_t FramesRejected;
+    uint64_t PacketsLost;       // gaps in this link's binary sequence numbers
+    uint64_t SequenceRestarts;  // times the binary sequence started over (a reboot, a long outage)
+    uint64_t Duplicates;        // samples another link delivered first
+    uint64_t Late;              // samples that arrived after the merged stream had passed them
+    uint64_t LastArrivalNs;     // MonotonicNanoseconds() of the last read with data; 0 if none yet
+    ParseStatus LastError;
+};
+
+// Long-lived ingest for one vehicle, over any number of links (redundant radios, or one replay).
+// Every link has its own thread that owns all reads on its TelemetrySource and decodes ASCII and
+// binary frames as fast as they arrive, so links scale across cores. Decoded samples meet in a
+// LinkMerger (rocket-time order, copies dropped); whichever link thread has new samples runs that
+// merge step, the estimator, the phase detector, the recorder, the publisher and the shared ring,
+// then hands the merged samples to the UI thread through a lock-free SPSC ring.
+class TelemetryIngest
+{
+public:
+    static const int MAX_LINKS = LinkMerger::MAX_LINKS;
+    static const size_t RING_CAPACITY = 4096;
+    static const size_t LINK_RING_CAPACITY = 1024;
+    static const size_t READ_CHUNK_SIZE = 4096;
+
+    explicit TelemetryIngest(TelemetrySource* source = nullptr);
+    ~TelemetryIngest();
+
+    // Set while stopped: source becomes the only link. Start() restarts decoding and the counters.
+    void SetSource(TelemetrySource* source);
+    // Adds a link; while running it starts reading at once, on the running session's timeline.
+    // Returns the link's index, or -1 if MAX_LINKS are open. Call from the thread that calls Start().
+    int AddLink(TelemetrySource* source);
+    // While stopped.
+    void ClearLinks();
+    int LinkCount() const { return link_count_.load(std::memory_order_acquire); }
+    TelemetrySource* Source(int link = 0) const;
+    LinkHealth Health(int link) const;
+
+    // Optional; set before Start(). Receives every raw read and every merged sample.
+    void SetRecorder(FlightRecorder* recorder) { recorder_ = recorder; }
+    // Optional; set before Start(). Receives every merged sample, after the recorder.
+    void SetPublisher(SamplePublisher* publisher) { publisher_ = publisher; }
+    // Optional; set before Start() and keep open until Stop(). Every merged sample is written to it.
+    void SetSharedRing(SharedSampleWriter* ring) { shared_ring_ = ring; }
+    // Set while stopped.
+    void SetMergeConfig(const LinkMergeConfig& config) { merger_.SetConfig(config); }
+
+    void Start();
+    void Stop();
+    bool Running() const { return running_.load(std::memory_order_relaxed); }
+
+    // Consumer thread: copies up to max_count pending samples into out, oldest first.
+    size_t Drain(TelemetrySample* out, size_t max_count);
+    // Consumer thread: sleeps until there is something to Drain(), for at most timeout_ms (Stop()
+    // wakes it too). True if samples are pending.
+    bool WaitForSamples(uint32_t timeout_ms);
+
+    // Any thread: queues an uplink command and interrupts the read in progress, so the ingest
+    // thread writes it straight away instead of after the read times out. Returns its sequence
+    // number, or -1 if the queue is full. Track it (ack, retries, latency) through Uplink().
+    // Commands go out on the link that heard from the rocket most recently; an ack on any link counts.
+    int SendCommand(UplinkCommand command);
+    CommandUplink& Uplink() { return uplink_; }
+    const CommandUplink& Uplink() const { return uplink_; }
+    int UplinkLink() const { return uplink_link_.load(std::memory_order_relaxed); }
+
+    // Estimated channels (filtered altitude, vertical velocity, attitude) are filled in on the
+    // ingest thread before a sample is queued. Set the configuration while stopped.
+    void SetEstimatorConfig(const StateEstimatorConfig& config) { estimator_.SetConfig(config); }
+
+    // Flight phase, detected on the ingest thread as each sample is decoded, so events are found
+    // (and stamped) at their sample however often the UI drains. Set thresholds while stopped.
+    void SetFlightThresholds(const FlightPhaseThresholds& thresholds) { phase_detector_.SetThresholds(thresholds); }
+    FlightPhase Phase() const { return (FlightPhase)flight_phase_.load(std::memory_order_acquire); }
+    uint32_t FlightEvents() const { return flight_events_.load(std::memory_order_acquire); }
+    // Copies the record of event into out; false if it has not been detected.
+    bool FlightEventRecorded(FlightEvent event, FlightEventRecord& out) const;
+
+    // Merged stream: samples queued for the UI, rejects over all links (copies the merge threw away
+    // included), gaps left in the binary sequence after the merge, and samples lost to a full ring
+    // or to arriving after the merge had passed them.
+    uint64_t FramesDecoded() const { return frames_decoded_.load(std::memory_order_relaxed); }
+    uint64_t FramesRejected() const;
+    uint64_t FramesDropped() const { return frames_dropped_.load(std::memory_order_relaxed); }
+    // The merge's share of the two above, over all links.
+    uint64_t MergeDuplicates() const { return merge_duplicates_.load(std::memory_order_relaxed); }
+    uint64_t MergeLate() const { return merge_late_.load(std::memory_order_relaxed); }
+    uint64_t PacketsLost() const { return packets_lost_.load(std::memory_order_relaxed); }
+    ParseStatus LastRejectReason() const { return (ParseStatus)last_reject_.load(std::memory_order_relaxed); }
+
+private:
+    struct Link
+    {
+        explicit Link(TelemetrySource* source);
+
+        TelemetrySource* Source;
+        std::thread Thread;
+        LinkDecoder Decoder;
+        uint64_t TimelineOffsetNs;  // from the session's start to this link's Begin()
+
+        std::atomic<bool> Connected;
+        std::atomic<uint64_t> BytesRead;
+        std::atomic<uint64_t> FramesDecoded;
+        std::atomic<uint64_t> FramesRejected;
+        std::atomic<uint64_t> PacketsLost;
+        std::atomic<uint64_t> SequenceRestarts;
+        std::atomic<uint64_t> Duplicates;
+        std::atomic<uint64_t> Late;
+        std::atomic<uint64_t> LastArrivalNs;
+        std::atomic<uint8_t> LastError;
+
+        // link thread -> merge step
+        SpscRing<TelemetrySample, LINK_RING_CAPACITY> Decoded;
+        uint8_t ReadBuffer[READ_CHUNK_SIZE];
+    };
+
+    void Run(int index);
+    void Merge();
+    void MergeLocked();
+    void Publish(TelemetrySample& sample);
+
+    FlightRecorder* recorder_;
+    SamplePublisher* publisher_;
+    SharedSampleWriter* shared_ring_;
+    std::atomic<bool> running_;
+    uint64_t start_ns_;
+    CommandUplink uplink_;
+    std::atomic<int> uplink_link_;
+
+    std::unique_ptr<Link> links_[MAX_LINKS];
+    std::atomic<int> link_count_;
+    // raw reads from several link threads into the recorder's single-producer queue
+    std::mutex record_mutex_;
+
+    // Merge(): a link thread that finds the lock taken leaves its samples to the holder, which
+    // goes round again while merge_pending_ is set
+    std::mutex merge_mutex_;
+    std::atomic<bool> merge_pending_;
+    std::atomic<uint64_t> merge_deadline_ns_;
+    LinkMerger merger_;
+    float last_host_time_;
+    bool have_sequence_;
+    uint16_t last_sequence_;
+
+    std::atomic<uint64_t> frames_decoded_;
+    std::atomic<uint64_t> frames_dropped_;
+    std::atomic<uint64_t> merge_duplicates_;
+    std::atomic<uint64_t> merge_late_;
+    std::atomic<uint64_t> packets_lost_;
+    std::atomic<uint8_t> last_reject_;
+
+    StateEstimator estimator_;
+
+    // An event's record is written by the merge step only while its bit in flight_events_ is clear,
+    // under a seqlock per record: a detector reset rewrites records the UI may be copying.
+    struct PublishedRecord
+    {
+        std::atomic<uint32_t> Version;  // odd while the record is being written
+        std::atomic<uint64_t> Words[(sizeof(FlightEventRecord) + 7) / 8];
+    };
+    void WriteFlightRecord(int event, const FlightEventRecord& record);
+
+    FlightPhaseDetector phase_detector_;
+    PublishedRecord flight_records_[FlightEvent_COUNT];
+    std::atomic<uint8_t> flight_phase_;
+    std::atomic<uint32_t> flight_events_;
+
+    SpscRing<TelemetrySample, RING_CAPACITY> ring_;
+    // the merge step only takes drain_mutex_ to wake a consumer that said it is waiting
+    std::mutex drain_mutex_;
+    std::condition_variable drain_ready_;
+    std::atomic<bool> drain_waiting_;
+};
@@ -0,0 +1,111 @@
+#include "telemetryParser.h"
+#include <charconv>
+#include <string.h>
+#include <utility>
+
+static const char FRAME_HEADER[] = "Data:";
+static const size_t FRAME_HEADER_LEN = sizeof(FRAME_HEADER) - 1;
+
+const char* ParseStatusName(ParseStatus status)
+{
+    switch (status)
+    {
+    case ParseStatus::Ok:               return "ok";
+    case ParseStatus::MissingHeader:    return "missing header";
+    case ParseStatus::TooFewFields:     return "too few fields";
+    case ParseStatus::TooManyFields:    return "too many fields";
+    case ParseStatus::EmptyField:       return "empty field";
+    case ParseStatus::BadNumber:        return "bad number";
+    case ParseStatus::BadLength:        return "bad length";
+    case ParseStatus::BadChecksum:      return "bad checksum";
+    default:                            return "unknown";
+    }
+}
+
+// Decodes the field at wire position Wire and the ':' after it. Unrolled per channel at compile time.
+template<int Wire>
+static ParseStatus ParseField(const char*& cursor, const char* end, TelemetrySample& sample)
+{
+    constexpr ChannelDef def = CHANNELS[WIRE_ORDER.Channels[Wire]];
+
+    const char* colon = (const char*)memchr(cursor, ':', end - cursor);
+    if (colon == nullptr)
+        return ParseStatus::TooFewFields;
+    if (colon == cursor)
+        return ParseStatus::EmptyField;
+
+    // from_chars rejects a leading '+', which the flight computer never sends
+    float value;
+    long long integer = 0;
+    std::from_chars_result result;
+    if constexpr (def.type == ChannelType::F32)
+        result = std::from_chars(cursor, colon, value);
+    else
+    {
+        // integer channels take the integer fast path, but still accept a float
+        result = std::from_chars(cursor, colon, integer);
+        value = (float)integer;
+        if (result.ec == std::errc() && result.ptr != colon)
+        {
+            result = std::from_chars(cursor, colon, value);
+            integer = (long long)value;
+        }
+    }
+    if (result.ec != std::errc() || result.ptr != colon)
+        return ParseStatus::BadNumber;
+    if constexpr (def.member == &TelemetrySample::time)
+        sample.rocketMs = (uint32_t)integer;
+
+    if constexpr (def.scale != 1.0f)
+        value *= def.scale;
+    sample.*def.member = value;
+    cursor = colon + 1;
+    return ParseStatus::Ok;
+}
+
+template<int... Wire>
+static ParseStatus ParseFields(const char*& cursor, const char* end, TelemetrySample& sample, std::integer_sequence<int, Wire...>)
+{
+    ParseStatus status = ParseStatus::Ok;
+    (((status = ParseField<Wire>(cursor, end, sample)) == ParseStatus::Ok) && ...);
+    return status;
+}
+
+ParseStatus ParseTelemetryFrame(std::string_view frame, TelemetrySample& sample)
+{
+    if (frame.size() < FRAME_HEADER_LEN || memcmp(frame.data(), FRAME_HEADER, FRAME_HEADER_LEN) != 0)
+        return ParseStatus::MissingHeader;
+
+    const char* cursor = frame.data() + FRAME_HEADER_LEN;
+    const char* end = frame.data() + frame.size();
+
+    ParseStatus status = ParseFields(cursor, end, sample, std::make_integer_sequence<int, Channel_COUNT>());
+    if (status != ParseStatus::Ok)
+        return status;
+
+    // tolerate trailing whitespace / line endings left by the link
+    while (cursor < end && (*cursor == '\r' || *cursor == '\n' || *cursor == ' '))
+        cursor++;
+    if (cursor != end)
+        return ParseStatus::TooManyFields;
+
+    sample.sequence = 0;
+    sample.format = FRAME_FORMAT_ASCII;
+    return ParseStatus::Ok;
+}
+
+TelemetryParser::TelemetryParser()
+    : last_error_(ParseStatus::Ok)
+{
+    for (int i = 0; i < (int)ParseStatus::COUNT; i++)
+        counts_[i] = 0;
+}
+
+ParseStatus TelemetryParser::Parse(std::string_view frame, TelemetrySample& sample)
+{
+    ParseStatus status = ParseTelemetryFrame(frame, sample);
+    counts_[(int)status]++;
+    if (status != ParseStatus::Ok)
+        last_error_ = status;
+    return status;
+}
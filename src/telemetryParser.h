@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <string_view>
+#include "telemetrySample.h"
+
+// Why a frame was rejected. Ok is zero so it can index counters directly.
+enum class ParseStatus : uint8_t
+{
+    Ok = 0,
+    MissingHeader,      // frame does not start with "Data:"
+    TooFewFields,       // ran out of ':' before all fields were read
+    TooManyFields,      // content after the last field
+    EmptyField,         // "::" where a number was expected
+    BadNumber,          // field is not a valid integer or floating point number
+    BadLength,          // frame has the wrong size, or binary packet is not valid COBS
+    BadChecksum,        // binary packet CRC mismatch
+    COUNT
+};
+
+const char* ParseStatusName(ParseStatus status);
+
+// Single pass, allocation free decoder for "Data:<field>:<field>:...:" with the fields in the
+// wire order of TELEMETRY_CHANNELS. Fields may be integers or floating point.
+// On failure the sample is left partially written.
+class TelemetryParser
+{
+public:
+    static const int NUM_FIELDS = Channel_COUNT;
+
+    TelemetryParser();
+
+    ParseStatus Parse(std::string_view frame, TelemetrySample& sample);
+
+    uint64_t Count(ParseStatus status) const { return counts_[(int)status]; }
+    ParseStatus LastError() const { return last_error_; }
+
+private:
+    uint64_t counts_[(int)ParseStatus::COUNT];
+    ParseStatus last_error_;
+};
+
+// Stateless form of TelemetryParser::Parse, for callers that do not need counters.
+ParseStatus ParseTelemetryFrame(std::string_view frame, TelemetrySample& sample);
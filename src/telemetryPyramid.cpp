@@ -0,0 +1,67 @@
+#include "telemetryPyramid.h"
+
+TelemetryPyramid::TelemetryPyramid(int column_count)
+    : column_count_(column_count), partial_((size_t)MAX_LEVELS * 2 * column_count)
+{
+    // pages shrink with the level so every level holds as many samples' worth as level 1
+    size_t page_buckets = 8192;
+    for (int level = 1; level <= MAX_LEVELS; level++)
+    {
+        levels_[level - 1].reset(new PagedArray<float>(2 * (size_t)column_count, page_buckets));
+        if (page_buckets > 64)
+            page_buckets /= FANOUT;
+    }
+}
+
+void TelemetryPyramid::Append(size_t index, const float* values)
+{
+    size_t bucket_samples = 1;
+    for (int level = 1; level <= MAX_LEVELS; level++)
+    {
+        bucket_samples *= FANOUT;
+        float* bucket = &partial_[(level - 1) * 2 * column_count_];
+
+        if (index % bucket_samples == 0)
+        {
+            for (int column = 0; column < column_count_; column++)
+            {
+                bucket[2 * column] = values[column];
+                bucket[2 * column + 1] = values[column];
+            }
+        }
+        else
+        {
+            for (int column = 0; column < column_count_; column++)
+            {
+                float value = values[column];
+                if (value < bucket[2 * column])
+                    bucket[2 * column] = value;
+                if (value > bucket[2 * column + 1])
+                    bucket[2 * column + 1] = value;
+            }
+        }
+
+        if ((index + 1) % bucket_samples == 0)
+        {
+            float* complete = levels_[level - 1]->Extend(index / bucket_samples);
+            for (int i = 0; i < 2 * column_count_; i++)
+                complete[i] = bucket[i];
+        }
+    }
+}
+
+int TelemetryPyramid::ChooseLevel(size_t sample_count, size_t max_points)
+{
+    if (sample_count <= max_points)
+        return 0;
+
+    size_t bucket_samples = 1;
+    for (int level = 1; level < MAX_LEVELS; level++)
+    {
+        bucket_samples *= FANOUT;
+        size_t buckets = (sample_count + bucket_samples - 1) / bucket_samples;
+        if (2 * buckets <= max_points)
+            return level;
+    }
+    return MAX_LEVELS;
+}
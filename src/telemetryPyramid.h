@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <stddef.h>
+#include <vector>
+#include "pagedArray.h"
+
+// Multi-resolution min/max summary of a TelemetryStore, kept up to date as samples are appended.
+// Level L groups FANOUT^L consecutive samples into one bucket holding each column's min and max,
+// so a plot can draw a whole flight with a bounded number of points and still show every spike.
+// Level 0 is the raw samples in the store itself.
+//
+// A bucket is written to its level only once it is complete, so completed buckets never change
+// and can be read from another thread; the unfinished bucket of each level is kept aside and
+// copied into every StoreSnapshot.
+class TelemetryPyramid
+{
+public:
+    static const int FANOUT_BITS = 3;
+    static const size_t FANOUT = (size_t)1 << FANOUT_BITS;
+    static const int MAX_LEVELS = 7;
+
+    explicit TelemetryPyramid(int column_count);
+
+    // index is the sample's position in the store; samples must arrive in order, and start again
+    // from 0 after the store is cleared.
+    void Append(size_t index, const float* values);
+
+    static size_t BucketSamples(int level) { return (size_t)1 << (FANOUT_BITS * level); }
+
+    // Any thread: a completed bucket (bucket < sample count / BucketSamples(level)), per column min, max.
+    const float* CompleteBucket(int level, size_t bucket) const { return levels_[level - 1]->At(bucket); }
+    // Writer thread: every level's unfinished bucket, MAX_LEVELS * 2 * column count floats.
+    const float* Partial() const { return partial_.data(); }
+
+    // Finest level that draws sample_count samples in at most max_points points.
+    // Raw samples take one point each, buckets two (min and max).
+    static int ChooseLevel(size_t sample_count, size_t max_points);
+
+private:
+    int column_count_;
+    std::unique_ptr<PagedArray<float>> levels_[MAX_LEVELS];     // per bucket: min, max for each column
+    std::vector<float> partial_;
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Telemetry channel schema.
+// Every channel the flight computer sends is listed once here; the sample struct, the ASCII and
+// binary decoders, the per-channel buffers, the plots and the CSV log are all generated from it.
+// To add a sensor, add one line and bump nothing else.
+//
+// X(id, label, wireIndex, type, scale, unit, plotGroups)
+//   wireIndex   position in the "Data:" frame and in the binary payload
+//   type        integer width on the binary link (ASCII accepts any number), F32 for floats
+//   scale       multiplied into the decoded value
+//   plotGroups  PlotGroup_ flags of the plot windows the channel is drawn in
+#define TELEMETRY_CHANNELS(X) \
+    X(xOrient,  "X Gyro",         0,  I16, 1.0f, "raw", PlotGroup_None) \
+    X(yOrient,  "Y Gyro",         1,  I16, 1.0f, "raw", PlotGroup_None) \
+    X(zOrient,  "Z Gyro",         2,  I16, 1.0f, "raw", PlotGroup_None) \
+    X(xAccel,   "X Acceleration", 3,  I16, 1.0f, "raw", PlotGroup_Acceleration) \
+    X(yAccel,   "Y Acceleration", 4,  I16, 1.0f, "raw", PlotGroup_Acceleration) \
+    X(zAccel,   "Z Acceleration", 5,  I16, 1.0f, "raw", PlotGroup_Acceleration) \
+    X(xMag,     "X Magnetometer", 6,  I16, 1.0f, "raw", PlotGroup_None) \
+    X(yMag,     "Y Magnetometer", 7,  I16, 1.0f, "raw", PlotGroup_None) \
+    X(zMag,     "Z Magnetometer", 8,  I16, 1.0f, "raw", PlotGroup_None) \
+    X(force,    "Force",          9,  I16, 1.0f, "raw", PlotGroup_None) \
+    X(temp,     "Temperature",    10, I16, 1.0f, "C",   PlotGroup_None) \
+    X(time,     "Rocket Time",    11, U32, 1.0f, "ms",  PlotGroup_None) \
+    X(altitude, "Altitude",       12, I32, 1.0f, "m",   PlotGroup_Overview | PlotGroup_Altitude)
+
+// Channels estimated on the ground from the raw ones by StateEstimator, on the ingest thread, and
+// carried in every sample after them. They are not sent on the link or journaled; replays and
+// exports recompute them. roll, pitch and yaw are Z-Y-X Euler angles about the sensor axes; z runs
+// along the airframe, so yaw is the spin and roll/pitch the tilt from vertical.
+//
+// X(id, label, unit, plotGroups)
+#define ESTIMATED_CHANNELS(X) \
+    X(filteredAltitude, "Altitude (filtered)", "m",   PlotGroup_Altitude) \
+    X(verticalVelocity, "Vertical Velocity",   "m/s", PlotGroup_Overview | PlotGroup_Velocity) \
+    X(roll,             "Roll",                "deg", PlotGroup_Orientation) \
+    X(pitch,            "Pitch",               "deg", PlotGroup_Orientation) \
+    X(yaw,              "Yaw",                 "deg", PlotGroup_Orientation)
+
+// The accelerometer channels are in milli-g; this converts them to m/s^2.
+#define ACCEL_MPS2 9.80665e-3f
+
+enum class ChannelType : uint8_t
+{
+    I16,
+    I32,
+    U32,
+    F32,
+};
+
+// Plot windows a channel can be drawn in
+typedef int PlotGroup;
+enum PlotGroup_
+{
+    PlotGroup_None          = 0,
+    PlotGroup_Overview      = 1 << 0,
+    PlotGroup_Altitude      = 1 << 1,
+    PlotGroup_Velocity      = 1 << 2,
+    PlotGroup_Orientation   = 1 << 3,
+    PlotGroup_Acceleration  = 1 << 4,
+};
+
+enum ChannelId
+{
+#define TELEMETRY_CHANNEL_ID(id, ...) Channel_##id,
+    TELEMETRY_CHANNELS(TELEMETRY_CHANNEL_ID)
+#undef TELEMETRY_CHANNEL_ID
+    Channel_COUNT
+};
+
+enum EstimateId
+{
+#define ESTIMATED_CHANNEL_ID(id, ...) Estimate_##id,
+    ESTIMATED_CHANNELS(ESTIMATED_CHANNEL_ID)
+#undef ESTIMATED_CHANNEL_ID
+    Estimate_COUNT
+};
+
+// TelemetrySample::format
+#define FRAME_FORMAT_ASCII 0
+#define FRAME_FORMAT_BINARY 1
+
+// One decoded telemetry frame, one float per channel and per estimated channel.
+// Kept trivially copyable so it can be moved through the ingest ring by value.
+struct TelemetrySample
+{
+#define TELEMETRY_CHANNEL_FIELD(id, ...) float id;
+    TELEMETRY_CHANNELS(TELEMETRY_CHANNEL_FIELD)
+#undef TELEMETRY_CHANNEL_FIELD
+#define ESTIMATED_CHANNEL_FIELD(id, ...) float id;
+    ESTIMATED_CHANNELS(ESTIMATED_CHANNEL_FIELD)
+#undef ESTIMATED_CHANNEL_FIELD
+
+    float hostTime;     // seconds since ingest started, at arrivalNs
+    uint32_t rocketMs;  // the time channel as sent; the float only holds every ms up to 2^24 ms (~4.7 h)
+    uint64_t arrivalNs; // MonotonicNanoseconds() when the read that completed the frame returned
+    uint64_t parsedNs;  // MonotonicNanoseconds() once the frame was decoded
+    uint16_t sequence;  // packet counter, binary frames only
+    uint8_t format;     // FRAME_FORMAT_ASCII or FRAME_FORMAT_BINARY
+};
+
+// Rocket time in seconds at full precision. Everything that takes a dt between samples uses this
+// rather than the float time channel, which skips milliseconds after a long wait on the pad.
+inline double RocketSeconds(const TelemetrySample& sample) { return sample.rocketMs / 1000.0; }
+
+struct ChannelDef
+{
+    const char* id;
+    const char* label;
+    int wireIndex;
+    ChannelType type;
+    float scale;
+    const char* unit;
+    PlotGroup plotGroups;
+    float TelemetrySample::* member;
+};
+
+constexpr ChannelDef CHANNELS[Channel_COUNT] =
+{
+#define TELEMETRY_CHANNEL_DEF(id, label, wireIndex, type, scale, unit, plotGroups) \
+    { #id, label, wireIndex, ChannelType::type, scale, unit, plotGroups, &TelemetrySample::id },
+    TELEMETRY_CHANNELS(TELEMETRY_CHANNEL_DEF)
+#undef TELEMETRY_CHANNEL_DEF
+};
+
+struct EstimateDef
+{
+    const char* id;
+    const char* label;
+    const char* unit;
+    PlotGroup plotGroups;
+    float TelemetrySample::* member;
+};
+
+constexpr EstimateDef ESTIMATES[Estimate_COUNT] =
+{
+#define ESTIMATED_CHANNEL_DEF(id, label, unit, plotGroups) { #id, label, unit, plotGroups, &TelemetrySample::id },
+    ESTIMATED_CHANNELS(ESTIMATED_CHANNEL_DEF)
+#undef ESTIMATED_CHANNEL_DEF
+};
+
+constexpr size_t ChannelWireBytes(ChannelType type)
+{
+    return type == ChannelType::I16 ? 2 : 4;
+}
+
+// Channel sent at each wire position, so decoders can walk the frame in order.
+struct ChannelWireOrder
+{
+    int Channels[Channel_COUNT];
+    bool Valid;
+
+    constexpr ChannelWireOrder() : Channels(), Valid(true)
+    {
+        for (int i = 0; i < Channel_COUNT; i++)
+            Channels[i] = -1;
+        for (int c = 0; c < Channel_COUNT; c++)
+        {
+            int wire = CHANNELS[c].wireIndex;
+            if (wire < 0 || wire >= Channel_COUNT || Channels[wire] != -1)
+                Valid = false;
+            else
+                Channels[wire] = c;
+        }
+    }
+};
+
+constexpr ChannelWireOrder WIRE_ORDER;
+static_assert(WIRE_ORDER.Valid, "TELEMETRY_CHANNELS wire indices must be unique and cover 0..Channel_COUNT-1");
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Where the ingest thread gets its bytes from: the serial link, a recorded journal, ...
+// Every method is called from the ingest thread unless noted otherwise.
+class TelemetrySource
+{
+public:
+    virtual ~TelemetrySource() {}
+
+    virtual const char* Name() const = 0;
+    virtual bool Connected() const = 0;
+
+    // The ingest thread is about to start reading; the session timeline starts here.
+    virtual void Begin() = 0;
+
+    // Waits up to timeout_ms for data. Returns the number of bytes copied into buffer, 0 if nothing
+    // arrived in time and -1 if the source failed. timeline_ns is when the bytes arrived, in
+    // nanoseconds since Begin() on the session timeline that sample hostTime is derived from.
+    virtual int Read(uint8_t* buffer, size_t length, uint32_t timeout_ms, uint64_t& timeline_ns) = 0;
+
+    // Uplink command to the flight computer.
+    virtual bool Write(const char* data) = 0;
+
+    // Any thread: makes a Read in progress return 0 now, so the ingest thread can send a queued
+    // command without waiting out the read timeout. Sources whose reads never block can ignore it.
+    virtual void Interrupt() {}
+
+    // Lossless sources make ingest wait for room in its ring instead of dropping samples, so the
+    // same input always produces the same output.
+    virtual bool Lossless() const { return false; }
+};
@@ -0,0 +1,260 @@
+#include "telemetryStore.h"
+#include <algorithm>
+#include <thread>
+#include "historyCodec.h"
+
+StoreSnapshot::StoreSnapshot(const TelemetryStore& store)
+    : store_(store), size_(0), sealed_chunks_(0), compressed_bytes_(0), epoch_(0), retired_epoch_(0), complete_buckets_(),
+      partial_((size_t)TelemetryPyramid::MAX_LEVELS * 2 * store.ColumnCount())
+{
+}
+
+size_t StoreSnapshot::LowerBound(float time) const
+{
+    // find the bucket from the kept times first, so at most one chunk is decoded
+    const size_t FANOUT = TelemetryPyramid::FANOUT;
+    size_t low = 0;
+    size_t high = BucketCount(1);
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (BucketTime(1, mid) < time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    // Time(low * FANOUT) >= time > Time((low - 1) * FANOUT)
+    high = std::min(low * FANOUT, size_);
+    low = low > 0 ? (low - 1) * FANOUT + 1 : 0;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (Time(mid) < time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+TelemetryStore::TelemetryStore(int column_count)
+    : column_count_(column_count), size_(0), chunks_(new float*[MAX_CHUNKS]),
+      sealed_(new std::unique_ptr<SealedChunk>[MAX_CHUNKS]), bucket_times_(1, 8192), pyramid_(column_count),
+      sealed_chunks_(0), compressed_bytes_(0), cache_(DECODED_CACHE_COLUMNS), cache_clock_(0), epoch_(0)
+{
+    for (DecodedColumn& entry : cache_)
+    {
+        entry.Key = UINT64_MAX;
+        entry.LastUse = 0;
+    }
+    for (std::atomic<uint64_t>& reader : reader_epochs_)
+        reader.store(READER_IDLE);
+
+    // readers always find a snapshot, if an empty one
+    snapshots_.emplace_back(new StoreSnapshot(*this));
+    published_ = snapshots_.back().get();
+    current_.store(published_);
+}
+
+bool TelemetryStore::Append(float time, const float* values)
+{
+    if (size_ == Capacity())
+        return false;
+
+    size_t chunk_index = size_ / CHUNK_SAMPLES;
+    size_t slot = size_ % CHUNK_SAMPLES;
+    float* chunk;
+
+    if (slot == 0)
+    {
+        std::unique_ptr<float[]>& raw = raw_[chunk_index % RAW_CHUNKS];
+        if (chunk_index >= RAW_CHUNKS)
+            Seal(chunk_index - RAW_CHUNKS, std::move(raw));
+        if (!raw)
+            raw = TakeRawChunk();
+        chunk = chunks_[chunk_index] = raw.get();
+        if (size_ != 0)
+        {
+            const float* previous = chunks_[chunk_index - 1];
+            for (int column = -1; column < column_count_; column++)
+                ColumnData(chunk, column)[0] = ColumnData(previous, column)[CHUNK_SAMPLES];
+        }
+    }
+    else
+        chunk = chunks_[chunk_index];
+
+    ColumnData(chunk, -1)[1 + slot] = time;
+    for (int column = 0; column < column_count_; column++)
+        ColumnData(chunk, column)[1 + slot] = values[column];
+    if (size_ % TelemetryPyramid::FANOUT == 0)
+        *bucket_times_.Extend(size_ / TelemetryPyramid::FANOUT) = time;
+    pyramid_.Append(size_, values);
+    size_++;
+    return true;
+}
+
+std::unique_ptr<float[]> TelemetryStore::TakeRawChunk()
+{
+    uint64_t oldest = OldestReaderEpoch();
+    for (size_t i = 0; i < retired_.size();)
+    {
+        if (retired_[i].Epoch <= oldest)
+        {
+            free_.push_back(std::move(retired_[i].Data));
+            retired_[i] = std::move(retired_.back());
+            retired_.pop_back();
+        }
+        else
+            i++;
+    }
+
+    if (free_.empty())
+        return std::unique_ptr<float[]>(new float[(size_t)(column_count_ + 1) * (CHUNK_SAMPLES + 1)]);
+    std::unique_ptr<float[]> raw = std::move(free_.back());
+    free_.pop_back();
+    return raw;
+}
+
+void TelemetryStore::Seal(size_t chunk, std::unique_ptr<float[]> raw)
+{
+    std::unique_ptr<SealedChunk> sealed(new SealedChunk);
+    sealed->Offsets.resize(column_count_ + 2);
+    sealed->Bytes.reserve((size_t)(column_count_ + 1) * (CHUNK_SAMPLES + 1) * 2);
+    for (int column = -1; column < column_count_; column++)
+    {
+        sealed->Offsets[column + 1] = (uint32_t)sealed->Bytes.size();
+        EncodeHistoryColumn(ColumnData(raw.get(), column), CHUNK_SAMPLES + 1, sealed->Bytes);
+    }
+    sealed->Offsets[column_count_ + 1] = (uint32_t)sealed->Bytes.size();
+    sealed->Bytes.shrink_to_fit();
+
+    compressed_bytes_ += sealed->Bytes.size();
+    sealed_[chunk] = std::move(sealed);
+    sealed_chunks_ = chunk + 1;
+
+    // readers of snapshots up to the next Publish() may still read the raw copy
+    retired_.push_back({ std::move(raw), epoch_.load() + 1 });
+}
+
+std::shared_ptr<const std::vector<float>> TelemetryStore::Decoded(size_t chunk, int column) const
+{
+    uint64_t key = (uint64_t)chunk * (column_count_ + 1) + (column + 1);
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+
+    DecodedColumn* victim = &cache_[0];
+    for (DecodedColumn& entry : cache_)
+    {
+        if (entry.Key == key)
+        {
+            entry.LastUse = ++cache_clock_;
+            return entry.Values;
+        }
+        if (entry.LastUse < victim->LastUse)
+            victim = &entry;
+    }
+
+    // reuse the least recently used buffer unless a reader is still inside it
+    if (!victim->Values || victim->Values.use_count() > 1)
+        victim->Values = std::make_shared<std::vector<float>>(CHUNK_SAMPLES + 1);
+    const SealedChunk& sealed = *sealed_[chunk];
+    DecodeHistoryColumn(&sealed.Bytes[sealed.Offsets[column + 1]], CHUNK_SAMPLES + 1, victim->Values->data());
+    victim->Key = key;
+    victim->LastUse = ++cache_clock_;
+    return victim->Values;
+}
+
+uint64_t TelemetryStore::OldestReaderEpoch() const
+{
+    uint64_t oldest = READER_IDLE;
+    for (const std::atomic<uint64_t>& reader : reader_epochs_)
+        oldest = std::min(oldest, reader.load());
+    return oldest;
+}
+
+void TelemetryStore::Publish()
+{
+    // a retired snapshot is free once no reader entered before it was replaced
+    uint64_t oldest = OldestReaderEpoch();
+    StoreSnapshot* next = nullptr;
+    for (std::unique_ptr<StoreSnapshot>& snapshot : snapshots_)
+    {
+        if (snapshot.get() != published_ && snapshot->retired_epoch_ <= oldest)
+        {
+            next = snapshot.get();
+            break;
+        }
+    }
+    if (!next)
+    {
+        snapshots_.emplace_back(new StoreSnapshot(*this));
+        next = snapshots_.back().get();
+    }
+
+    const float* partial = pyramid_.Partial();
+    std::copy(partial, partial + next->partial_.size(), next->partial_.begin());
+    next->size_ = size_;
+    next->sealed_chunks_ = sealed_chunks_;
+    next->compressed_bytes_ = compressed_bytes_;
+    for (int level = 1; level <= TelemetryPyramid::MAX_LEVELS; level++)
+        next->complete_buckets_[level - 1] = size_ / TelemetryPyramid::BucketSamples(level);
+    next->epoch_ = epoch_.load(std::memory_order_relaxed) + 1;
+
+    // the chunks, pages and completed buckets under size_ were all written before this store
+    current_.store(next);
+    published_->retired_epoch_ = epoch_.fetch_add(1) + 1;
+    published_ = next;
+}
+
+void TelemetryStore::Clear()
+{
+    size_t sealed_chunks = sealed_chunks_;
+    size_ = 0;
+    sealed_chunks_ = 0;
+    compressed_bytes_ = 0;
+    Publish();
+
+    // synchronize: every reader has to be past the empty snapshot before the chunks are rewritten
+    uint64_t epoch = epoch_.load();
+    while (OldestReaderEpoch() < epoch)
+        std::this_thread::yield();
+
+    for (size_t chunk = 0; chunk < sealed_chunks; chunk++)
+        sealed_[chunk].reset();
+    for (RetiredChunk& retired : retired_)
+        free_.push_back(std::move(retired.Data));
+    retired_.clear();
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (DecodedColumn& entry : cache_)
+    {
+        entry.Key = UINT64_MAX;
+        entry.LastUse = 0;
+    }
+}
+
+TelemetryStore::Reader::Reader(const TelemetryStore& store)
+    : store_(store), slot_(-1), snapshot_(nullptr)
+{
+    // Announce the epoch before loading the snapshot: a writer that misses the announcement has
+    // already published a newer snapshot, so this reader cannot load one it may recycle.
+    for (;;)
+    {
+        for (int slot = 0; slot < MAX_READERS; slot++)
+        {
+            uint64_t idle = READER_IDLE;
+            if (store_.reader_epochs_[slot].compare_exchange_strong(idle, store_.epoch_.load()))
+            {
+                slot_ = slot;
+                snapshot_ = store_.current_.load();
+                return;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+TelemetryStore::Reader::~Reader()
+{
+    store_.reader_epochs_[slot_].store(READER_IDLE);
+}
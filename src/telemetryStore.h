@@ -0,0 +1,254 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "pagedArray.h"
+#include "telemetryPyramid.h"
+
+class TelemetryStore;
+
+// Immutable view of a TelemetryStore as of one Publish(). Everything it reads stays valid and
+// unchanged for as long as a TelemetryStore::Reader holds it, whatever the writer does meanwhile.
+class StoreSnapshot
+{
+public:
+    explicit StoreSnapshot(const TelemetryStore& store);
+
+    int ColumnCount() const;
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+    // Publish() count; a reader can skip work when it has not changed.
+    uint64_t Epoch() const { return epoch_; }
+
+    float Time(size_t index) const;
+    float Value(int column, size_t index) const;
+
+    // Index of the first sample with Time() >= time, or Size() if there is none.
+    size_t LowerBound(float time) const;
+
+    // Samples [0, SealedSamples()) are held compressed; reading them decodes whole chunk columns
+    // into the store's cache, so prefer ForEachSpan() to Time()/Value() there.
+    size_t SealedSamples() const;
+    size_t CompressedBytes() const { return compressed_bytes_; }
+
+    // Pyramid buckets of level over the snapshot's samples, the last one possibly unfinished.
+    size_t BucketCount(int level) const { return (size_ + TelemetryPyramid::BucketSamples(level) - 1) / TelemetryPyramid::BucketSamples(level); }
+    // Time of a bucket's first sample; never decodes.
+    float BucketTime(int level, size_t bucket) const;
+    float Min(int level, int column, size_t bucket) const { return Bucket(level, bucket)[2 * column]; }
+    float Max(int level, int column, size_t bucket) const { return Bucket(level, bucket)[2 * column + 1]; }
+
+    // Calls fn(const float* times, const float* values, int count) for each contiguous run of
+    // samples [first, last) in column. Runs after the first include the bridging sample. The
+    // pointers are only valid during the call.
+    template<typename Fn>
+    void ForEachSpan(int column, size_t first, size_t last, Fn fn) const;
+
+private:
+    friend class TelemetryStore;
+
+    const float* Bucket(int level, size_t bucket) const;
+    float Sample(int column, size_t index) const;
+
+    const TelemetryStore& store_;
+    size_t size_;
+    size_t sealed_chunks_;          // leading chunks read from their compressed copy
+    size_t compressed_bytes_;
+    uint64_t epoch_;
+    uint64_t retired_epoch_;        // writer only: the epoch that replaced this snapshot
+    size_t complete_buckets_[TelemetryPyramid::MAX_LEVELS];
+    std::vector<float> partial_;    // each pyramid level's unfinished bucket at size_
+};
+
+// Columnar time-series store for a whole session.
+// One shared timestamp column plus one float column per channel, kept in fixed-size chunks.
+// Appending never moves or copies stored samples.
+//
+// Each chunk starts with a copy of the previous chunk's last sample, so a plot drawn chunk by
+// chunk has no gap at the chunk boundaries. A min/max pyramid is maintained alongside for
+// drawing long time ranges.
+//
+// Only the newest RAW_CHUNKS chunks stay as plain floats. Older ones are sealed: every column is
+// compressed with EncodeHistoryColumn() and the raw chunk goes back to a pool once no reader can
+// still see it. Sealed columns are decoded a whole chunk at a time when something reads them,
+// into a small cache shared by all readers (the only lock on the read side). The time of every
+// FANOUT-th sample is also kept apart, so seeking and pyramid plots never decode.
+//
+// One writer thread appends and calls Publish(); any number of readers (up to MAX_READERS at a
+// time) read the last published StoreSnapshot through a Reader, without locks and without ever
+// making the writer wait. Snapshots are recycled RCU style: the writer reuses one only after
+// every reader that could still see it has moved to a later epoch.
+class TelemetryStore
+{
+public:
+    static const size_t CHUNK_SAMPLES = 4096;
+    static const size_t MAX_CHUNKS = 65536;
+    static const size_t RAW_CHUNKS = 4;                 // newest chunks, the one being appended included
+    static const size_t DECODED_CACHE_COLUMNS = 64;     // decoded chunk columns kept for readers
+    static const int MAX_READERS = 8;
+
+    explicit TelemetryStore(int column_count);
+
+    TelemetryStore(const TelemetryStore&) = delete;
+    TelemetryStore& operator=(const TelemetryStore&) = delete;
+
+    // Writer. values holds one entry per column. time must not decrease between calls.
+    // Returns false once the store is full.
+    bool Append(float time, const float* values);
+    // Writer: makes everything appended so far visible to readers.
+    void Publish();
+    // Writer: drops every sample and sealed chunk but keeps raw chunks for reuse. Waits for readers
+    // still holding a snapshot from before, so never call it from a thread that holds a Reader.
+    void Clear();
+
+    int ColumnCount() const { return column_count_; }
+    // Writer: samples appended, published or not.
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+    size_t Capacity() const { return MAX_CHUNKS * CHUNK_SAMPLES; }
+
+    // Pins the latest snapshot until destroyed. Any thread; waits only if MAX_READERS are already held.
+    class Reader
+    {
+    public:
+        explicit Reader(const TelemetryStore& store);
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const StoreSnapshot& Snapshot() const { return *snapshot_; }
+
+    private:
+        const TelemetryStore& store_;
+        int slot_;
+        const StoreSnapshot* snapshot_;
+    };
+
+private:
+    friend class StoreSnapshot;
+
+    static const uint64_t READER_IDLE = UINT64_MAX;
+
+    // Every column of one chunk, compressed; column c's stream starts at Offsets[c + 1].
+    struct SealedChunk
+    {
+        std::vector<uint32_t> Offsets;
+        std::vector<uint8_t> Bytes;
+    };
+
+    struct RetiredChunk
+    {
+        std::unique_ptr<float[]> Data;
+        uint64_t Epoch;             // free once every reader is at this epoch or later
+    };
+
+    struct DecodedColumn
+    {
+        uint64_t Key;               // chunk * (column_count_ + 1) + column + 1, UINT64_MAX if unused
+        uint64_t LastUse;
+        std::shared_ptr<std::vector<float>> Values;     // CHUNK_SAMPLES + 1, as in a raw chunk
+    };
+
+    // column -1 is the time column
+    const float* ColumnData(const float* chunk, int column) const { return chunk + (size_t)(column + 1) * (CHUNK_SAMPLES + 1); }
+    float* ColumnData(float* chunk, int column) { return chunk + (size_t)(column + 1) * (CHUNK_SAMPLES + 1); }
+    const float* Chunk(size_t chunk) const { return chunks_[chunk]; }
+    uint64_t OldestReaderEpoch() const;
+
+    std::unique_ptr<float[]> TakeRawChunk();
+    void Seal(size_t chunk, std::unique_ptr<float[]> raw);
+    // Any reader: one column of a sealed chunk, from the cache or decoded into it.
+    std::shared_ptr<const std::vector<float>> Decoded(size_t chunk, int column) const;
+
+    int column_count_;
+    size_t size_;
+    std::unique_ptr<float*[]> chunks_;      // MAX_CHUNKS entries, so it never has to move
+    std::unique_ptr<std::unique_ptr<SealedChunk>[]> sealed_;   // MAX_CHUNKS entries
+    PagedArray<float> bucket_times_;        // time of every TelemetryPyramid::FANOUT-th sample
+    TelemetryPyramid pyramid_;
+
+    // writer only: raw chunk buffers, the newest RAW_CHUNKS by chunk % RAW_CHUNKS
+    std::unique_ptr<float[]> raw_[RAW_CHUNKS];
+    std::vector<RetiredChunk> retired_;
+    std::vector<std::unique_ptr<float[]>> free_;
+    size_t sealed_chunks_;
+    size_t compressed_bytes_;
+
+    mutable std::mutex cache_mutex_;
+    mutable std::vector<DecodedColumn> cache_;
+    mutable uint64_t cache_clock_;
+
+    // writer only, except the atomics
+    std::vector<std::unique_ptr<StoreSnapshot>> snapshots_;
+    StoreSnapshot* published_;
+    std::atomic<const StoreSnapshot*> current_;
+    std::atomic<uint64_t> epoch_;
+    mutable std::atomic<uint64_t> reader_epochs_[MAX_READERS];
+};
+
+inline int StoreSnapshot::ColumnCount() const { return store_.column_count_; }
+inline size_t StoreSnapshot::SealedSamples() const { return sealed_chunks_ * TelemetryStore::CHUNK_SAMPLES; }
+inline float StoreSnapshot::Time(size_t index) const { return Sample(-1, index); }
+inline float StoreSnapshot::Value(int column, size_t index) const { return Sample(column, index); }
+
+inline float StoreSnapshot::Sample(int column, size_t index) const
+{
+    size_t chunk = index / TelemetryStore::CHUNK_SAMPLES;
+    size_t slot = 1 + index % TelemetryStore::CHUNK_SAMPLES;
+    if (chunk >= sealed_chunks_)
+        return store_.ColumnData(store_.Chunk(chunk), column)[slot];
+    return (*store_.Decoded(chunk, column))[slot];
+}
+
+inline float StoreSnapshot::BucketTime(int level, size_t bucket) const
+{
+    return *store_.bucket_times_.At(bucket << (TelemetryPyramid::FANOUT_BITS * (level - 1)));
+}
+
+inline const float* StoreSnapshot::Bucket(int level, size_t bucket) const
+{
+    if (bucket < complete_buckets_[level - 1])
+        return store_.pyramid_.CompleteBucket(level, bucket);
+    return &partial_[(size_t)(level - 1) * 2 * store_.column_count_];
+}
+
+template<typename Fn>
+void StoreSnapshot::ForEachSpan(int column, size_t first, size_t last, Fn fn) const
+{
+    const size_t CHUNK_SAMPLES = TelemetryStore::CHUNK_SAMPLES;
+    size_t index = first;
+    while (index < last)
+    {
+        size_t chunk = index / CHUNK_SAMPLES;
+        size_t slot = 1 + index % CHUNK_SAMPLES;
+        size_t run_end = (chunk + 1) * CHUNK_SAMPLES;
+        if (run_end > last)
+            run_end = last;
+        size_t count = run_end - index;
+
+        if (index != first)
+        {
+            slot--;
+            count++;
+        }
+
+        if (chunk < sealed_chunks_)
+        {
+            std::shared_ptr<const std::vector<float>> times = store_.Decoded(chunk, -1);
+            std::shared_ptr<const std::vector<float>> values = store_.Decoded(chunk, column);
+            fn(times->data() + slot, values->data() + slot, (int)count);
+        }
+        else
+        {
+            const float* times = store_.ColumnData(store_.Chunk(chunk), -1) + slot;
+            const float* values = store_.ColumnData(store_.Chunk(chunk), column) + slot;
+            fn(times, values, (int)count);
+        }
+        index = run_end;
+    }
+}
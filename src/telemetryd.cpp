@@ -0,0 +1,387 @@
+// Headless ground-station recorder.
+//
+// Runs the same ingest, decode and flight-journal path as the GUI with no window and no rendering,
+// so a low-power box at the pad can capture at full link rate. The UI thread's only job here is
+// to drain the sample ring, print a status line now and then and report flight events as the
+// ingest thread detects them.
+//
+// Usage:
+//   telemetryd [--journal flight.tvj] [--stats seconds] [--duration seconds]
+//              [--multicast 239.255.76.1:7600] [--websocket 7601] [--shm telemetryview] <source>
+// Publishing (off unless asked for):
+//   --multicast group:port             decoded samples as UDP multicast datagrams, sent on loopback
+//   --websocket port                   decoded samples to WebSocket subscribers on 127.0.0.1:port
+//   --shm name                         decoded samples into a shared-memory ring (see telemetrytap)
+// Sources:
+//   --port COM5 [--baud 9600]          serial link; /dev/ttyUSB0 or a pty slave on POSIX. Repeat
+//                                      --port for redundant radios on the same vehicle: their
+//                                      samples are merged and de-duplicated
+//   --input capture.bin                raw bytes from a file or fifo (POSIX; default stdin)
+//   --replay old.tvj [--speed N]       re-decode a recorded journal; 0 = as fast as possible
+// Stops cleanly on Ctrl+C, at the end of a replay or input file, or after --duration.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "flightRecorder.h"
+#include "latencyHistogram.h"
+#include "replaySource.h"
+#include "samplePublisher.h"
+#include "serialSource.h"
+#include "sharedSampleRing.h"
+#include "telemetryIngest.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static std::atomic<bool> stopRequested(false);
+
+static void OnSignal(int)
+{
+    stopRequested.store(true);
+}
+
+#ifndef _WIN32
+// Raw bytes from an already-open descriptor: a fifo fed by socat, a capture file, stdin.
+class DescriptorSource : public TelemetrySource
+{
+public:
+    explicit DescriptorSource(int fd) : fd_(fd), origin_ns_(0), ended_(false)
+    {
+        struct stat info;
+        regular_file_ = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+    }
+
+    const char* Name() const override { return "Input"; }
+    bool Connected() const override { return fd_ >= 0; }
+    bool Ended() const { return ended_.load(); }
+
+    void Begin() override
+    {
+        origin_ns_ = MonotonicNanoseconds();
+    }
+
+    int Read(uint8_t* buffer, size_t length, uint32_t timeout_ms, uint64_t& timeline_ns) override
+    {
+        if (ended_.load())
+            return -1;
+
+        pollfd descriptor = { fd_, POLLIN, 0 };
+        int ready = poll(&descriptor, 1, (int)timeout_ms);
+        if (ready <= 0)
+            return ready < 0 ? -1 : 0;
+
+        ssize_t bytes_read = read(fd_, buffer, length);
+        timeline_ns = MonotonicNanoseconds() - origin_ns_;
+        if (bytes_read <= 0)
+        {
+            // end of file, or the device went away
+            ended_.store(true);
+            return -1;
+        }
+        return (int)bytes_read;
+    }
+
+    bool Write(const char* data) override
+    {
+        size_t length = strlen(data);
+        return write(fd_, data, length) == (ssize_t)length;
+    }
+
+    // a capture file is read far faster than any link delivers it; nothing is lost by waiting
+    bool Lossless() const override { return regular_file_; }
+
+private:
+    int fd_;
+    uint64_t origin_ns_;
+    std::atomic<bool> ended_;
+    bool regular_file_;
+};
+#endif
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: telemetryd [--journal path] [--stats seconds] [--duration seconds]\n"
+        "                  [--multicast group:port] [--websocket port] [--shm name] <source>\n"
+        "  --port name [--port name ...] [--baud 9600]\n"
+#ifndef _WIN32
+        "  --input path                (default: stdin)\n"
+#endif
+        "  --replay journal [--speed N]\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::string journalPath;
+    std::string replayPath;
+    double replaySpeed = 0.0;
+    double statsSeconds = 1.0;
+    double durationSeconds = 0.0;
+    std::vector<std::string> ports;
+    unsigned long baud = 9600;
+    PublisherConfig publish;
+    publish.MulticastGroup.clear();
+    std::string shmName;
+#ifndef _WIN32
+    std::string inputPath;
+#endif
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value)
+        {
+            PrintUsage();
+            return 2;
+        }
+
+        if (!strcmp(arg, "--journal"))
+            journalPath = value;
+        else if (!strcmp(arg, "--replay"))
+            replayPath = value;
+        else if (!strcmp(arg, "--speed"))
+            replaySpeed = atof(value);
+        else if (!strcmp(arg, "--stats"))
+            statsSeconds = atof(value);
+        else if (!strcmp(arg, "--duration"))
+            durationSeconds = atof(value);
+        else if (!strcmp(arg, "--port"))
+            ports.push_back(value);
+        else if (!strcmp(arg, "--baud"))
+            baud = strtoul(value, nullptr, 10);
+        else if (!strcmp(arg, "--multicast"))
+        {
+            const char* colon = strchr(value, ':');
+            publish.MulticastGroup.assign(value, colon ? colon - value : strlen(value));
+            if (colon)
+                publish.MulticastPort = (uint16_t)atoi(colon + 1);
+        }
+        else if (!strcmp(arg, "--websocket"))
+            publish.WebSocketPort = (uint16_t)atoi(value);
+        else if (!strcmp(arg, "--shm"))
+            shmName = value;
+#ifndef _WIN32
+        else if (!strcmp(arg, "--input"))
+            inputPath = value;
+#endif
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+        i++;
+    }
+
+    // a live link is always journaled; a replay only when asked to
+    if (journalPath.empty() && replayPath.empty())
+        journalPath = "flight.tvj";
+
+#ifdef _WIN32
+    if (ports.empty())
+        ports.push_back("COM5");
+#else
+    DescriptorSource* input = nullptr;
+#endif
+    ReplaySource replay;
+    std::vector<std::unique_ptr<SerialSource>> serialLinks;
+    TelemetrySource* source = nullptr;
+
+    if (!replayPath.empty())
+    {
+        if (!replay.Load(replayPath))
+        {
+            fprintf(stderr, "telemetryd: no raw link data in %s\n", replayPath.c_str());
+            return 1;
+        }
+        replay.SetSpeed(replaySpeed);
+        source = &replay;
+    }
+    else if (!ports.empty())
+    {
+        for (const std::string& port : ports)
+        {
+            serialLinks.emplace_back(new SerialSource(port, (DWORD)baud));
+            if (!serialLinks.back()->Connected())
+            {
+                fprintf(stderr, "telemetryd: cannot open %s\n", port.c_str());
+                return 1;
+            }
+        }
+        source = serialLinks[0].get();
+    }
+#ifndef _WIN32
+    else
+    {
+        int fd = inputPath.empty() ? STDIN_FILENO : open(inputPath.c_str(), O_RDONLY | O_NOCTTY);
+        if (fd < 0)
+        {
+            fprintf(stderr, "telemetryd: cannot open %s\n", inputPath.c_str());
+            return 1;
+        }
+        input = new DescriptorSource(fd);
+        source = input;
+    }
+#endif
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+
+    FlightRecorder recorder;
+    TelemetryIngest ingest(source);
+    for (size_t link = 1; link < serialLinks.size(); link++)
+        ingest.AddLink(serialLinks[link].get());
+    if (!journalPath.empty())
+    {
+        if (!recorder.Start(journalPath))
+        {
+            fprintf(stderr, "telemetryd: cannot open journal %s\n", journalPath.c_str());
+            return 1;
+        }
+        if (recorder.RecoveredRecords())
+            fprintf(stderr, "telemetryd: recovered %llu records from %s\n",
+                (unsigned long long)recorder.RecoveredRecords(), journalPath.c_str());
+        ingest.SetRecorder(&recorder);
+    }
+
+    SamplePublisher publisher;
+    if (!publish.MulticastGroup.empty() || publish.WebSocketPort != 0)
+    {
+        if (!publisher.Start(publish))
+        {
+            fprintf(stderr, "telemetryd: cannot open the publisher's sockets\n");
+            return 1;
+        }
+        ingest.SetPublisher(&publisher);
+        if (!publish.MulticastGroup.empty())
+            fprintf(stderr, "telemetryd: publishing to multicast %s:%u\n", publish.MulticastGroup.c_str(),
+                (unsigned)publish.MulticastPort);
+        if (publish.WebSocketPort != 0)
+            fprintf(stderr, "telemetryd: publishing to WebSocket subscribers on port %u\n", (unsigned)publish.WebSocketPort);
+    }
+
+    SharedSampleWriter sharedRing;
+    if (!shmName.empty())
+    {
+        if (!sharedRing.Open(shmName))
+        {
+            fprintf(stderr, "telemetryd: cannot create shared memory ring %s\n", shmName.c_str());
+            return 1;
+        }
+        ingest.SetSharedRing(&sharedRing);
+        fprintf(stderr, "telemetryd: writing samples to shared memory ring %s\n", shmName.c_str());
+    }
+
+    fprintf(stderr, "telemetryd: recording from %s", source->Name());
+    for (int link = 1; link < ingest.LinkCount(); link++)
+        fprintf(stderr, " + %s", ingest.Source(link)->Name());
+    fprintf(stderr, "%s%s\n", journalPath.empty() ? "" : " to ", journalPath.c_str());
+
+    LatencyHistogram drainLatency;
+    static TelemetrySample pending[256];
+    uint64_t startNs = MonotonicNanoseconds();
+    uint64_t nextStatsNs = startNs + (uint64_t)(statsSeconds * 1e9);
+    uint32_t reportedEvents = 0;
+    ingest.Start();
+
+    while (!stopRequested.load())
+    {
+        size_t count;
+        while ((count = ingest.Drain(pending, 256)) > 0)
+        {
+            uint64_t now = MonotonicNanoseconds();
+            for (size_t i = 0; i < count; i++)
+                drainLatency.Record(now - pending[i].arrivalNs);
+        }
+
+        // onset is the sample that started the event's condition; confirmation adds the hold time
+        uint32_t events = ingest.FlightEvents();
+        for (int event = 0; event < FlightEvent_COUNT; event++)
+        {
+            FlightEventRecord record;
+            if ((events & ~reportedEvents & (1u << event)) && ingest.FlightEventRecorded((FlightEvent)event, record))
+                fprintf(stderr, "telemetryd: %s at rocket time %.3f s (host %.3f s), confirmed %.0f ms later\n",
+                    FLIGHT_EVENT_NAMES[event], record.RocketTime, record.HostTime,
+                    (record.ConfirmedRocketTime - record.RocketTime) * 1000.0);
+        }
+        reportedEvents = events;
+
+        uint64_t now = MonotonicNanoseconds();
+        if (statsSeconds > 0 && now >= nextStatsNs)
+        {
+            fprintf(stderr, "%8.1fs  %-6s  frames %llu  rejected %llu  lost %llu  dropped %llu  merge %llu copies %llu late"
+                "  journal %llu (%llu dropped)%s  arrival->drain p50 %.2f ms p99 %.2f ms\n",
+                (now - startNs) * 1e-9, FLIGHT_PHASE_NAMES[ingest.Phase()],
+                (unsigned long long)ingest.FramesDecoded(), (unsigned long long)ingest.FramesRejected(),
+                (unsigned long long)ingest.PacketsLost(), (unsigned long long)ingest.FramesDropped(),
+                (unsigned long long)ingest.MergeDuplicates(), (unsigned long long)ingest.MergeLate(),
+                (unsigned long long)recorder.RecordsWritten(), (unsigned long long)recorder.RecordsDropped(),
+                recorder.WriteFailed() ? " WRITE FAILED" : "",
+                drainLatency.Percentile(0.5) * 1e-6, drainLatency.Percentile(0.99) * 1e-6);
+            drainLatency.Reset();
+            if (publisher.Running())
+                fprintf(stderr, "          publish  samples %llu (%llu dropped)  datagrams %llu (%llu dropped)  subscribers %d (%llu packets dropped)\n",
+                    (unsigned long long)publisher.SamplesPublished(), (unsigned long long)publisher.SamplesDropped(),
+                    (unsigned long long)publisher.PacketsSent(), (unsigned long long)publisher.MulticastDropped(),
+                    publisher.Subscribers(), (unsigned long long)publisher.SubscriberDropped());
+            for (int link = 0; ingest.LinkCount() > 1 && link < ingest.LinkCount(); link++)
+            {
+                LinkHealth health = ingest.Health(link);
+                fprintf(stderr, "          %-14s %s  frames %llu  rejected %llu  lost %llu  restarts %llu  duplicates %llu  late %llu  silent %.1f s%s\n",
+                    ingest.Source(link)->Name(), health.Connected ? "up  " : "DOWN", (unsigned long long)health.FramesDecoded,
+                    (unsigned long long)health.FramesRejected, (unsigned long long)health.PacketsLost,
+                    (unsigned long long)health.SequenceRestarts,
+                    (unsigned long long)health.Duplicates, (unsigned long long)health.Late,
+                    health.LastArrivalNs ? (now - std::min(now, health.LastArrivalNs)) * 1e-9 : (now - startNs) * 1e-9,
+                    link == ingest.UplinkLink() ? "  (uplink)" : "");
+            }
+            nextStatsNs = now + (uint64_t)(statsSeconds * 1e9);
+        }
+
+        if (durationSeconds > 0 && now - startNs >= (uint64_t)(durationSeconds * 1e9))
+            break;
+        // every read before the end of the recording has been decoded into the ring by now
+        if (source == &replay && replay.Finished())
+            break;
+#ifndef _WIN32
+        if (input && input->Ended())
+            break;
+#endif
+
+        // the ring holds RING_CAPACITY samples; a few ms between drains keeps far ahead of any link
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    ingest.Stop();
+    while (ingest.Drain(pending, 256) > 0)
+        ;
+    recorder.Stop();
+    publisher.Stop();
+    sharedRing.Close();
+
+    double seconds = (MonotonicNanoseconds() - startNs) * 1e-9;
+    fprintf(stderr, "telemetryd: %llu frames in %.2f s (%.0f frames/s), %llu rejected, %llu dropped "
+        "(merge: %llu copies, %llu late), %llu journal records\n",
+        (unsigned long long)ingest.FramesDecoded(), seconds, ingest.FramesDecoded() / seconds,
+        (unsigned long long)ingest.FramesRejected(), (unsigned long long)ingest.FramesDropped(),
+        (unsigned long long)ingest.MergeDuplicates(), (unsigned long long)ingest.MergeLate(),
+        (unsigned long long)recorder.RecordsWritten());
+
+#ifndef _WIN32
+    delete input;
+#endif
+    return recorder.WriteFailed() ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+// Synthetic telemetry source.
+//
+// Streams the frames of a simulated flight (pad, boost, coast, apogee, drogue, main, landing) the
+// way the flight computer's radio would, so the ground station can be driven without hardware.
+//
+// Usage:
+//   telemetrygen [options]
+//   --rate N          frames per second of flight time (default 100)
+//   --speed N         1 = real time (default), N = N times faster, 0 = as fast as possible
+//   --duration s      stop after s seconds of flight time (default: one whole flight)
+//   --binary f        fraction of frames sent as COBS binary packets (0..1, default 0)
+//   --noise x         sensor noise scale (default 1, 0 = clean)
+//   --corrupt f       fraction of frames with one bit flipped (default 0)
+//   --seed n          noise and corruption seed (default 1)
+//   --output path     file, fifo or serial device to write to (default stdout)
+//   --pty             create a pseudo-terminal pair and write to it (POSIX); prints the port to open
+//
+// With --pty, uplink commands ("{Cmd:<seq>:<code>}") are answered with "{Ack:<seq>}" between
+// frames, as the flight computer does, and logged to stderr.
+// e.g. `telemetrygen --pty --rate 500` and point telemetryd or TelemetryView at the printed port,
+// or `telemetrygen --speed 0 --output flight.txt` for a capture file.
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "latencyHistogram.h"
+#include "telemetryGenerator.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: telemetrygen [--rate N] [--speed N] [--duration s] [--binary f] [--noise x] [--corrupt f]\n"
+        "                    [--seed n] [--output path | --pty]\n");
+}
+
+#ifndef _WIN32
+// Acknowledges every complete uplink command waiting on fd, without blocking.
+static void AnswerCommands(int fd, std::string& pending, FILE* out)
+{
+    struct pollfd readable = { fd, POLLIN, 0 };
+    char chunk[256];
+    while (poll(&readable, 1, 0) > 0 && (readable.revents & POLLIN))
+    {
+        ssize_t bytes_read = read(fd, chunk, sizeof(chunk));
+        if (bytes_read <= 0)
+            break;
+        pending.append(chunk, bytes_read);
+    }
+
+    size_t front;
+    while ((front = pending.find('{')) != std::string::npos)
+    {
+        size_t end = pending.find('}', front);
+        if (end == std::string::npos)
+            break;
+        unsigned sequence;
+        char code;
+        std::string frame = pending.substr(front + 1, end - front - 1);
+        pending.erase(0, end + 1);
+        if (sscanf(frame.c_str(), "Cmd:%u:%c", &sequence, &code) != 2)
+            continue;
+        fprintf(out, "{Ack:%u}", sequence);
+        fflush(out);
+        fprintf(stderr, "telemetrygen: command #%u '%c' acknowledged\n", sequence, code);
+    }
+    // bare legacy commands and noise
+    if (pending.find('{') == std::string::npos)
+        pending.clear();
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    double rate = 100.0;
+    double speed = 1.0;
+    double duration = 0.0;
+    double binaryFraction = 0.0;
+    double noise = 1.0;
+    double corruptFraction = 0.0;
+    uint32_t seed = 1;
+    std::string outputPath;
+    bool usePty = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (!strcmp(arg, "--pty"))
+        {
+            usePty = true;
+            continue;
+        }
+
+        const char* value = i + 1 < argc ? argv[++i] : nullptr;
+        if (!value)
+        {
+            PrintUsage();
+            return 2;
+        }
+
+        if (!strcmp(arg, "--rate"))
+            rate = atof(value);
+        else if (!strcmp(arg, "--speed"))
+            speed = atof(value);
+        else if (!strcmp(arg, "--duration"))
+            duration = atof(value);
+        else if (!strcmp(arg, "--binary"))
+            binaryFraction = atof(value);
+        else if (!strcmp(arg, "--noise"))
+            noise = atof(value);
+        else if (!strcmp(arg, "--corrupt"))
+            corruptFraction = atof(value);
+        else if (!strcmp(arg, "--seed"))
+            seed = (uint32_t)strtoul(value, nullptr, 10);
+        else if (!strcmp(arg, "--output"))
+            outputPath = value;
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (rate <= 0.0)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    FILE* out = stdout;
+    int commandFd = -1;
+#ifndef _WIN32
+    if (usePty)
+    {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        {
+            fprintf(stderr, "telemetrygen: could not open a pseudo-terminal pair\n");
+            return 1;
+        }
+        // hold the slave open in raw mode so frames queue (instead of failing or being echoed
+        // back) until a reader attaches
+        int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+        struct termios options;
+        if (slave >= 0 && tcgetattr(slave, &options) == 0)
+        {
+            cfmakeraw(&options);
+            tcsetattr(slave, TCSANOW, &options);
+        }
+        printf("%s\n", ptsname(master));
+        fflush(stdout);
+        out = fdopen(master, "wb");
+        commandFd = master;
+    }
+#else
+    if (usePty)
+    {
+        fprintf(stderr, "telemetrygen: --pty needs a POSIX system; use a virtual COM port pair and --output\n");
+        return 2;
+    }
+    // binary packets contain 0x0A bytes that text mode would expand
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    if (!outputPath.empty())
+        out = fopen(outputPath.c_str(), "wb");
+    if (!out)
+    {
+        fprintf(stderr, "telemetrygen: cannot open %s\n", outputPath.c_str());
+        return 1;
+    }
+
+    TelemetryGenerator generator(FlightProfile(), seed);
+    generator.SetNoise(noise);
+    generator.SetBinaryFraction(binaryFraction);
+    generator.SetCorruptFraction(corruptFraction);
+    if (duration <= 0.0)
+        duration = generator.Duration();
+
+    uint64_t totalFrames = (uint64_t)(duration * rate);
+    uint64_t startNs = MonotonicNanoseconds();
+    std::vector<uint8_t> buffer(64 * 1024);
+    uint64_t frame = 0;
+    std::string commands;
+
+    while (frame < totalFrames)
+    {
+#ifndef _WIN32
+        if (commandFd >= 0)
+            AnswerCommands(commandFd, commands, out);
+#endif
+
+        // every frame due by now, in one write
+        uint64_t due = totalFrames;
+        if (speed > 0.0)
+        {
+            double elapsed = (MonotonicNanoseconds() - startNs) * 1e-9;
+            due = std::min<uint64_t>(totalFrames, (uint64_t)(elapsed * speed * rate) + 1);
+        }
+
+        size_t length = 0;
+        while (frame < due && length + TelemetryGenerator::MAX_FRAME_BYTES <= buffer.size())
+        {
+            length += generator.NextFrame(frame / rate, buffer.data() + length);
+            frame++;
+        }
+
+        if (length > 0)
+        {
+            if (fwrite(buffer.data(), 1, length, out) != length)
+                break;
+            fflush(out);
+        }
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+
+    fprintf(stderr, "telemetrygen: %llu frames (%llu corrupted) in %.2f s\n",
+        (unsigned long long)generator.FramesGenerated(), (unsigned long long)generator.FramesCorrupted(),
+        (MonotonicNanoseconds() - startNs) * 1e-9);
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
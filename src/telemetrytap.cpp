@@ -0,0 +1,150 @@
+// Example consumer of the shared-memory sample ring.
+//
+// Follows the decoded sample stream of a TelemetryView or telemetryd on the same machine through
+// SharedSampleReader: no sockets, no locks, and nothing it does can slow the ground station. It
+// prints a status line now and then (samples/s, samples lost to overruns, and the delay from the
+// read that completed each frame to this process copying it out), and optionally the samples
+// themselves. When the writer goes away it waits for the next one.
+//
+// Usage:
+//   telemetrytap [--name telemetryview] [--stats seconds] [--print] [--oldest] [--spin]
+//   --name n          ring name, as given to the writer (default telemetryview)
+//   --stats s         seconds between status lines, 0 = none (default 1)
+//   --print           one line per sample: host time, sequence and every channel, tab separated
+//   --oldest          start at the oldest sample still in the ring instead of the newest
+//   --spin            poll without sleeping, for the lowest delay at the cost of a core
+
+#include <chrono>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include "latencyHistogram.h"
+#include "sharedSampleRing.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void OnSignal(int)
+{
+    stopRequested = 1;
+}
+
+static void PrintSample(const TelemetrySample& sample)
+{
+    printf("%.3f\t%u", sample.hostTime, (unsigned)sample.sequence);
+    for (const ChannelDef& channel : CHANNELS)
+        printf("\t%g", sample.*channel.member);
+    for (const EstimateDef& estimate : ESTIMATES)
+        printf("\t%g", sample.*estimate.member);
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::string name = SHARED_RING_DEFAULT_NAME;
+    double statsSeconds = 1.0;
+    bool print = false;
+    bool oldest = false;
+    bool spin = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (!strcmp(arg, "--print"))
+            print = true;
+        else if (!strcmp(arg, "--oldest"))
+            oldest = true;
+        else if (!strcmp(arg, "--spin"))
+            spin = true;
+        else if (!strcmp(arg, "--name") && i + 1 < argc)
+            name = argv[++i];
+        else if (!strcmp(arg, "--stats") && i + 1 < argc)
+            statsSeconds = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: telemetrytap [--name ring] [--stats seconds] [--print] [--oldest] [--spin]\n");
+            return 2;
+        }
+    }
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+
+    if (print)
+    {
+        printf("hostTime\tsequence");
+        for (const ChannelDef& channel : CHANNELS)
+            printf("\t%s", channel.id);
+        for (const EstimateDef& estimate : ESTIMATES)
+            printf("\t%s", estimate.id);
+        printf("\n");
+    }
+
+    SharedSampleReader reader;
+    LatencyHistogram delay;
+    static TelemetrySample samples[256];
+    uint64_t total = 0;
+    uint64_t intervalSamples = 0;
+    uint64_t reportedOverruns = 0;
+    uint64_t intervalStart = MonotonicNanoseconds();
+    bool waitingReported = false;
+
+    while (!stopRequested)
+    {
+        if (!reader.IsOpen() || !reader.WriterOpen())
+        {
+            if (reader.IsOpen())
+            {
+                // the rest of the closed ring is still readable
+                size_t count;
+                while ((count = reader.Read(samples, 256)) > 0)
+                    total += count;
+                fprintf(stderr, "telemetrytap: writer closed the ring after %llu samples (%llu lost to overruns)\n",
+                    (unsigned long long)total, (unsigned long long)reader.Overruns());
+                reader.Close();
+            }
+            if (!reader.Open(name, oldest))
+            {
+                if (!waitingReported)
+                    fprintf(stderr, "telemetrytap: waiting for a writer on %s\n", name.c_str());
+                waitingReported = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                continue;
+            }
+            fprintf(stderr, "telemetrytap: following %s\n", name.c_str());
+            waitingReported = false;
+            total = 0;
+            reportedOverruns = 0;
+        }
+
+        size_t count = reader.Read(samples, 256);
+        uint64_t now = MonotonicNanoseconds();
+        for (size_t i = 0; i < count; i++)
+        {
+            delay.Record(now - samples[i].arrivalNs);
+            if (print)
+                PrintSample(samples[i]);
+        }
+        total += count;
+        intervalSamples += count;
+
+        if (statsSeconds > 0 && now - intervalStart >= (uint64_t)(statsSeconds * 1e9))
+        {
+            double seconds = (now - intervalStart) * 1e-9;
+            fprintf(stderr, "telemetrytap: %.0f samples/s  lost %llu  arrival->read p50 %.1f us p99 %.1f us max %.1f us\n",
+                intervalSamples / seconds, (unsigned long long)(reader.Overruns() - reportedOverruns),
+                delay.Percentile(0.5) * 1e-3, delay.Percentile(0.99) * 1e-3, delay.Max() * 1e-3);
+            reportedOverruns = reader.Overruns();
+            intervalSamples = 0;
+            intervalStart = now;
+            delay.Reset();
+        }
+
+        // reading never blocks; between batches, a short sleep is plenty for anything but latency tests
+        if (count == 0 && !spin)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 0;
+}